@@ -27,3 +27,37 @@ if(USE_PERF_TESTS)
   message(STATUS "Enable performance tests")
   add_compile_definitions(USE_PERF_TESTS)
 endif(USE_PERF_TESTS)
+
+option(PPC_ENABLE_TRACING "Record PPC_TRACE_SCOPE events and write Chrome traces"
+       OFF)
+if(PPC_ENABLE_TRACING)
+  message(STATUS "Enable tracing")
+  add_compile_definitions(PPC_ENABLE_TRACING)
+endif(PPC_ENABLE_TRACING)
+
+option(PPC_ENABLE_ALLOC_TRACKING
+       "Count heap allocations per task stage and thread (replaces operator new)"
+       OFF)
+if(PPC_ENABLE_ALLOC_TRACKING)
+  if(ENABLE_ADDRESS_SANITIZER OR ENABLE_LEAK_SANITIZER)
+    message(
+      FATAL_ERROR
+        "PPC_ENABLE_ALLOC_TRACKING cannot be combined with the address or leak sanitizer"
+    )
+  endif()
+  message(STATUS "Enable allocation tracking")
+  add_compile_definitions(PPC_ENABLE_ALLOC_TRACKING)
+endif(PPC_ENABLE_ALLOC_TRACKING)
+
+option(PPC_ENABLE_MPI_PROFILING
+       "Count MPI calls, bytes and time per task stage (PMPI wrappers)" OFF)
+if(PPC_ENABLE_MPI_PROFILING)
+  if(WIN32)
+    message(
+      FATAL_ERROR
+        "PPC_ENABLE_MPI_PROFILING needs the PMPI interface of Open MPI or MPICH"
+    )
+  endif()
+  message(STATUS "Enable MPI profiling")
+  add_compile_definitions(PPC_ENABLE_MPI_PROFILING)
+endif(PPC_ENABLE_MPI_PROFILING)
@@ -16,7 +16,7 @@
 #include <string>
 #include <string_view>
 
-#include "oneapi/tbb/global_control.h"
+#include "runtime/include/runtime.hpp"
 #include "util/include/util.hpp"
 
 namespace ppc::runners {
@@ -149,8 +149,8 @@ int Init(int argc, char **argv) {
     return init_res;
   }
 
-  // Limit the number of threads in TBB
-  tbb::global_control control(tbb::global_control::max_allowed_parallelism, ppc::util::GetNumThreads());
+  // Keep OpenMP, TBB and STL worker pools warm for the whole run (also limits the number of threads in TBB)
+  ppc::runtime::RuntimeManager runtime(ppc::util::GetNumThreads());
 
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -169,6 +169,7 @@ int Init(int argc, char **argv) {
   listeners.Append(new UnreadMessagesDetector());
 
   const int status = RunAllTestsSafely();
+  runtime.Release();
 
   const int finalize_res = MPI_Finalize();
   if (finalize_res != MPI_SUCCESS) {
@@ -180,8 +181,8 @@ int Init(int argc, char **argv) {
 }
 
 int SimpleInit(int argc, char **argv) {
-  // Limit the number of threads in TBB
-  tbb::global_control control(tbb::global_control::max_allowed_parallelism, ppc::util::GetNumThreads());
+  // Keep OpenMP, TBB and STL worker pools warm for the whole run (also limits the number of threads in TBB)
+  ppc::runtime::RuntimeManager runtime(ppc::util::GetNumThreads());
 
   testing::InitGoogleTest(&argc, argv);
   return RunAllTests();
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "oneapi/tbb/global_control.h"
+
+namespace ppc::runtime {
+
+/// @brief Persistent pool of STL worker threads used in place of per-call std::thread creation.
+/// @details Run() hands the same job to every worker and blocks until all of them return,
+/// which mirrors an OpenMP parallel region. Calls from several threads are serialized.
+class ThreadPool {
+ public:
+  /// @brief Starts the workers and waits until each of them is ready to take jobs.
+  /// @param num_threads Number of worker threads (at least one).
+  explicit ThreadPool(int num_threads);
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool(ThreadPool &&) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  ThreadPool &operator=(ThreadPool &&) = delete;
+  /// @brief Stops and joins all workers.
+  ~ThreadPool();
+
+  /// @brief Returns the number of worker threads.
+  [[nodiscard]] int Size() const {
+    return static_cast<int>(workers_.size());
+  }
+
+  /// @brief Invokes job(thread_index) once on every worker and waits for completion.
+  /// @throws Rethrows the first exception raised by a worker.
+  /// @note Must not be called from inside a job running on the same pool.
+  void Run(const std::function<void(int)> &job);
+
+ private:
+  void WorkerLoop(int thread_index);
+
+  std::vector<std::thread> workers_;
+  std::mutex run_mutex_;
+  std::mutex state_mutex_;
+  std::condition_variable job_ready_;
+  std::condition_variable job_done_;
+  const std::function<void(int)> *job_ = nullptr;
+  std::exception_ptr job_error_;
+  std::uint64_t generation_ = 0;
+  int ready_workers_ = 0;
+  int busy_workers_ = 0;
+  bool stopping_ = false;
+};
+
+/// @brief Time spent bringing each threading runtime up, in seconds.
+struct SpinUpTimes {
+  double omp = 0.0;
+  double tbb = 0.0;
+  double stl = 0.0;
+};
+
+/// @brief Owns warm OpenMP, TBB and STL worker pools for the lifetime of a test binary.
+/// @details Created once by the runners. While it is active, tasks reuse the same thread teams
+/// instead of tearing them down on destruction, and the cost of the first spin-up is measured
+/// here instead of being charged to the first Run().
+class RuntimeManager {
+ public:
+  /// @brief Limits TBB parallelism and spins up the OpenMP team, the TBB workers and the STL pool.
+  /// @param num_threads Number of threads per runtime (values below one are treated as one).
+  /// @throws std::runtime_error If another manager is already active.
+  explicit RuntimeManager(int num_threads);
+  RuntimeManager(const RuntimeManager &) = delete;
+  RuntimeManager(RuntimeManager &&) = delete;
+  RuntimeManager &operator=(const RuntimeManager &) = delete;
+  RuntimeManager &operator=(RuntimeManager &&) = delete;
+  ~RuntimeManager();
+
+  /// @brief Releases all pools; called automatically on destruction.
+  /// @details Joins the STL workers, lifts the TBB limit and lets OpenMP free its thread team.
+  void Release();
+
+  /// @brief Brings every pool to a new thread count, e.g. between the points of a thread-count sweep.
+  /// @details Replaces the TBB limit, respawns the OpenMP team of the calling thread and restarts the STL pool.
+  /// The spin-up times keep the values measured at construction.
+  /// @param num_threads Number of threads per runtime (values below one are treated as one).
+  /// @throws std::runtime_error If the manager was already released.
+  void Resize(int num_threads);
+
+  /// @brief Returns the measured spin-up cost of each runtime.
+  [[nodiscard]] const SpinUpTimes &GetSpinUpTimes() const {
+    return spin_up_times_;
+  }
+
+  /// @brief Returns the number of threads each runtime is currently set up with.
+  [[nodiscard]] int GetNumThreads() const {
+    return num_threads_;
+  }
+
+  /// @brief Returns the persistent STL pool.
+  /// @throws std::runtime_error If the manager was already released.
+  ThreadPool &GetThreadPool();
+
+  /// @brief Returns the active manager or nullptr when none exists.
+  static RuntimeManager *Instance() {
+    return instance.load();
+  }
+
+  /// @brief Checks whether a manager currently keeps the runtimes warm.
+  static bool IsActive() {
+    return Instance() != nullptr;
+  }
+
+ private:
+  int num_threads_;
+  SpinUpTimes spin_up_times_;
+  std::unique_ptr<tbb::global_control> tbb_control_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  inline static std::atomic<RuntimeManager *> instance{nullptr};
+};
+
+/// @brief Invokes job(thread_index) for every index in [0, num_threads) on concurrent threads.
+/// @details Uses the pool of the active RuntimeManager when it is large enough, otherwise
+/// spawns and joins std::thread objects for this call only. The time each index spends in
+/// the job is added to the busy times returned by GetThreadBusyTimes().
+/// @throws Rethrows the first exception raised by a job once every thread has finished.
+void ParallelRun(int num_threads, const std::function<void(int)> &job);
+
+/// @brief Returns the time each thread index spent in ParallelRun() jobs since the last reset, in seconds.
+/// @return One entry per thread index used so far; empty if ParallelRun() was not called.
+std::vector<double> GetThreadBusyTimes();
+
+/// @brief Clears the busy times collected by ParallelRun().
+void ResetThreadBusyTimes();
+
+}  // namespace ppc::runtime
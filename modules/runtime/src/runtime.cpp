@@ -0,0 +1,259 @@
+#include "runtime/include/runtime.hpp"
+
+#include <omp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "oneapi/tbb/global_control.h"
+#include "oneapi/tbb/parallel_for.h"
+#include "oneapi/tbb/task_arena.h"
+#include "util/include/trace.hpp"
+
+namespace ppc::runtime {
+
+namespace {
+
+template <typename SpinUp>
+double MeasureSeconds(SpinUp &&spin_up) {
+  const auto begin = std::chrono::steady_clock::now();
+  std::forward<SpinUp>(spin_up)();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void SpinUpOpenMp(int num_threads) {
+  omp_set_num_threads(num_threads);
+#pragma omp parallel default(none) num_threads(num_threads)
+  {
+#pragma omp barrier
+  }
+}
+
+void SpinUpTbb(int num_threads) {
+  // One chunk per thread, each held until every worker has joined, forces the whole team up.
+  // The default arena never grows past the hardware concurrency, whatever global_control allows.
+  num_threads = std::min(num_threads, tbb::this_task_arena::max_concurrency());
+  std::atomic<int> arrived{0};
+  tbb::parallel_for(0, num_threads, [&arrived, num_threads](int /*index*/) -> void {
+    arrived.fetch_add(1);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    while (arrived.load() < num_threads && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+  }, tbb::simple_partitioner{});
+}
+
+struct BusyTimes {
+  std::mutex mutex;
+  std::vector<double> seconds;
+};
+
+BusyTimes &ThreadBusyTimes() {
+  static BusyTimes busy_times;
+  return busy_times;
+}
+
+void AddBusyTime(int thread_index, double seconds) {
+  auto &busy_times = ThreadBusyTimes();
+  const std::scoped_lock lock(busy_times.mutex);
+  const auto index = static_cast<std::size_t>(thread_index);
+  if (busy_times.seconds.size() <= index) {
+    busy_times.seconds.resize(index + 1, 0.0);
+  }
+  busy_times.seconds[index] += seconds;
+}
+
+}  // namespace
+
+ThreadPool::ThreadPool(int num_threads) {
+  const int size = std::max(num_threads, 1);
+  workers_.reserve(static_cast<std::size_t>(size));
+  for (int i = 0; i < size; ++i) {
+    workers_.emplace_back([this, i] -> void { WorkerLoop(i); });
+  }
+  std::unique_lock lock(state_mutex_);
+  job_done_.wait(lock, [this, size] -> bool { return ready_workers_ == size; });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::scoped_lock lock(state_mutex_);
+    stopping_ = true;
+  }
+  job_ready_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Run(const std::function<void(int)> &job) {
+  std::scoped_lock run_lock(run_mutex_);
+  std::exception_ptr error;
+  {
+    std::unique_lock lock(state_mutex_);
+    job_ = &job;
+    job_error_ = nullptr;
+    busy_workers_ = Size();
+    ++generation_;
+    job_ready_.notify_all();
+    job_done_.wait(lock, [this] -> bool { return busy_workers_ == 0; });
+    job_ = nullptr;
+    error = job_error_;
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void ThreadPool::WorkerLoop(int thread_index) {
+  std::uint64_t seen_generation = 0;
+  {
+    std::scoped_lock lock(state_mutex_);
+    ++ready_workers_;
+  }
+  job_done_.notify_all();
+  while (true) {
+    const std::function<void(int)> *job = nullptr;
+    {
+      std::unique_lock lock(state_mutex_);
+      job_ready_.wait(lock, [this, seen_generation] -> bool { return stopping_ || generation_ != seen_generation; });
+      if (stopping_) {
+        return;
+      }
+      seen_generation = generation_;
+      job = job_;
+    }
+    std::exception_ptr error;
+    try {
+      (*job)(thread_index);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    {
+      std::scoped_lock lock(state_mutex_);
+      if (error && !job_error_) {
+        job_error_ = error;
+      }
+      --busy_workers_;
+    }
+    job_done_.notify_all();
+  }
+}
+
+RuntimeManager::RuntimeManager(int num_threads) : num_threads_(std::max(num_threads, 1)) {
+  RuntimeManager *expected = nullptr;
+  if (!instance.compare_exchange_strong(expected, this)) {
+    throw std::runtime_error("Only one RuntimeManager can be active at a time");
+  }
+  try {
+    tbb_control_ = std::make_unique<tbb::global_control>(tbb::global_control::max_allowed_parallelism,
+                                                         static_cast<std::size_t>(num_threads_));
+    spin_up_times_.omp = MeasureSeconds([this] -> void { SpinUpOpenMp(num_threads_); });
+    spin_up_times_.tbb = MeasureSeconds([this] -> void { SpinUpTbb(num_threads_); });
+    spin_up_times_.stl =
+        MeasureSeconds([this] -> void { thread_pool_ = std::make_unique<ThreadPool>(num_threads_); });
+  } catch (...) {
+    instance.store(nullptr);
+    throw;
+  }
+}
+
+RuntimeManager::~RuntimeManager() {
+  Release();
+}
+
+void RuntimeManager::Release() {
+  RuntimeManager *expected = this;
+  if (!instance.compare_exchange_strong(expected, nullptr)) {
+    return;
+  }
+  thread_pool_.reset();
+  tbb_control_.reset();
+#if _OPENMP >= 201811
+  omp_pause_resource_all(omp_pause_soft);
+#endif
+}
+
+void RuntimeManager::Resize(int num_threads) {
+  if (instance.load() != this) {
+    throw std::runtime_error("RuntimeManager was already released");
+  }
+  num_threads_ = std::max(num_threads, 1);
+  thread_pool_.reset();
+  tbb_control_ = std::make_unique<tbb::global_control>(tbb::global_control::max_allowed_parallelism,
+                                                       static_cast<std::size_t>(num_threads_));
+  SpinUpOpenMp(num_threads_);
+  SpinUpTbb(num_threads_);
+  thread_pool_ = std::make_unique<ThreadPool>(num_threads_);
+}
+
+ThreadPool &RuntimeManager::GetThreadPool() {
+  if (!thread_pool_) {
+    throw std::runtime_error("RuntimeManager was already released");
+  }
+  return *thread_pool_;
+}
+
+void ParallelRun(int num_threads, const std::function<void(int)> &job) {
+  const auto timed_job = [&job](int thread_index) -> void {
+    PPC_TRACE_SCOPE_CATEGORY("ParallelRun job", "stl");
+    const auto begin = std::chrono::steady_clock::now();
+    job(thread_index);
+    AddBusyTime(thread_index, std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+  };
+  RuntimeManager *manager = RuntimeManager::Instance();
+  if (manager != nullptr && manager->GetThreadPool().Size() >= num_threads) {
+    manager->GetThreadPool().Run([&timed_job, num_threads](int thread_index) -> void {
+      if (thread_index < num_threads) {
+        timed_job(thread_index);
+      }
+    });
+    return;
+  }
+  // Each thread keeps its own exception, so a failing job is rethrown after all threads are joined, as in the pool.
+  std::vector<std::exception_ptr> errors(static_cast<std::size_t>(std::max(num_threads, 0)));
+  std::vector<std::thread> threads;
+  threads.reserve(errors.size());
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&timed_job, &errors, i] -> void {
+      try {
+        timed_job(i);
+      } catch (...) {
+        errors[static_cast<std::size_t>(i)] = std::current_exception();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (const auto &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+std::vector<double> GetThreadBusyTimes() {
+  auto &busy_times = ThreadBusyTimes();
+  const std::scoped_lock lock(busy_times.mutex);
+  return busy_times.seconds;
+}
+
+void ResetThreadBusyTimes() {
+  auto &busy_times = ThreadBusyTimes();
+  const std::scoped_lock lock(busy_times.mutex);
+  busy_times.seconds.clear();
+}
+
+}  // namespace ppc::runtime
@@ -0,0 +1,107 @@
+#include "runtime/include/runtime.hpp"
+
+#include <gtest/gtest.h>
+#include <omp.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using ppc::runtime::RuntimeManager;
+using ppc::runtime::ThreadPool;
+
+TEST(ThreadPool, RunInvokesJobOnceOnEveryWorker) {
+  ThreadPool pool(3);
+  std::vector<std::atomic<int>> calls(3);
+  for (int round = 0; round < 4; ++round) {
+    pool.Run([&calls](int thread_index) -> void { calls[thread_index].fetch_add(1); });
+  }
+  for (const auto &count : calls) {
+    EXPECT_EQ(count.load(), 4);
+  }
+}
+
+TEST(ThreadPool, RunRethrowsWorkerExceptionAndStaysUsable) {
+  ThreadPool pool(2);
+  EXPECT_THROW(pool.Run([](int thread_index) -> void {
+    if (thread_index == 1) {
+      throw std::runtime_error("worker failed");
+    }
+  }),
+               std::runtime_error);
+
+  std::atomic<int> calls{0};
+  pool.Run([&calls](int /*thread_index*/) -> void { calls.fetch_add(1); });
+  EXPECT_EQ(calls.load(), 2);
+}
+
+TEST(RuntimeManager, RunnerKeepsManagerActiveWithMeasuredSpinUp) {
+  ASSERT_TRUE(RuntimeManager::IsActive());
+  const auto &spin_up = RuntimeManager::Instance()->GetSpinUpTimes();
+  EXPECT_GE(spin_up.omp, 0.0);
+  EXPECT_GE(spin_up.tbb, 0.0);
+  EXPECT_GT(spin_up.stl, 0.0);
+  EXPECT_GE(RuntimeManager::Instance()->GetThreadPool().Size(), 1);
+}
+
+TEST(RuntimeManager, SecondManagerThrowsWhileOneIsActive) {
+  ASSERT_TRUE(RuntimeManager::IsActive());
+  EXPECT_THROW(RuntimeManager(1), std::runtime_error);
+  EXPECT_TRUE(RuntimeManager::IsActive());
+}
+
+TEST(RuntimeManager, ResizeChangesEveryPoolAndCanBeUndone) {
+  auto *runtime = RuntimeManager::Instance();
+  const int initial = runtime->GetNumThreads();
+  runtime->Resize(initial + 2);
+  EXPECT_EQ(runtime->GetNumThreads(), initial + 2);
+  EXPECT_EQ(runtime->GetThreadPool().Size(), initial + 2);
+  EXPECT_EQ(omp_get_max_threads(), initial + 2);
+  runtime->Resize(initial);
+  EXPECT_EQ(runtime->GetThreadPool().Size(), initial);
+  EXPECT_EQ(omp_get_max_threads(), initial);
+}
+
+TEST(RuntimeManager, ParallelRunCoversEveryIndexWithAndWithoutPool) {
+  const int pool_size = RuntimeManager::Instance()->GetThreadPool().Size();
+  for (const int num_threads : {1, pool_size, pool_size + 3}) {
+    std::vector<std::atomic<int>> calls(static_cast<std::size_t>(num_threads));
+    ppc::runtime::ParallelRun(num_threads, [&calls](int thread_index) -> void { calls[thread_index].fetch_add(1); });
+    for (const auto &count : calls) {
+      EXPECT_EQ(count.load(), 1);
+    }
+  }
+}
+
+TEST(RuntimeManager, ParallelRunRethrowsJobExceptionWithAndWithoutPool) {
+  const int pool_size = RuntimeManager::Instance()->GetThreadPool().Size();
+  for (const int num_threads : {pool_size, pool_size + 3}) {
+    std::atomic<int> calls{0};
+    EXPECT_THROW(ppc::runtime::ParallelRun(num_threads,
+                                           [&calls](int thread_index) -> void {
+                                             calls.fetch_add(1);
+                                             if (thread_index == 0) {
+                                               throw std::runtime_error("job failed");
+                                             }
+                                           }),
+                 std::runtime_error);
+    EXPECT_EQ(calls.load(), num_threads);
+  }
+}
+
+TEST(RuntimeManager, ParallelRunRecordsBusyTimePerThread) {
+  ppc::runtime::ResetThreadBusyTimes();
+  EXPECT_TRUE(ppc::runtime::GetThreadBusyTimes().empty());
+  ppc::runtime::ParallelRun(2, [](int thread_index) -> void {
+    std::this_thread::sleep_for(std::chrono::milliseconds(thread_index == 0 ? 30 : 1));
+  });
+  const auto busy = ppc::runtime::GetThreadBusyTimes();
+  ASSERT_EQ(busy.size(), 2U);
+  EXPECT_GE(busy[0], 0.03);
+  EXPECT_LT(busy[1], busy[0]);
+  ppc::runtime::ResetThreadBusyTimes();
+  EXPECT_TRUE(ppc::runtime::GetThreadBusyTimes().empty());
+}
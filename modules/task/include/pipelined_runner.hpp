@@ -0,0 +1,246 @@
+#pragma once
+
+#include <mpi.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
+#include <initializer_list>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "task/include/task.hpp"
+
+namespace ppc::task {
+
+/// @brief How a PipelinedRunner schedules the stages of consecutive tasks.
+enum class PipelineExecution : uint8_t {
+  /// PreProcessing, Run and PostProcessing of different tasks overlap on three stage threads
+  kOverlapped,
+  /// Every task goes through all stages on the submitting thread before Submit() returns
+  kSerial,
+};
+
+/// @brief Picks the execution strategy that is safe for a task type.
+/// @details MPI-based tasks run serially unless MPI was initialized with MPI_THREAD_MULTIPLE,
+/// because their stages issue MPI calls and must stay on one thread in the same order on every rank.
+inline PipelineExecution DefaultPipelineExecution(TypeOfTask type_of_task) {
+  if (type_of_task != TypeOfTask::kMPI && type_of_task != TypeOfTask::kALL) {
+    return PipelineExecution::kOverlapped;
+  }
+  int initialized = 0;
+  int provided = MPI_THREAD_SINGLE;
+  if (MPI_Initialized(&initialized) == MPI_SUCCESS && initialized != 0) {
+    MPI_Query_thread(&provided);
+  }
+  return provided == MPI_THREAD_MULTIPLE ? PipelineExecution::kOverlapped : PipelineExecution::kSerial;
+}
+
+/// @brief Runs a stream of independent tasks with their pipeline stages overlapped.
+/// @details While task N is in Run(), task N+1 is validated and preprocessed and task N-1 is
+/// postprocessed, each on its own stage thread. Tasks leave every stage in submission order.
+/// Results are delivered through futures; a failing stage aborts its task and sets an exception on its future.
+/// @tparam InType Input data type.
+/// @tparam OutType Output data type.
+template <typename InType, typename OutType>
+class PipelinedRunner {
+ public:
+  /// @param execution Stage scheduling strategy.
+  /// @param queue_capacity Tasks allowed to wait between two stages; Submit() blocks when full.
+  explicit PipelinedRunner(PipelineExecution execution = PipelineExecution::kOverlapped,
+                           std::size_t queue_capacity = 2)
+      : execution_(execution),
+        to_preprocess_(queue_capacity),
+        to_run_(queue_capacity),
+        to_postprocess_(queue_capacity) {
+    if (execution_ == PipelineExecution::kOverlapped) {
+      preprocess_thread_ = std::thread([this] -> void { PreProcessLoop(); });
+      run_thread_ = std::thread([this] -> void { RunLoop(); });
+      postprocess_thread_ = std::thread([this] -> void { PostProcessLoop(); });
+    }
+  }
+  PipelinedRunner(const PipelinedRunner &) = delete;
+  PipelinedRunner(PipelinedRunner &&) = delete;
+  PipelinedRunner &operator=(const PipelinedRunner &) = delete;
+  PipelinedRunner &operator=(PipelinedRunner &&) = delete;
+
+  /// @brief Waits for all submitted tasks and stops the stage threads.
+  ~PipelinedRunner() {
+    Finish();
+  }
+
+  /// @brief Queues a task that has not started its pipeline yet.
+  /// @return Future receiving the task output after PostProcessing().
+  /// @throws std::invalid_argument If the task is null.
+  std::future<OutType> Submit(TaskPtr<InType, OutType> task) {
+    if (!task) {
+      throw std::invalid_argument("PipelinedRunner cannot run a null task");
+    }
+    if (finished_) {
+      task->Abort();
+      throw std::runtime_error("PipelinedRunner does not accept tasks after Finish()");
+    }
+    if (!first_submit_) {
+      first_submit_ = Clock::now();
+    }
+    Item item{.task = std::move(task), .promise = {}};
+    auto result = item.promise.get_future();
+    if (execution_ == PipelineExecution::kSerial) {
+      if (RunStage(item, [&item] -> bool { return item.task->Validation() && item.task->PreProcessing(); }) &&
+          RunStage(item, [&item] -> bool { return item.task->Run(); })) {
+        Complete(item);
+      }
+    } else {
+      to_preprocess_.Push(std::move(item));
+    }
+    return result;
+  }
+
+  /// @brief Waits until every submitted task has been postprocessed; no tasks can be submitted afterwards.
+  void Finish() {
+    if (finished_) {
+      return;
+    }
+    finished_ = true;
+    to_preprocess_.Close();
+    for (auto *thread : {&preprocess_thread_, &run_thread_, &postprocess_thread_}) {
+      if (thread->joinable()) {
+        thread->join();
+      }
+    }
+  }
+
+  /// @brief Returns the number of tasks that completed successfully.
+  [[nodiscard]] std::size_t GetCompletedCount() const {
+    const std::scoped_lock lock(stats_mutex_);
+    return completed_;
+  }
+
+  /// @brief Returns completed tasks per second, measured from the first Submit() to the last completion.
+  [[nodiscard]] double GetItemsPerSecond() const {
+    const std::scoped_lock lock(stats_mutex_);
+    if (completed_ == 0 || !first_submit_) {
+      return 0.0;
+    }
+    const double elapsed = std::chrono::duration<double>(last_completion_ - *first_submit_).count();
+    return elapsed > 0.0 ? static_cast<double>(completed_) / elapsed : 0.0;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Item {
+    TaskPtr<InType, OutType> task;
+    std::promise<OutType> promise;
+  };
+
+  /// Bounded FIFO handing tasks from one stage thread to the next.
+  class StageQueue {
+   public:
+    explicit StageQueue(std::size_t capacity) : capacity_(capacity == 0 ? 1 : capacity) {}
+
+    void Push(Item item) {
+      std::unique_lock lock(mutex_);
+      not_full_.wait(lock, [this] -> bool { return items_.size() < capacity_; });
+      items_.push_back(std::move(item));
+      not_empty_.notify_one();
+    }
+
+    std::optional<Item> Pop() {
+      std::unique_lock lock(mutex_);
+      not_empty_.wait(lock, [this] -> bool { return closed_ || !items_.empty(); });
+      if (items_.empty()) {
+        return std::nullopt;
+      }
+      Item item = std::move(items_.front());
+      items_.pop_front();
+      not_full_.notify_one();
+      return item;
+    }
+
+    void Close() {
+      const std::scoped_lock lock(mutex_);
+      closed_ = true;
+      not_empty_.notify_all();
+    }
+
+   private:
+    std::size_t capacity_;
+    std::deque<Item> items_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    bool closed_ = false;
+  };
+
+  /// Runs one or more stages; if they report failure or throw, aborts the task and fails the item's future.
+  template <typename Stage>
+  static bool RunStage(Item &item, Stage &&stage) {
+    try {
+      if (std::forward<Stage>(stage)()) {
+        return true;
+      }
+      item.promise.set_exception(std::make_exception_ptr(std::runtime_error("Task pipeline stage failed")));
+    } catch (...) {
+      item.promise.set_exception(std::current_exception());
+    }
+    item.task->Abort();
+    return false;
+  }
+
+  void Complete(Item &item) {
+    if (!RunStage(item, [&item] -> bool { return item.task->PostProcessing(); })) {
+      return;
+    }
+    item.promise.set_value(std::move(item.task->GetOutput()));
+    const std::scoped_lock lock(stats_mutex_);
+    ++completed_;
+    last_completion_ = Clock::now();
+  }
+
+  void PreProcessLoop() {
+    while (auto item = to_preprocess_.Pop()) {
+      if (RunStage(*item, [&item] -> bool { return item->task->Validation() && item->task->PreProcessing(); })) {
+        to_run_.Push(std::move(*item));
+      }
+    }
+    to_run_.Close();
+  }
+
+  void RunLoop() {
+    while (auto item = to_run_.Pop()) {
+      if (RunStage(*item, [&item] -> bool { return item->task->Run(); })) {
+        to_postprocess_.Push(std::move(*item));
+      }
+    }
+    to_postprocess_.Close();
+  }
+
+  void PostProcessLoop() {
+    while (auto item = to_postprocess_.Pop()) {
+      Complete(*item);
+    }
+  }
+
+  PipelineExecution execution_;
+  StageQueue to_preprocess_;
+  StageQueue to_run_;
+  StageQueue to_postprocess_;
+  std::thread preprocess_thread_;
+  std::thread run_thread_;
+  std::thread postprocess_thread_;
+  bool finished_ = false;
+  std::optional<Clock::time_point> first_submit_;
+  mutable std::mutex stats_mutex_;
+  std::size_t completed_ = 0;
+  Clock::time_point last_completion_;
+};
+
+}  // namespace ppc::task
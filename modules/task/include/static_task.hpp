@@ -0,0 +1,278 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "task/include/task.hpp"
+#include "util/include/util.hpp"
+
+namespace ppc::task {
+
+template <typename StaticTaskType>
+class StaticTaskAdapter;
+
+template <typename Derived, typename InType, typename OutType>
+/// @brief Compile-time alternative to Task that dispatches the stage hooks without virtual calls.
+/// @details Derived implements ValidationImpl(), PreProcessingImpl(), RunImpl() and PostProcessingImpl() as
+/// non-virtual members reachable from this base (public, or private with this base declared a friend), so the
+/// calls can be inlined across stage boundaries. The stage order is checked exactly as in Task. Timing, the
+/// watchdog and the OpenMP release are left out; wrap the task in StaticTaskAdapter to get them and to use it
+/// with TaskGetter, MakeAllPerfTasks and the other TaskPtr-based tools.
+/// @tparam Derived Concrete task type (CRTP).
+/// @tparam InType Input data type.
+/// @tparam OutType Output data type.
+class StaticTask {
+ public:
+  using InputType = InType;
+  using OutputType = OutType;
+
+  StaticTask(const StaticTask &) = delete;
+  StaticTask(StaticTask &&) = delete;
+  StaticTask &operator=(const StaticTask &) = delete;
+  StaticTask &operator=(StaticTask &&) = delete;
+
+  /// @brief Validates input data and task attributes before execution.
+  /// @return True if validation is successful.
+  bool Validation() {
+    if (stage_ == Stage::kNone || stage_ == Stage::kDone) {
+      stage_ = Stage::kValidation;
+    } else {
+      stage_ = Stage::kException;
+      throw std::runtime_error("Validation should be called before preprocessing");
+    }
+    return Self().ValidationImpl();
+  }
+
+  /// @brief Performs preprocessing on the input data.
+  /// @return True if preprocessing is successful.
+  bool PreProcessing() {
+    if (stage_ == Stage::kValidation) {
+      stage_ = Stage::kPreProcessing;
+    } else {
+      stage_ = Stage::kException;
+      throw std::runtime_error("Preprocessing should be called after validation");
+    }
+    return Self().PreProcessingImpl();
+  }
+
+  /// @brief Executes the main logic of the task.
+  /// @return True if execution is successful.
+  bool Run() {
+    if (stage_ == Stage::kPreProcessing || stage_ == Stage::kRun) {
+      stage_ = Stage::kRun;
+    } else {
+      stage_ = Stage::kException;
+      throw std::runtime_error("Run should be called after preprocessing");
+    }
+    return Self().RunImpl();
+  }
+
+  /// @brief Performs postprocessing on the output data.
+  /// @return True if postprocessing is successful.
+  bool PostProcessing() {
+    if (stage_ == Stage::kRun) {
+      stage_ = Stage::kDone;
+    } else {
+      stage_ = Stage::kException;
+      throw std::runtime_error("Postprocessing should be called after run");
+    }
+    return Self().PostProcessingImpl();
+  }
+
+  /// @brief Runs a batch of inputs through this task instance; same contract as Task::RunBatch().
+  /// @details Uses Derived::RunBatchImpl(inputs, outputs) when it is reachable, otherwise runs the four stage
+  /// hooks on each item in turn.
+  bool RunBatch(std::span<const InType> inputs, std::vector<OutType> &outputs) {
+    outputs.clear();
+    outputs.resize(inputs.size());
+    return RunBatchStages(BatchInputs<InType>(inputs), std::span<OutType>(outputs));
+  }
+
+  /// @brief Abandons the pipeline so the task can be destroyed without completing it; see Task::Abort().
+  void Abort() {
+    stage_ = Stage::kException;
+  }
+
+  /// @brief Returns the current testing mode.
+  StateOfTesting &GetStateOfTesting() {
+    return state_of_testing_;
+  }
+
+  /// @brief Sets the dynamic task type.
+  void SetTypeOfTask(TypeOfTask type_of_task) {
+    type_of_task_ = type_of_task;
+  }
+
+  /// @brief Returns the dynamic task type.
+  [[nodiscard]] TypeOfTask GetDynamicTypeOfTask() const {
+    return type_of_task_;
+  }
+
+  /// @brief Returns the current task status.
+  [[nodiscard]] StatusOfTask GetStatusOfTask() const {
+    return status_of_task_;
+  }
+
+  /// @brief Returns the static task type; Derived hides it with its own technology.
+  static constexpr TypeOfTask GetStaticTypeOfTask() {
+    return TypeOfTask::kUnknown;
+  }
+
+  /// @brief Returns a reference to the input data.
+  InType &GetInput() {
+    return input_;
+  }
+
+  /// @brief Returns a reference to the output data.
+  OutType &GetOutput() {
+    return output_;
+  }
+
+ protected:
+  StaticTask() = default;
+
+  /// @brief Verifies that the pipeline was executed in the correct order, like Task::~Task().
+  ~StaticTask() {
+    if (stage_ != Stage::kDone && stage_ != Stage::kException) {
+      ppc::util::DestructorFailureFlag::Set();
+    }
+  }
+
+ private:
+  friend class StaticTaskAdapter<Derived>;
+
+  enum class Stage : uint8_t {
+    kNone,
+    kValidation,
+    kPreProcessing,
+    kRun,
+    kDone,
+    kException,
+  };
+
+  Derived &Self() {
+    return static_cast<Derived &>(*this);
+  }
+
+  bool RunBatchStages(BatchInputs<InType> inputs, std::span<OutType> outputs) {
+    if (stage_ == Stage::kNone || stage_ == Stage::kDone) {
+      stage_ = Stage::kRun;
+    } else {
+      stage_ = Stage::kException;
+      throw std::runtime_error("RunBatch should be called before validation or after postprocessing");
+    }
+    bool result = false;
+    try {
+      if constexpr (requires(Derived &task) { task.RunBatchImpl(inputs, outputs); }) {
+        result = Self().RunBatchImpl(inputs, outputs);
+      } else {
+        result = RunEachItem(inputs, outputs);
+      }
+    } catch (...) {
+      stage_ = Stage::kException;
+      throw;
+    }
+    stage_ = Stage::kDone;
+    return result;
+  }
+
+  bool RunEachItem(BatchInputs<InType> inputs, std::span<OutType> outputs) {
+    if constexpr (std::is_copy_assignable_v<InType>) {
+      for (std::size_t item = 0; item < inputs.Size(); ++item) {
+        input_ = inputs[item];
+        output_ = OutType{};
+        if (!Self().ValidationImpl() || !Self().PreProcessingImpl() || !Self().RunImpl() ||
+            !Self().PostProcessingImpl()) {
+          return false;
+        }
+        outputs[item] = std::move(output_);
+      }
+      return true;
+    } else {
+      throw std::runtime_error("The default RunBatch loop needs a copy-assignable input type");
+    }
+  }
+
+  InType input_{};
+  OutType output_{};
+  StateOfTesting state_of_testing_ = StateOfTesting::kFunc;
+  TypeOfTask type_of_task_ = TypeOfTask::kUnknown;
+  StatusOfTask status_of_task_ = StatusOfTask::kEnabled;
+  Stage stage_ = Stage::kNone;
+};
+
+/// @brief Exposes a StaticTask through the virtual Task interface.
+/// @details Lets a statically dispatched task be created by TaskGetter/SharedTaskGetter, registered with
+/// MakeAllPerfTasks and run by the perf harness, which then times its stages as usual. The input is held by the
+/// adapter until Validation() moves it into the wrapped task, so it can still be replaced through GetInput() (as
+/// TaskGraph does); the input and the output are moved back into the adapter after PostProcessing(), so the task
+/// can run another pass.
+/// Batches are forwarded to the wrapped task so its per-item loop stays statically dispatched.
+/// @tparam StaticTaskType Task derived from StaticTask.
+template <typename StaticTaskType>
+class StaticTaskAdapter final
+    : public Task<typename StaticTaskType::InputType, typename StaticTaskType::OutputType> {
+ public:
+  /// @brief Wrapped task type, used for naming (see ppc::util::GetNamespace).
+  using WrappedTask = StaticTaskType;
+
+  template <typename... Args>
+    requires std::is_constructible_v<StaticTaskType, Args...>
+  explicit StaticTaskAdapter(Args &&...args) : task_(std::forward<Args>(args)...) {
+    this->SetTypeOfTask(task_.GetDynamicTypeOfTask());
+    this->GetInput() = std::move(task_.GetInput());
+  }
+  StaticTaskAdapter(const StaticTaskAdapter &) = delete;
+  StaticTaskAdapter(StaticTaskAdapter &&) = delete;
+  StaticTaskAdapter &operator=(const StaticTaskAdapter &) = delete;
+  StaticTaskAdapter &operator=(StaticTaskAdapter &&) = delete;
+  /// An abandoned adapter abandons the wrapped task too, which may have stopped in the middle of its pipeline.
+  ~StaticTaskAdapter() override {
+    if (this->IsAborted()) {
+      task_.Abort();
+    }
+  }
+
+  static constexpr TypeOfTask GetStaticTypeOfTask() {
+    return StaticTaskType::GetStaticTypeOfTask();
+  }
+
+  /// @brief Returns the wrapped task.
+  StaticTaskType &GetStaticTask() {
+    return task_;
+  }
+
+ protected:
+  bool ValidationImpl() override {
+    task_.GetStateOfTesting() = this->GetStateOfTesting();
+    task_.GetInput() = std::move(this->GetInput());
+    return task_.Validation();
+  }
+  bool PreProcessingImpl() override {
+    return task_.PreProcessing();
+  }
+  bool RunImpl() override {
+    return task_.Run();
+  }
+  bool PostProcessingImpl() override {
+    const bool result = task_.PostProcessing();
+    this->GetOutput() = std::move(task_.GetOutput());
+    // Hands the input back, so the next pass moves it in again instead of finding it moved-from.
+    this->GetInput() = std::move(task_.GetInput());
+    return result;
+  }
+  bool RunBatchImpl(BatchInputs<typename StaticTaskType::InputType> inputs,
+                    std::span<typename StaticTaskType::OutputType> outputs) override {
+    return task_.RunBatchStages(inputs, outputs);
+  }
+
+ private:
+  StaticTaskType task_;
+};
+
+}  // namespace ppc::task
@@ -2,19 +2,33 @@
 
 #include <omp.h>
 
+#include <algorithm>
 #include <array>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <span>
 #include <sstream>
 #include <stdexcept>
+#include <stop_token>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <util/include/util.hpp>
 #include <utility>
+#include <vector>
+
+#include "runtime/include/runtime.hpp"
+#include "util/include/alloc_tracker.hpp"
+#include "util/include/mpi_profile.hpp"
+#include "util/include/perf_counters.hpp"
+#include "util/include/trace.hpp"
+#include "util/include/watchdog.hpp"
 
 namespace ppc::task {
 
@@ -197,6 +211,69 @@ enum class StateOfTesting : uint8_t {
   kPerf,
 };
 
+/// @brief Wall-clock time spent in each pipeline stage during the last call, in seconds.
+struct StageTimings {
+  double validation = 0.0;
+  double preprocessing = 0.0;
+  double run = 0.0;
+  double postprocessing = 0.0;
+};
+
+/// @brief Everything measured in one pipeline stage during its last call.
+struct StageMetrics {
+  /// Wall-clock time in seconds
+  double time = 0.0;
+  /// Events counted while ppc::util::PerfCounters were active
+  ppc::util::PerfCounterValues counters{};
+  /// Heap allocations; empty unless the project is built with PPC_ENABLE_ALLOC_TRACKING
+  ppc::util::AllocationStats allocations{};
+  /// MPI calls of this rank; empty unless the project is built with PPC_ENABLE_MPI_PROFILING
+  ppc::util::MpiProfile mpi_profile{};
+};
+
+/// @brief Metrics of each pipeline stage during its last call.
+struct PipelineMetrics {
+  StageMetrics validation{};
+  StageMetrics preprocessing{};
+  StageMetrics run{};
+  StageMetrics postprocessing{};
+
+  [[nodiscard]] StageTimings Timings() const {
+    return {.validation = validation.time,
+            .preprocessing = preprocessing.time,
+            .run = run.time,
+            .postprocessing = postprocessing.time};
+  }
+};
+
+/// @brief Read-only input shared between a test harness and the tasks it creates.
+/// @details Lets large inputs be handed to many task instances without copying them.
+template <typename InType>
+using SharedInput = std::shared_ptr<const InType>;
+
+/// @brief Read-only view of the inputs of one RunBatch() call.
+/// @details Either a span of distinct inputs or one input repeated, so a batch of identical items needs no copies.
+template <typename InType>
+class BatchInputs {
+ public:
+  explicit BatchInputs(std::span<const InType> inputs) : items_(inputs), size_(inputs.size()) {}
+  BatchInputs(const InType &input, std::size_t repeat) : items_(&input, 1), size_(repeat) {}
+
+  /// @brief Returns the number of items in the batch.
+  [[nodiscard]] std::size_t Size() const {
+    return size_;
+  }
+
+  /// @brief Returns the input of the given item.
+  const InType &operator[](std::size_t item) const {
+    return items_.size() == 1 ? items_.front() : items_[item];
+  }
+
+ private:
+  std::span<const InType> items_;
+  std::size_t size_;
+};
+
 template <typename InType, typename OutType>
 /// @brief Base abstract class representing a generic task with a defined pipeline.
 /// @tparam InType Input data type.
@@ -218,7 +295,7 @@ class Task {
       stage_ = PipelineStage::kException;
       throw std::runtime_error("Validation should be called before preprocessing");
     }
-    return ValidationImpl();
+    return TimeStage("Validation", stage_metrics_.validation, [this] -> bool { return ValidationImpl(); });
   }
 
   /// @brief Performs preprocessing on the input data.
@@ -233,7 +310,7 @@ class Task {
     if (state_of_testing_ == StateOfTesting::kFunc) {
       InternalTimeTest();
     }
-    return PreProcessingImpl();
+    return TimeStage("PreProcessing", stage_metrics_.preprocessing, [this] -> bool { return PreProcessingImpl(); });
   }
 
   /// @brief Executes the main logic of the task.
@@ -245,7 +322,7 @@ class Task {
       stage_ = PipelineStage::kException;
       throw std::runtime_error("Run should be called after preprocessing");
     }
-    return RunImpl();
+    return TimeStage("Run", stage_metrics_.run, [this] -> bool { return RunImpl(); });
   }
 
   /// @brief Performs postprocessing on the output data.
@@ -260,7 +337,29 @@ class Task {
     if (state_of_testing_ == StateOfTesting::kFunc) {
       InternalTimeTest();
     }
-    return PostProcessingImpl();
+    return TimeStage("PostProcessing", stage_metrics_.postprocessing, [this] -> bool { return PostProcessingImpl(); });
+  }
+
+  /// @brief Runs a batch of inputs through this one task instance, amortizing task setup across the items.
+  /// @param inputs Inputs processed by RunBatchImpl().
+  /// @param outputs Resized to the number of inputs; receives one output per input.
+  /// @return True if every item was processed successfully.
+  /// @note Allowed before Validation() or after PostProcessing(); leaves the task in the completed state.
+  /// The whole batch is timed as the run stage, with a time budget scaled by the number of items.
+  virtual bool RunBatch(std::span<const InType> inputs, std::vector<OutType> &outputs) final {
+    return RunBatchItems(BatchInputs<InType>(inputs), outputs);
+  }
+
+  /// @brief Runs one input repeat times through this task instance; same contract as the span overload.
+  /// @details The input is read in place by every item, so the batch holds no copies of it.
+  virtual bool RunBatch(const InType &input, std::size_t repeat, std::vector<OutType> &outputs) final {
+    return RunBatchItems(BatchInputs<InType>(input, repeat), outputs);
+  }
+
+  /// @brief Abandons the pipeline, e.g. after a stage failed, so the task can be destroyed without completing it.
+  /// @note An aborted task cannot be run again.
+  void Abort() {
+    stage_ = PipelineStage::kException;
   }
 
   /// @brief Returns the current testing mode.
@@ -269,6 +368,31 @@ class Task {
     return state_of_testing_;
   }
 
+  /// @brief Returns the time spent in each pipeline stage during its most recent call.
+  /// @return Per-stage wall-clock times in seconds.
+  [[nodiscard]] StageTimings GetStageTimings() const {
+    return stage_metrics_.Timings();
+  }
+
+  /// @brief Returns everything measured in each pipeline stage during its most recent call.
+  /// @return Per-stage times, counter deltas (unavailable unless ppc::util::PerfCounters were active), heap
+  /// allocations and MPI calls.
+  [[nodiscard]] const PipelineMetrics &GetStageMetrics() const {
+    return stage_metrics_;
+  }
+
+  /// @brief Checks whether the running stage has exceeded its time budget.
+  /// @details Long loops in RunImpl() can poll this and return early; the overrun is then reported as a
+  /// time limit failure instead of the whole job being aborted by the watchdog.
+  [[nodiscard]] bool IsStopRequested() const {
+    return stop_source_.stop_requested();
+  }
+
+  /// @brief Returns a token that is stopped when the running stage exceeds its time budget.
+  [[nodiscard]] std::stop_token GetStopToken() const {
+    return stop_source_.get_token();
+  }
+
   /// @brief Sets the dynamic task type.
   /// @param type_of_task Task type to set.
   void SetTypeOfTask(TypeOfTask type_of_task) {
@@ -299,6 +423,17 @@ class Task {
     return input_;
   }
 
+  /// @brief Returns read-only access to the input data.
+  /// @return The shared input bound with ShareInput(), otherwise the task's own input.
+  [[nodiscard]] const InType &GetInputView() const {
+    return shared_input_ ? *shared_input_ : input_;
+  }
+
+  /// @brief Returns true when the task reads a shared input bound with ShareInput() instead of GetInput().
+  [[nodiscard]] bool HasSharedInput() const {
+    return shared_input_ != nullptr;
+  }
+
   /// @brief Returns a reference to the output data.
   /// @return Reference to the task's output data.
   OutType &GetOutput() {
@@ -312,11 +447,25 @@ class Task {
       ppc::util::DestructorFailureFlag::Set();
     }
 #if _OPENMP >= 201811
-    omp_pause_resource_all(omp_pause_soft);
+    // A live RuntimeManager keeps the OpenMP team warm for the next task and releases it at exit.
+    if (!ppc::runtime::RuntimeManager::IsActive()) {
+      omp_pause_resource_all(omp_pause_soft);
+    }
 #endif
   }
 
  protected:
+  /// @brief Returns true once the pipeline was abandoned, by Abort() or by a stage called out of order.
+  [[nodiscard]] bool IsAborted() const {
+    return stage_ == PipelineStage::kException;
+  }
+
+  /// @brief Binds a shared read-only input instead of keeping a private copy.
+  /// @details Intended for constructors taking SharedInput<InType>; read the data through GetInputView().
+  void ShareInput(SharedInput<InType> input) {
+    shared_input_ = std::move(input);
+  }
+
   /// @brief Measures execution time between preprocessing and postprocessing steps.
   /// @throws std::runtime_error If execution exceeds the allowed time limit.
   virtual void InternalTimeTest() final {
@@ -359,10 +508,122 @@ class Task {
   /// @return True if postprocessing is successful.
   virtual bool PostProcessingImpl() = 0;
 
+  /// @brief Processes a batch of inputs on this task instance.
+  /// @details The default loads each input in turn and runs the four stage hooks on it, stopping early when the
+  /// time budget expires. A task reading a shared input (see ShareInput()) reads each item in place; otherwise the
+  /// item is copied into the task's own input. Override to parallelize across items instead of within one item.
+  /// @return True if every item was processed successfully.
+  virtual bool RunBatchImpl(BatchInputs<InType> inputs, std::span<OutType> outputs) {
+    if (shared_input_) {
+      const auto owner = shared_input_;
+      bool result = false;
+      try {
+        // Non-owning handles: each item outlives its iteration, and the owner is restored afterwards.
+        result = RunEachItem(inputs, outputs, [this, &inputs](std::size_t item) -> void {
+          shared_input_ = SharedInput<InType>(SharedInput<InType>(), &inputs[item]);
+        });
+      } catch (...) {
+        shared_input_ = owner;
+        throw;
+      }
+      shared_input_ = owner;
+      return result;
+    }
+    if constexpr (std::is_copy_assignable_v<InType>) {
+      return RunEachItem(inputs, outputs, [this, &inputs](std::size_t item) -> void { input_ = inputs[item]; });
+    } else {
+      throw std::runtime_error("The default RunBatchImpl needs a copy-assignable or shared input");
+    }
+  }
+
  private:
+  bool RunBatchItems(BatchInputs<InType> inputs, std::vector<OutType> &outputs) {
+    if (stage_ == PipelineStage::kNone || stage_ == PipelineStage::kDone) {
+      stage_ = PipelineStage::kRun;
+    } else {
+      stage_ = PipelineStage::kException;
+      throw std::runtime_error("RunBatch should be called before validation or after postprocessing");
+    }
+    outputs.clear();
+    outputs.resize(inputs.Size());
+    stage_metrics_ = {};
+    bool result = false;
+    try {
+      result = TimeStage(
+          "RunBatch", stage_metrics_.run,
+          [this, inputs, &outputs] -> bool { return RunBatchImpl(inputs, std::span<OutType>(outputs)); },
+          static_cast<double>(std::max<std::size_t>(inputs.Size(), 1)));
+    } catch (...) {
+      stage_ = PipelineStage::kException;
+      throw;
+    }
+    stage_ = PipelineStage::kDone;
+    return result;
+  }
+
+  template <typename LoadItem>
+  bool RunEachItem(const BatchInputs<InType> &inputs, std::span<OutType> outputs, LoadItem &&load_item) {
+    for (std::size_t item = 0; item < inputs.Size(); ++item) {
+      load_item(item);
+      output_ = OutType{};
+      if (IsStopRequested() || !ValidationImpl() || !PreProcessingImpl() || !RunImpl() || !PostProcessingImpl()) {
+        return false;
+      }
+      outputs[item] = std::move(output_);
+    }
+    return true;
+  }
+
+  template <typename StageImpl>
+  bool TimeStage(const char *stage_name, StageMetrics &metrics, StageImpl &&stage_impl, double budget_scale = 1.0) {
+    // A stop source is only replaced once a budget expired on it, so stages normally reuse its shared state.
+    if (stop_source_.stop_requested()) {
+      stop_source_ = std::stop_source{};
+    }
+    const ppc::util::WatchdogScope watchdog(watchdog_slot_, TypeOfTaskToString(type_of_task_), stage_name,
+                                            budget_scale * StageBudget(), stop_source_);
+    PPC_TRACE_SCOPE_CATEGORY(stage_name, "task");
+    const auto *counters = ppc::util::PerfCounters::Active();
+    const auto counters_before = counters != nullptr ? counters->Read() : ppc::util::PerfCounterValues{};
+    std::optional<ppc::util::AllocationMeasurement> allocations;
+    if constexpr (ppc::util::kAllocTrackingEnabled) {
+      allocations.emplace();
+    }
+    std::optional<ppc::util::MpiProfileMeasurement> mpi_profile;
+    std::optional<ppc::util::MpiTrafficScope> mpi_traffic;
+    if constexpr (ppc::util::kMpiProfilingEnabled) {
+      mpi_profile.emplace();
+      mpi_traffic.emplace();
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    const bool result = std::forward<StageImpl>(stage_impl)();
+    metrics.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    metrics.allocations = allocations.has_value() ? allocations->Stop() : ppc::util::AllocationStats{};
+    metrics.mpi_profile = mpi_profile.has_value() ? mpi_profile->Stop() : ppc::util::MpiProfile{};
+    metrics.counters = counters != nullptr ? ppc::util::PerfCounterValues::Delta(counters_before, counters->Read())
+                                           : ppc::util::PerfCounterValues{};
+    return result;
+  }
+
+  /// @brief Returns the time budget of one stage, read from the environment once per state of testing.
+  double StageBudget() {
+    if (budget_state_ != state_of_testing_) {
+      budget_state_ = state_of_testing_;
+      stage_budget_ = state_of_testing_ == StateOfTesting::kPerf ? ppc::util::GetPerfMaxTime()
+                                                                 : ppc::util::GetTaskMaxTime();
+    }
+    return stage_budget_;
+  }
+
   InType input_{};
+  SharedInput<InType> shared_input_;
   OutType output_{};
   StateOfTesting state_of_testing_ = StateOfTesting::kFunc;
+  PipelineMetrics stage_metrics_;
+  std::stop_source stop_source_;
+  ppc::util::WatchdogSlot watchdog_slot_;
+  std::optional<StateOfTesting> budget_state_;
+  double stage_budget_ = 0.0;
   TypeOfTask type_of_task_ = TypeOfTask::kUnknown;
   StatusOfTask status_of_task_ = StatusOfTask::kEnabled;
   std::chrono::high_resolution_clock::time_point tmp_time_point_;
@@ -385,11 +646,31 @@ using TaskPtr = std::unique_ptr<Task<InType, OutType>>;
 /// @brief Constructs and returns a pointer to a task with the given input.
 /// @tparam TaskType Type of the task to create.
 /// @tparam InType Type of the input.
-/// @param in Input to pass to the task constructor.
+/// @param in Input to pass to the task constructor; moved in, so move-only inputs are supported.
 /// @return Unique pointer to the newly created task.
+/// @note Tasks constructible only from SharedInput<InType> receive the input wrapped in a shared handle.
 template <typename TaskType, typename InType>
-std::unique_ptr<TaskType> TaskGetter(const InType &in) {
-  return std::make_unique<TaskType>(in);
+std::unique_ptr<TaskType> TaskGetter(InType in) {
+  if constexpr (std::is_constructible_v<TaskType, InType>) {
+    return std::make_unique<TaskType>(std::move(in));
+  } else {
+    return std::make_unique<TaskType>(std::make_shared<const InType>(std::move(in)));
+  }
+}
+
+/// @brief Constructs a task from an input shared with other task instances.
+/// @tparam TaskType Type of the task to create.
+/// @tparam InType Type of the input.
+/// @param in Shared read-only input.
+/// @return Unique pointer to the newly created task.
+/// @note Tasks without a SharedInput<InType> constructor receive a copy of the input.
+template <typename TaskType, typename InType>
+std::unique_ptr<TaskType> SharedTaskGetter(SharedInput<InType> in) {
+  if constexpr (std::is_constructible_v<TaskType, SharedInput<InType>>) {
+    return std::make_unique<TaskType>(std::move(in));
+  } else {
+    return std::make_unique<TaskType>(*in);
+  }
 }
 
 }  // namespace ppc::task
@@ -0,0 +1,388 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "task/include/pipelined_runner.hpp"
+#include "task/include/task.hpp"
+
+namespace ppc::task {
+
+/// @brief Timing of one task graph node, relative to the start of TaskGraph::Execute().
+struct NodeTiming {
+  double start = 0.0;
+  double finish = 0.0;
+  StageTimings stages;
+
+  [[nodiscard]] double Duration() const {
+    return finish - start;
+  }
+};
+
+/// @brief Composes tasks into a DAG where a producer's output is moved into its consumer's input.
+/// @details Nodes must be added after the nodes they depend on, so node ids are a topological order.
+/// A producer feeding several consumers copies its output into all but the last one, which receives it
+/// by move; with a single consumer no data is copied. Independent branches run concurrently unless the
+/// graph contains MPI-based tasks, which run serially in node id order on every rank.
+class TaskGraph {
+ public:
+  using NodeId = std::size_t;
+
+  /// @brief Adds a node whose task already holds its input.
+  /// @return Id of the new node.
+  template <typename InType, typename OutType>
+  NodeId AddNode(std::string name, TaskPtr<InType, OutType> task) {
+    if (!task) {
+      throw std::invalid_argument("Task graph node '" + name + "' has no task");
+    }
+    nodes_.push_back(std::make_unique<Node<InType, OutType>>(std::move(name), std::move(task)));
+    return nodes_.size() - 1;
+  }
+
+  /// @brief Adds a node whose input is the output of an existing producer node.
+  /// @throws std::invalid_argument If the producer does not exist or its output type is not InType, or if the task
+  /// reads a shared input (see Task::HasSharedInput()), which would hide the fed data.
+  template <typename InType, typename OutType>
+  NodeId AddNode(std::string name, TaskPtr<InType, OutType> task, NodeId producer) {
+    OutputNode<InType> *source = nullptr;
+    try {
+      source = &DataProducer<InType>(producer, name);
+      if (task && task->HasSharedInput()) {
+        throw std::invalid_argument("Task graph node '" + name + "' reads a shared input and cannot be fed by '" +
+                                    source->name + "'");
+      }
+    } catch (...) {
+      // The rejected task never joins the graph, so it is abandoned here.
+      if (task) {
+        task->Abort();
+      }
+      throw;
+    }
+    const NodeId id = AddNode(std::move(name), std::move(task));
+    auto *consumer = static_cast<Node<InType, OutType> *>(nodes_[id].get());
+    source->consumers.push_back(id);
+    source->feeds.emplace_back([source, consumer](bool last) -> void {
+      if constexpr (std::is_copy_assignable_v<InType>) {
+        if (!last) {
+          consumer->task->GetInput() = source->Output();
+          return;
+        }
+      }
+      consumer->task->GetInput() = std::move(source->Output());
+    });
+    consumer->producers.push_back(producer);
+    return id;
+  }
+
+  /// @brief Orders two nodes without passing data between them.
+  /// @throws std::invalid_argument If before is not an earlier node than after.
+  void AddDependency(NodeId before, NodeId after) {
+    GetNode(after);
+    if (before >= after) {
+      throw std::invalid_argument("Task graph dependencies must point from an earlier node to a later one");
+    }
+    nodes_[before]->consumers.push_back(after);
+    nodes_[after]->producers.push_back(before);
+  }
+
+  /// @brief Runs every node through its full pipeline once, respecting dependencies.
+  /// @param execution kOverlapped runs ready nodes concurrently, kSerial runs them in node id order.
+  /// @return Wall-clock time of the whole graph in seconds.
+  /// @throws Rethrows the first node failure after the running nodes have finished. The failed node and every node
+  /// that did not run because of it are aborted.
+  double Execute(PipelineExecution execution) {
+    const auto begin = Clock::now();
+    graph_begin_ = begin;
+    for (auto &node : nodes_) {
+      node->completed = false;
+    }
+    try {
+      if (execution == PipelineExecution::kSerial) {
+        for (auto &node : nodes_) {
+          RunNode(*node);
+        }
+      } else {
+        ExecuteConcurrently();
+      }
+    } catch (...) {
+      for (auto &node : nodes_) {
+        if (!node->completed) {
+          node->Abort();
+        }
+      }
+      throw;
+    }
+    wall_time_ = std::chrono::duration<double>(Clock::now() - begin).count();
+    return wall_time_;
+  }
+
+  /// @brief Runs the graph serially if any node is MPI-based (see DefaultPipelineExecution), concurrently otherwise.
+  double Execute() {
+    const bool needs_serial = std::ranges::any_of(nodes_, [](const auto &node) -> bool {
+      return DefaultPipelineExecution(node->TypeOfNodeTask()) == PipelineExecution::kSerial;
+    });
+    return Execute(needs_serial ? PipelineExecution::kSerial : PipelineExecution::kOverlapped);
+  }
+
+  /// @brief Returns the output of a node; outputs moved into a consumer are left in a moved-from state.
+  /// @throws std::invalid_argument If the node does not exist or produces a different type.
+  template <typename OutType>
+  OutType &GetOutput(NodeId id) {
+    auto *node = dynamic_cast<OutputNode<OutType> *>(&GetNode(id));
+    if (node == nullptr) {
+      throw std::invalid_argument("Task graph node '" + nodes_[id]->name + "' has a different output type");
+    }
+    return node->Output();
+  }
+
+  [[nodiscard]] std::size_t GetNodeCount() const {
+    return nodes_.size();
+  }
+
+  [[nodiscard]] const std::string &GetNodeName(NodeId id) const {
+    return nodes_.at(id)->name;
+  }
+
+  [[nodiscard]] const NodeTiming &GetNodeTiming(NodeId id) const {
+    return nodes_.at(id)->timing;
+  }
+
+  /// @brief Returns the wall-clock time of the last Execute() call in seconds.
+  [[nodiscard]] double GetWallTime() const {
+    return wall_time_;
+  }
+
+  /// @brief Returns the chain of dependent nodes with the largest summed duration, from source to sink.
+  [[nodiscard]] std::vector<NodeId> GetCriticalPath() const {
+    if (nodes_.empty()) {
+      return {};
+    }
+    std::vector<double> path_time(nodes_.size(), 0.0);
+    std::vector<NodeId> previous(nodes_.size(), kNoNode);
+    for (NodeId id = 0; id < nodes_.size(); ++id) {
+      for (const NodeId producer : nodes_[id]->producers) {
+        if (previous[id] == kNoNode || path_time[producer] > path_time[previous[id]]) {
+          previous[id] = producer;
+        }
+      }
+      path_time[id] = nodes_[id]->timing.Duration() + (previous[id] == kNoNode ? 0.0 : path_time[previous[id]]);
+    }
+    std::vector<NodeId> path;
+    for (NodeId id = static_cast<NodeId>(std::ranges::max_element(path_time) - path_time.begin()); id != kNoNode;
+         id = previous[id]) {
+      path.push_back(id);
+    }
+    std::ranges::reverse(path);
+    return path;
+  }
+
+  /// @brief Returns the summed node durations along GetCriticalPath() in seconds.
+  [[nodiscard]] double GetCriticalPathTime() const {
+    double total = 0.0;
+    for (const NodeId id : GetCriticalPath()) {
+      total += nodes_[id]->timing.Duration();
+    }
+    return total;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  static constexpr NodeId kNoNode = static_cast<NodeId>(-1);
+
+  struct NodeBase {
+    explicit NodeBase(std::string node_name) : name(std::move(node_name)) {}
+    NodeBase(const NodeBase &) = delete;
+    NodeBase(NodeBase &&) = delete;
+    NodeBase &operator=(const NodeBase &) = delete;
+    NodeBase &operator=(NodeBase &&) = delete;
+    virtual ~NodeBase() = default;
+
+    /// Runs Validation through PostProcessing; returns false if a stage reports failure.
+    virtual bool RunPipeline() = 0;
+    /// Leaves the task in a terminal state after its pipeline failed or was skipped.
+    virtual void Abort() = 0;
+    [[nodiscard]] virtual StageTimings GetStageTimings() const = 0;
+    [[nodiscard]] virtual TypeOfTask TypeOfNodeTask() const = 0;
+
+    std::string name;
+    std::vector<NodeId> producers;
+    std::vector<NodeId> consumers;
+    /// Hands the output to each data consumer; the argument tells whether it is the last one.
+    std::vector<std::function<void(bool)>> feeds;
+    NodeTiming timing;
+    /// Set once the pipeline of the last Execute() succeeded
+    bool completed = false;
+  };
+
+  template <typename OutType>
+  struct OutputNode : NodeBase {
+    using NodeBase::NodeBase;
+    virtual OutType &Output() = 0;
+  };
+
+  template <typename InType, typename OutType>
+  struct Node final : OutputNode<OutType> {
+    Node(std::string node_name, TaskPtr<InType, OutType> node_task)
+        : OutputNode<OutType>(std::move(node_name)), task(std::move(node_task)) {}
+    Node(const Node &) = delete;
+    Node(Node &&) = delete;
+    Node &operator=(const Node &) = delete;
+    Node &operator=(Node &&) = delete;
+    /// A graph destroyed before its nodes ran abandons their tasks.
+    ~Node() override {
+      if (!this->completed) {
+        task->Abort();
+      }
+    }
+
+    bool RunPipeline() override {
+      return task->Validation() && task->PreProcessing() && task->Run() && task->PostProcessing();
+    }
+    void Abort() override {
+      task->Abort();
+    }
+    [[nodiscard]] StageTimings GetStageTimings() const override {
+      return task->GetStageTimings();
+    }
+    [[nodiscard]] TypeOfTask TypeOfNodeTask() const override {
+      return task->GetDynamicTypeOfTask();
+    }
+    OutType &Output() override {
+      return task->GetOutput();
+    }
+
+    TaskPtr<InType, OutType> task;
+  };
+
+  NodeBase &GetNode(NodeId id) {
+    if (id >= nodes_.size()) {
+      throw std::invalid_argument("Unknown task graph node id " + std::to_string(id));
+    }
+    return *nodes_[id];
+  }
+
+  /// Returns the producer that can feed its output to a new consumer with input type InType.
+  template <typename InType>
+  OutputNode<InType> &DataProducer(NodeId producer, const std::string &consumer_name) {
+    auto *source = dynamic_cast<OutputNode<InType> *>(&GetNode(producer));
+    if (source == nullptr) {
+      throw std::invalid_argument("Output of task graph node '" + nodes_[producer]->name +
+                                  "' does not match the input type of '" + consumer_name + "'");
+    }
+    if constexpr (!std::is_copy_assignable_v<InType>) {
+      if (!source->consumers.empty()) {
+        throw std::invalid_argument("Move-only output of task graph node '" + source->name +
+                                    "' can feed only one consumer");
+      }
+    }
+    return *source;
+  }
+
+  /// Runs one node, records its timing and forwards its output to the data consumers.
+  void RunNode(NodeBase &node) {
+    node.timing.start = std::chrono::duration<double>(Clock::now() - graph_begin_).count();
+    const bool ok = node.RunPipeline();
+    node.timing.finish = std::chrono::duration<double>(Clock::now() - graph_begin_).count();
+    node.timing.stages = node.GetStageTimings();
+    if (!ok) {
+      throw std::runtime_error("Task graph node '" + node.name + "' failed");
+    }
+    node.completed = true;
+    for (std::size_t i = 0; i < node.feeds.size(); ++i) {
+      node.feeds[i](i + 1 == node.feeds.size());
+    }
+  }
+
+  void ExecuteConcurrently() {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<NodeId> ready;
+    std::vector<std::size_t> pending(nodes_.size());
+    for (NodeId id = 0; id < nodes_.size(); ++id) {
+      pending[id] = nodes_[id]->producers.size();
+      if (pending[id] == 0) {
+        ready.push_back(id);
+      }
+    }
+    std::size_t finished = 0;
+    std::size_t running = 0;
+    std::exception_ptr error;
+
+    auto worker = [&] -> void {
+      std::unique_lock lock(mutex);
+      while (true) {
+        // With nothing ready and nothing running, the remaining nodes wait on a failed producer.
+        changed.wait(lock, [&] -> bool {
+          return !ready.empty() || finished == nodes_.size() || error || running == 0;
+        });
+        if (error || ready.empty()) {
+          return;
+        }
+        const NodeId id = ready.front();
+        ready.pop_front();
+        ++running;
+        lock.unlock();
+        std::exception_ptr node_error;
+        try {
+          RunNode(*nodes_[id]);
+        } catch (...) {
+          node_error = std::current_exception();
+        }
+        lock.lock();
+        --running;
+        ++finished;
+        if (node_error && !error) {
+          error = node_error;
+        }
+        for (const NodeId consumer : nodes_[id]->consumers) {
+          if (--pending[consumer] == 0 && !node_error) {
+            ready.push_back(consumer);
+          }
+        }
+        changed.notify_all();
+      }
+    };
+
+    const std::size_t num_workers = std::max<std::size_t>(1, std::min(nodes_.size(), MaxWidth()));
+    std::vector<std::thread> workers;
+    workers.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+      workers.emplace_back(worker);
+    }
+    for (auto &thread : workers) {
+      thread.join();
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  /// Upper bound on the number of nodes that can be ready at the same time.
+  [[nodiscard]] std::size_t MaxWidth() const {
+    std::size_t width = 0;
+    for (const auto &node : nodes_) {
+      width += node->producers.empty() ? 1 : 0;
+      width += node->consumers.size() > 1 ? node->consumers.size() - 1 : 0;
+    }
+    return width;
+  }
+
+  std::vector<std::unique_ptr<NodeBase>> nodes_;
+  Clock::time_point graph_begin_;
+  double wall_time_ = 0.0;
+};
+
+}  // namespace ppc::task
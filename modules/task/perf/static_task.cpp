@@ -0,0 +1,123 @@
+#include "task/include/static_task.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "task/include/task.hpp"
+
+namespace {
+
+// The same tiny task written against both bases; the benchmarks measure the per-invocation cost of the base.
+// Task times every stage, arms the watchdog and collects the enabled stage metrics, while StaticTask does none of
+// that, so the BmStaticTask* numbers are the bare pipeline. The BmStaticTaskAdapter* benchmarks run the static task
+// behind the same Task instrumentation and are the like-for-like comparison with BmVirtualTask*.
+
+class VirtualIncrementTask : public ppc::task::Task<int, int> {
+ public:
+  explicit VirtualIncrementTask(int in = 0) {
+    GetInput() = in;
+  }
+
+ protected:
+  bool ValidationImpl() override {
+    return GetInput() >= 0;
+  }
+  bool PreProcessingImpl() override {
+    return true;
+  }
+  bool RunImpl() override {
+    GetOutput() = GetInput() + 1;
+    return true;
+  }
+  bool PostProcessingImpl() override {
+    return true;
+  }
+};
+
+class StaticIncrementTask : public ppc::task::StaticTask<StaticIncrementTask, int, int> {
+ public:
+  explicit StaticIncrementTask(int in = 0) {
+    GetInput() = in;
+  }
+
+ private:
+  friend StaticTask;
+
+  bool ValidationImpl() {
+    return GetInput() >= 0;
+  }
+  bool PreProcessingImpl() {
+    return true;
+  }
+  bool RunImpl() {
+    GetOutput() = GetInput() + 1;
+    return true;
+  }
+  bool PostProcessingImpl() {
+    return true;
+  }
+};
+
+constexpr int kBatchSize = 1024;
+
+template <typename TaskType>
+bool RunPipeline(TaskType &task) {
+  return task.Validation() && task.PreProcessing() && task.Run() && task.PostProcessing();
+}
+
+void BmVirtualTaskPipeline(benchmark::State &state) {
+  int input = 0;
+  for (auto _ : state) {
+    ppc::task::TaskPtr<int, int> task = std::make_unique<VirtualIncrementTask>(input++ & 0xFF);
+    benchmark::DoNotOptimize(RunPipeline(*task));
+    benchmark::DoNotOptimize(task->GetOutput());
+  }
+}
+
+void BmStaticTaskPipeline(benchmark::State &state) {
+  int input = 0;
+  for (auto _ : state) {
+    StaticIncrementTask task(input++ & 0xFF);
+    benchmark::DoNotOptimize(RunPipeline(task));
+    benchmark::DoNotOptimize(task.GetOutput());
+  }
+}
+
+void BmStaticTaskAdapterPipeline(benchmark::State &state) {
+  int input = 0;
+  for (auto _ : state) {
+    ppc::task::TaskPtr<int, int> task =
+        std::make_unique<ppc::task::StaticTaskAdapter<StaticIncrementTask>>(input++ & 0xFF);
+    benchmark::DoNotOptimize(RunPipeline(*task));
+    benchmark::DoNotOptimize(task->GetOutput());
+  }
+}
+
+template <typename TaskType>
+void BmBatch(benchmark::State &state) {
+  std::vector<int> inputs(kBatchSize);
+  for (int i = 0; i < kBatchSize; ++i) {
+    inputs[i] = i;
+  }
+  std::vector<int> outputs;
+  TaskType task;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(task.RunBatch(inputs, outputs));
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * kBatchSize);
+}
+
+}  // namespace
+
+BENCHMARK(BmVirtualTaskPipeline);
+BENCHMARK(BmStaticTaskPipeline);
+BENCHMARK(BmStaticTaskAdapterPipeline);
+BENCHMARK(BmBatch<VirtualIncrementTask>)->Name("BmVirtualTaskBatch");
+BENCHMARK(BmBatch<StaticIncrementTask>)->Name("BmStaticTaskBatch");
+BENCHMARK(BmBatch<ppc::task::StaticTaskAdapter<StaticIncrementTask>>)->Name("BmStaticTaskAdapterBatch");
+
+BENCHMARK_MAIN();
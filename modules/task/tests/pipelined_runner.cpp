@@ -0,0 +1,121 @@
+#include "task/include/pipelined_runner.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "task/include/task.hpp"
+#include "util/include/util.hpp"
+
+using ppc::task::PipelinedRunner;
+using ppc::task::PipelineExecution;
+
+namespace {
+
+class SquareTask : public ppc::task::Task<int, int> {
+ public:
+  explicit SquareTask(int in, std::chrono::milliseconds stage_delay = std::chrono::milliseconds(0))
+      : stage_delay_(stage_delay) {
+    GetInput() = in;
+  }
+
+ protected:
+  bool ValidationImpl() override {
+    return GetInput() >= 0;
+  }
+  bool PreProcessingImpl() override {
+    std::this_thread::sleep_for(stage_delay_);
+    return true;
+  }
+  bool RunImpl() override {
+    std::this_thread::sleep_for(stage_delay_);
+    GetOutput() = GetInput() * GetInput();
+    return true;
+  }
+  bool PostProcessingImpl() override {
+    std::this_thread::sleep_for(stage_delay_);
+    return true;
+  }
+
+ private:
+  std::chrono::milliseconds stage_delay_;
+};
+
+double RunStream(PipelineExecution execution, std::size_t items, std::chrono::milliseconds stage_delay) {
+  const auto begin = std::chrono::steady_clock::now();
+  PipelinedRunner<int, int> runner(execution);
+  std::vector<std::future<int>> results;
+  for (std::size_t i = 0; i < items; ++i) {
+    results.push_back(runner.Submit(std::make_unique<SquareTask>(static_cast<int>(i), stage_delay)));
+  }
+  for (auto &result : results) {
+    result.get();
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+}  // namespace
+
+TEST(PipelinedRunner, DeliversOutputsInSubmissionOrder) {
+  PipelinedRunner<int, int> runner;
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 8; ++i) {
+    results.push_back(runner.Submit(std::make_unique<SquareTask>(i)));
+  }
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(results[i].get(), i * i);
+  }
+  runner.Finish();
+  EXPECT_EQ(runner.GetCompletedCount(), 8U);
+  EXPECT_GT(runner.GetItemsPerSecond(), 0.0);
+}
+
+TEST(PipelinedRunner, OverlapsStagesOfConsecutiveTasks) {
+  constexpr std::size_t kItems = 6;
+  const auto stage_delay = std::chrono::milliseconds(30);
+  const double serial = RunStream(PipelineExecution::kSerial, kItems, stage_delay);
+  const double overlapped = RunStream(PipelineExecution::kOverlapped, kItems, stage_delay);
+  EXPECT_LT(overlapped, serial * 0.8);
+}
+
+TEST(PipelinedRunner, SerialExecutionCompletesTaskBeforeSubmitReturns) {
+  PipelinedRunner<int, int> runner(PipelineExecution::kSerial);
+  auto result = runner.Submit(std::make_unique<SquareTask>(7));
+  EXPECT_EQ(result.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+  EXPECT_EQ(result.get(), 49);
+}
+
+TEST(PipelinedRunner, FailedStageSetsExceptionAndKeepsStreamGoing) {
+  PipelinedRunner<int, int> runner;
+  auto failed = runner.Submit(std::make_unique<SquareTask>(-1));
+  auto next = runner.Submit(std::make_unique<SquareTask>(3));
+  EXPECT_THROW(failed.get(), std::runtime_error);
+  EXPECT_EQ(next.get(), 9);
+  runner.Finish();
+  EXPECT_FALSE(ppc::util::DestructorFailureFlag::Get());
+}
+
+TEST(PipelinedRunner, RejectsTasksAfterFinish) {
+  PipelinedRunner<int, int> runner;
+  runner.Finish();
+  auto task = std::make_unique<SquareTask>(1);
+  EXPECT_THROW(runner.Submit(std::move(task)), std::runtime_error);
+  EXPECT_FALSE(ppc::util::DestructorFailureFlag::Get());
+}
+
+TEST(PipelinedRunner, RejectsNullTasks) {
+  PipelinedRunner<int, int> runner;
+  EXPECT_THROW(runner.Submit(nullptr), std::invalid_argument);
+  EXPECT_EQ(runner.Submit(std::make_unique<SquareTask>(2)).get(), 4);
+}
+
+TEST(PipelinedRunner, MpiTasksRunSeriallyWithoutThreadMultiple) {
+  EXPECT_EQ(ppc::task::DefaultPipelineExecution(ppc::task::TypeOfTask::kSEQ), PipelineExecution::kOverlapped);
+  EXPECT_EQ(ppc::task::DefaultPipelineExecution(ppc::task::TypeOfTask::kMPI), PipelineExecution::kSerial);
+}
@@ -0,0 +1,160 @@
+#include "task/include/static_task.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "task/include/pipelined_runner.hpp"
+#include "task/include/task.hpp"
+#include "task/include/task_graph.hpp"
+#include "util/include/util.hpp"
+
+namespace static_task_test {
+
+class SquareTask : public ppc::task::StaticTask<SquareTask, int, int> {
+ public:
+  SquareTask() = default;
+  explicit SquareTask(int in) {
+    SetTypeOfTask(GetStaticTypeOfTask());
+    GetInput() = in;
+  }
+
+  static constexpr ppc::task::TypeOfTask GetStaticTypeOfTask() {
+    return ppc::task::TypeOfTask::kSEQ;
+  }
+
+ private:
+  friend StaticTask;
+
+  bool ValidationImpl() {
+    return GetInput() >= 0 && GetOutput() == 0;
+  }
+  bool PreProcessingImpl() {
+    return true;
+  }
+  bool RunImpl() {
+    GetOutput() = GetInput() * GetInput();
+    return true;
+  }
+  bool PostProcessingImpl() {
+    return true;
+  }
+};
+
+class SumTask : public ppc::task::StaticTask<SumTask, std::vector<int>, int> {
+ public:
+  explicit SumTask(std::vector<int> in) {
+    GetInput() = std::move(in);
+  }
+
+ private:
+  friend StaticTask;
+
+  bool ValidationImpl() {
+    return !GetInput().empty();
+  }
+  bool PreProcessingImpl() {
+    return true;
+  }
+  bool RunImpl() {
+    GetOutput() = std::accumulate(GetInput().begin(), GetInput().end(), 0);
+    return true;
+  }
+  bool PostProcessingImpl() {
+    return true;
+  }
+};
+
+}  // namespace static_task_test
+
+using ppc::task::StaticTaskAdapter;
+using static_task_test::SquareTask;
+using static_task_test::SumTask;
+
+TEST(StaticTask, RunsPipelineOnTheStack) {
+  SquareTask task(7);
+  ASSERT_TRUE(task.Validation());
+  ASSERT_TRUE(task.PreProcessing());
+  ASSERT_TRUE(task.Run());
+  ASSERT_TRUE(task.PostProcessing());
+  EXPECT_EQ(task.GetOutput(), 49);
+  EXPECT_EQ(task.GetDynamicTypeOfTask(), ppc::task::TypeOfTask::kSEQ);
+}
+
+TEST(StaticTask, ChecksStageOrderLikeTask) {
+  SquareTask task(2);
+  EXPECT_THROW(task.Run(), std::runtime_error);
+  SquareTask other(2);
+  other.Validation();
+  EXPECT_THROW(other.PostProcessing(), std::runtime_error);
+}
+
+TEST(StaticTask, RunBatchUsesTheStaticStageHooks) {
+  SquareTask task;
+  std::vector<int> outputs;
+  ASSERT_TRUE(task.RunBatch(std::vector<int>{1, 2, 3}, outputs));
+  EXPECT_EQ(outputs, (std::vector<int>{1, 4, 9}));
+  EXPECT_FALSE(task.RunBatch(std::vector<int>{-1}, outputs));
+}
+
+TEST(StaticTask, AdapterWorksWithTaskGetter) {
+  ppc::task::TaskPtr<int, int> task = ppc::task::TaskGetter<StaticTaskAdapter<SquareTask>, int>(5);
+  EXPECT_EQ(task->GetDynamicTypeOfTask(), ppc::task::TypeOfTask::kSEQ);
+  EXPECT_EQ(task->GetInput(), 5);
+  ASSERT_TRUE(task->Validation());
+  ASSERT_TRUE(task->PreProcessing());
+  ASSERT_TRUE(task->Run());
+  ASSERT_TRUE(task->PostProcessing());
+  EXPECT_EQ(task->GetOutput(), 25);
+  EXPECT_GE(task->GetStageTimings().run, 0.0);
+
+  std::vector<int> outputs;
+  ASSERT_TRUE(task->RunBatch(std::vector<int>{2, 4}, outputs));
+  EXPECT_EQ(outputs, (std::vector<int>{4, 16}));
+}
+
+TEST(StaticTask, AdapterKeepsItsInputForTheNextPass) {
+  StaticTaskAdapter<SumTask> task(std::vector<int>{1, 2, 3});
+  for (int pass = 0; pass < 2; ++pass) {
+    ASSERT_TRUE(task.Validation());
+    ASSERT_TRUE(task.PreProcessing());
+    ASSERT_TRUE(task.Run());
+    ASSERT_TRUE(task.PostProcessing());
+    EXPECT_EQ(task.GetOutput(), 6);
+  }
+  task.GetInput() = {4, 5};
+  ASSERT_TRUE(task.Validation());
+  ASSERT_TRUE(task.PreProcessing());
+  ASSERT_TRUE(task.Run());
+  ASSERT_TRUE(task.PostProcessing());
+  EXPECT_EQ(task.GetOutput(), 9);
+}
+
+TEST(StaticTask, FailedAdapterInPipelinedRunnerAbortsTheWrappedTask) {
+  ppc::task::PipelinedRunner<int, int> runner;
+  auto failed = runner.Submit(std::make_unique<StaticTaskAdapter<SquareTask>>(-1));
+  auto next = runner.Submit(std::make_unique<StaticTaskAdapter<SquareTask>>(3));
+  EXPECT_THROW(failed.get(), std::runtime_error);
+  EXPECT_EQ(next.get(), 9);
+  runner.Finish();
+  EXPECT_FALSE(ppc::util::DestructorFailureFlag::Get());
+}
+
+TEST(StaticTask, FailedAdapterInTaskGraphAbortsTheWrappedTasks) {
+  {
+    ppc::task::TaskGraph graph;
+    const auto source = graph.AddNode<int, int>("bad", std::make_unique<StaticTaskAdapter<SquareTask>>(-1));
+    graph.AddNode<int, int>("square", std::make_unique<StaticTaskAdapter<SquareTask>>(), source);
+    EXPECT_THROW(graph.Execute(ppc::task::PipelineExecution::kOverlapped), std::runtime_error);
+  }
+  EXPECT_FALSE(ppc::util::DestructorFailureFlag::Get());
+}
+
+TEST(StaticTask, AdapterIsNamedAfterTheWrappedTask) {
+  EXPECT_EQ(ppc::util::GetNamespace<StaticTaskAdapter<SquareTask>>(), "static_task_test");
+  EXPECT_EQ(StaticTaskAdapter<SquareTask>::GetStaticTypeOfTask(), ppc::task::TypeOfTask::kSEQ);
+}
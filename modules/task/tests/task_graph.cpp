@@ -0,0 +1,183 @@
+#include "task/include/task_graph.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "task/include/pipelined_runner.hpp"
+#include "task/include/task.hpp"
+#include "util/include/util.hpp"
+
+using ppc::task::PipelineExecution;
+using ppc::task::TaskGraph;
+
+namespace {
+
+class IotaTask : public ppc::task::Task<int, std::vector<int>> {
+ public:
+  explicit IotaTask(int in, std::chrono::milliseconds delay = std::chrono::milliseconds(0)) : delay_(delay) {
+    SetTypeOfTask(ppc::task::TypeOfTask::kSEQ);
+    GetInput() = in;
+  }
+
+  const int *produced_data = nullptr;
+
+ protected:
+  bool ValidationImpl() override {
+    return GetInput() >= 0;
+  }
+  bool PreProcessingImpl() override {
+    return true;
+  }
+  bool RunImpl() override {
+    std::this_thread::sleep_for(delay_);
+    GetOutput().resize(static_cast<std::size_t>(GetInput()));
+    std::iota(GetOutput().begin(), GetOutput().end(), 0);
+    produced_data = GetOutput().data();
+    return true;
+  }
+  bool PostProcessingImpl() override {
+    return true;
+  }
+
+ private:
+  std::chrono::milliseconds delay_;
+};
+
+class SumTask : public ppc::task::Task<std::vector<int>, int> {
+ public:
+  explicit SumTask(std::chrono::milliseconds delay = std::chrono::milliseconds(0)) : delay_(delay) {
+    SetTypeOfTask(ppc::task::TypeOfTask::kSEQ);
+  }
+
+  const int *received_data = nullptr;
+
+ protected:
+  bool ValidationImpl() override {
+    received_data = GetInput().data();
+    return true;
+  }
+  bool PreProcessingImpl() override {
+    return true;
+  }
+  bool RunImpl() override {
+    std::this_thread::sleep_for(delay_);
+    GetOutput() = std::accumulate(GetInput().begin(), GetInput().end(), 0);
+    return true;
+  }
+  bool PostProcessingImpl() override {
+    return true;
+  }
+
+ private:
+  std::chrono::milliseconds delay_;
+};
+
+class SharedSumTask : public ppc::task::Task<std::vector<int>, int> {
+ public:
+  explicit SharedSumTask(ppc::task::SharedInput<std::vector<int>> in) {
+    SetTypeOfTask(ppc::task::TypeOfTask::kSEQ);
+    ShareInput(std::move(in));
+  }
+
+ protected:
+  bool ValidationImpl() override {
+    return true;
+  }
+  bool PreProcessingImpl() override {
+    return true;
+  }
+  bool RunImpl() override {
+    GetOutput() = std::accumulate(GetInputView().begin(), GetInputView().end(), 0);
+    return true;
+  }
+  bool PostProcessingImpl() override {
+    return true;
+  }
+};
+
+}  // namespace
+
+TEST(TaskGraph, ChainsOutputIntoInputWithoutCopy) {
+  TaskGraph graph;
+  auto iota = std::make_unique<IotaTask>(100);
+  auto sum = std::make_unique<SumTask>();
+  const auto *iota_task = iota.get();
+  const auto *sum_task = sum.get();
+  const auto source = graph.AddNode<int, std::vector<int>>("iota", std::move(iota));
+  const auto sink = graph.AddNode<std::vector<int>, int>("sum", std::move(sum), source);
+
+  graph.Execute(PipelineExecution::kSerial);
+
+  EXPECT_EQ(graph.GetOutput<int>(sink), 4950);
+  EXPECT_NE(sum_task->received_data, nullptr);
+  EXPECT_EQ(sum_task->received_data, iota_task->produced_data);
+}
+
+TEST(TaskGraph, FanOutFeedsEveryConsumer) {
+  TaskGraph graph;
+  const auto source = graph.AddNode<int, std::vector<int>>("iota", std::make_unique<IotaTask>(10));
+  const auto left = graph.AddNode<std::vector<int>, int>("left", std::make_unique<SumTask>(), source);
+  const auto right = graph.AddNode<std::vector<int>, int>("right", std::make_unique<SumTask>(), source);
+
+  graph.Execute();
+
+  EXPECT_EQ(graph.GetOutput<int>(left), 45);
+  EXPECT_EQ(graph.GetOutput<int>(right), 45);
+}
+
+TEST(TaskGraph, RunsIndependentBranchesConcurrentlyAndReportsCriticalPath) {
+  const auto delay = std::chrono::milliseconds(80);
+  TaskGraph graph;
+  const auto slow_source = graph.AddNode<int, std::vector<int>>("slow", std::make_unique<IotaTask>(4, delay));
+  const auto slow_sink =
+      graph.AddNode<std::vector<int>, int>("slow_sum", std::make_unique<SumTask>(delay), slow_source);
+  const auto fast_source = graph.AddNode<int, std::vector<int>>("fast", std::make_unique<IotaTask>(4, delay));
+  graph.AddNode<std::vector<int>, int>("fast_sum", std::make_unique<SumTask>(), fast_source);
+
+  const double wall_time = graph.Execute(PipelineExecution::kOverlapped);
+
+  EXPECT_LT(wall_time, 3 * delay.count() * 1e-3);
+  const std::vector<TaskGraph::NodeId> expected_path{slow_source, slow_sink};
+  EXPECT_EQ(graph.GetCriticalPath(), expected_path);
+  EXPECT_GE(graph.GetCriticalPathTime(), 2 * delay.count() * 1e-3);
+  EXPECT_GE(graph.GetNodeTiming(slow_sink).start, graph.GetNodeTiming(slow_source).finish);
+  EXPECT_GE(graph.GetNodeTiming(slow_sink).stages.run, delay.count() * 1e-3);
+}
+
+TEST(TaskGraph, RejectsMismatchedTypesAndBackwardDependencies) {
+  TaskGraph graph;
+  const auto sum = graph.AddNode<std::vector<int>, int>("sum", std::make_unique<SumTask>());
+  auto wrong_consumer = std::make_unique<SumTask>();
+  EXPECT_THROW((graph.AddNode<std::vector<int>, int>("wrong", std::move(wrong_consumer), sum)), std::invalid_argument);
+  EXPECT_THROW(graph.AddDependency(sum, sum), std::invalid_argument);
+}
+
+TEST(TaskGraph, RejectsFedNodesReadingASharedInput) {
+  {
+    TaskGraph graph;
+    const auto source = graph.AddNode<int, std::vector<int>>("iota", std::make_unique<IotaTask>(10));
+    auto shared = std::make_unique<SharedSumTask>(std::make_shared<const std::vector<int>>(std::vector<int>{1, 2}));
+    EXPECT_THROW((graph.AddNode<std::vector<int>, int>("shared", std::move(shared), source)), std::invalid_argument);
+    EXPECT_EQ(graph.GetNodeCount(), 1U);
+    graph.Execute(PipelineExecution::kSerial);
+  }
+  EXPECT_FALSE(ppc::util::DestructorFailureFlag::Get());
+}
+
+TEST(TaskGraph, FailedNodeStopsDependentsAndRethrows) {
+  {
+    TaskGraph graph;
+    const auto source = graph.AddNode<int, std::vector<int>>("bad", std::make_unique<IotaTask>(-1));
+    graph.AddNode<std::vector<int>, int>("sum", std::make_unique<SumTask>(), source);
+    EXPECT_THROW(graph.Execute(PipelineExecution::kOverlapped), std::runtime_error);
+  }
+  EXPECT_FALSE(ppc::util::DestructorFailureFlag::Get());
+}
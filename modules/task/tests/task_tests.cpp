@@ -8,6 +8,7 @@
 #include <fstream>
 #include <libenvpp/env.hpp>
 #include <memory>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <system_error>
@@ -17,6 +18,7 @@
 
 #include "runners/include/runners.hpp"
 #include "task/include/task.hpp"
+#include "util/include/perf_counters.hpp"
 #include "util/include/util.hpp"
 
 using ppc::task::StateOfTesting;
@@ -393,6 +395,16 @@ class DummyTask : public Task<int, int> {
   }
 };
 
+TEST(TaskTest, AbortedTaskCanBeDestroyedMidPipeline) {
+  {
+    DummyTask task;
+    task.Validation();
+    task.Abort();
+    EXPECT_THROW(task.Run(), std::runtime_error);
+  }
+  EXPECT_FALSE(ppc::util::DestructorFailureFlag::Get());
+}
+
 TEST(TaskTest, GetDynamicTypeReturnsCorrectEnum) {
   DummyTask task;
   task.SetTypeOfTask(TypeOfTask::kOMP);
@@ -426,6 +438,282 @@ TEST(TaskTest, PostProcessingThrowsIfCalledBeforeRun) {
   EXPECT_THROW(task->PostProcessing(), std::runtime_error);
 }
 
+TEST(TaskTest, StageTimingsRecordEachStage) {
+  struct SleepyRunTask : Task<int, int> {
+   protected:
+    bool ValidationImpl() override {
+      return true;
+    }
+    bool PreProcessingImpl() override {
+      return true;
+    }
+    bool RunImpl() override {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      return true;
+    }
+    bool PostProcessingImpl() override {
+      return true;
+    }
+  } task;
+
+  EXPECT_DOUBLE_EQ(task.GetStageTimings().run, 0.0);
+  task.Validation();
+  task.PreProcessing();
+  task.Run();
+  task.PostProcessing();
+
+  const auto timings = task.GetStageTimings();
+  EXPECT_GE(timings.validation, 0.0);
+  EXPECT_GE(timings.preprocessing, 0.0);
+  EXPECT_GE(timings.run, 0.02);
+  EXPECT_GE(timings.postprocessing, 0.0);
+  EXPECT_LT(timings.postprocessing, timings.run);
+}
+
+TEST(TaskTest, StageCountersAreReadFromTheActivePerfCounters) {
+  DummyTask task;
+  task.Validation();
+  EXPECT_FALSE(task.GetStageMetrics().validation.counters.Has(ppc::util::PerfCounterKind::kPageFaults));
+
+  const ppc::util::PerfCounters counters(false);
+  const ppc::util::ActivePerfCountersScope active(counters);
+  task.PreProcessing();
+  task.Run();
+  task.PostProcessing();
+  const auto &run = task.GetStageMetrics().run.counters;
+  EXPECT_TRUE(run.Has(ppc::util::PerfCounterKind::kPageFaults));
+  EXPECT_GE(run.Get(ppc::util::PerfCounterKind::kPageFaults), 0.0);
+  EXPECT_FALSE(run.Has(ppc::util::PerfCounterKind::kCycles));
+}
+
+namespace {
+
+class SharedInputTask : public Task<std::vector<int>, int> {
+ public:
+  explicit SharedInputTask(ppc::task::SharedInput<std::vector<int>> in) {
+    ShareInput(std::move(in));
+  }
+
+ protected:
+  bool ValidationImpl() override {
+    return !GetInputView().empty();
+  }
+  bool PreProcessingImpl() override {
+    GetOutput() = 0;
+    return true;
+  }
+  bool RunImpl() override {
+    for (const int value : GetInputView()) {
+      GetOutput() += value;
+    }
+    return true;
+  }
+  bool PostProcessingImpl() override {
+    return true;
+  }
+};
+
+class MoveOnlyInputTask : public Task<std::unique_ptr<int>, int> {
+ public:
+  explicit MoveOnlyInputTask(std::unique_ptr<int> in) {
+    GetInput() = std::move(in);
+  }
+
+ protected:
+  bool ValidationImpl() override {
+    return GetInput() != nullptr;
+  }
+  bool PreProcessingImpl() override {
+    return true;
+  }
+  bool RunImpl() override {
+    GetOutput() = *GetInput();
+    return true;
+  }
+  bool PostProcessingImpl() override {
+    return true;
+  }
+};
+
+template <typename TaskType>
+void RunWholePipeline(TaskType &task) {
+  ASSERT_TRUE(task.Validation());
+  ASSERT_TRUE(task.PreProcessing());
+  ASSERT_TRUE(task.Run());
+  ASSERT_TRUE(task.PostProcessing());
+}
+
+}  // namespace
+
+TEST(TaskTest, SharedTaskGetterPassesInputWithoutCopy) {
+  const auto input = std::make_shared<const std::vector<int>>(std::vector<int>{1, 2, 3});
+  auto first = ppc::task::SharedTaskGetter<SharedInputTask, std::vector<int>>(input);
+  auto second = ppc::task::SharedTaskGetter<SharedInputTask, std::vector<int>>(input);
+
+  EXPECT_EQ(&first->GetInputView(), input.get());
+  EXPECT_EQ(&second->GetInputView(), input.get());
+  RunWholePipeline(*first);
+  RunWholePipeline(*second);
+  EXPECT_EQ(first->GetOutput(), 6);
+  EXPECT_EQ(second->GetOutput(), 6);
+}
+
+TEST(TaskTest, SharedTaskGetterCopiesInputForOwningTasks) {
+  const auto input = std::make_shared<const std::vector<int32_t>>(std::vector<int32_t>(10, 1));
+  auto task = ppc::task::SharedTaskGetter<ppc::test::TestTask<std::vector<int32_t>, int32_t>, std::vector<int32_t>>(
+      input);
+
+  EXPECT_NE(&task->GetInputView(), input.get());
+  RunWholePipeline(*task);
+  EXPECT_EQ(task->GetOutput(), 10);
+}
+
+TEST(TaskTest, TaskGetterWrapsInputForSharedInputTasks) {
+  auto task = ppc::task::TaskGetter<SharedInputTask, std::vector<int>>(std::vector<int>{4, 5});
+  RunWholePipeline(*task);
+  EXPECT_EQ(task->GetOutput(), 9);
+}
+
+TEST(TaskTest, TaskGetterSupportsMoveOnlyInput) {
+  auto task = ppc::task::TaskGetter<MoveOnlyInputTask, std::unique_ptr<int>>(std::make_unique<int>(7));
+  RunWholePipeline(*task);
+  EXPECT_EQ(task->GetOutput(), 7);
+}
+
+TEST(TaskTest, RunImplCanStopCooperativelyWhenBudgetExpires) {
+  env::detail::set_scoped_environment_variable scoped("PPC_TASK_MAX_TIME", "0.1");
+  struct PollingTask : Task<int, int> {
+   protected:
+    bool ValidationImpl() override {
+      return true;
+    }
+    bool PreProcessingImpl() override {
+      return true;
+    }
+    bool RunImpl() override {
+      const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+      while (!IsStopRequested() && std::chrono::steady_clock::now() < give_up) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      return !IsStopRequested();
+    }
+    bool PostProcessingImpl() override {
+      return true;
+    }
+  } task;
+
+  task.Validation();
+  task.PreProcessing();
+  EXPECT_FALSE(task.Run());
+  EXPECT_LT(task.GetStageTimings().run, 2.0);
+  EXPECT_THROW(task.PostProcessing(), std::runtime_error);
+}
+
+namespace {
+
+class DoublingTask : public Task<int, int> {
+ public:
+  int batch_calls = 0;
+
+ protected:
+  bool ValidationImpl() override {
+    return GetInput() >= 0 && GetOutput() == 0;
+  }
+  bool PreProcessingImpl() override {
+    return true;
+  }
+  bool RunImpl() override {
+    GetOutput() += 2 * GetInput();
+    return true;
+  }
+  bool PostProcessingImpl() override {
+    return true;
+  }
+};
+
+class AcrossItemsTask : public DoublingTask {
+ protected:
+  bool RunBatchImpl(ppc::task::BatchInputs<int> inputs, std::span<int> outputs) override {
+    ++batch_calls;
+    for (std::size_t item = 0; item < inputs.Size(); ++item) {
+      outputs[item] = 3 * inputs[item];
+    }
+    return true;
+  }
+};
+
+class ThrowingBatchTask : public DoublingTask {
+ protected:
+  bool RunBatchImpl(ppc::task::BatchInputs<int> /*inputs*/, std::span<int> /*outputs*/) override {
+    throw std::runtime_error("batch failed");
+  }
+};
+
+}  // namespace
+
+TEST(TaskTest, RunBatchRunsEveryInputThroughOneInstance) {
+  DoublingTask task;
+  const std::vector<int> inputs{1, 2, 3};
+  std::vector<int> outputs{42};
+
+  ASSERT_TRUE(task.RunBatch(inputs, outputs));
+  EXPECT_EQ(outputs, (std::vector<int>{2, 4, 6}));
+  EXPECT_GE(task.GetStageTimings().run, 0.0);
+  // The task is complete afterwards, so it may run another batch or a regular pipeline.
+  ASSERT_TRUE(task.RunBatch(std::vector<int>{5}, outputs));
+  EXPECT_EQ(outputs, std::vector<int>{10});
+}
+
+TEST(TaskTest, RunBatchStopsAtFirstFailingItem) {
+  DoublingTask task;
+  std::vector<int> outputs;
+  EXPECT_FALSE(task.RunBatch(std::vector<int>{1, -1, 3}, outputs));
+  EXPECT_EQ(outputs.size(), 3U);
+  EXPECT_EQ(outputs[0], 2);
+}
+
+TEST(TaskTest, RunBatchUsesOverriddenBatchHook) {
+  AcrossItemsTask task;
+  std::vector<int> outputs;
+  ASSERT_TRUE(task.RunBatch(std::vector<int>{1, 2}, outputs));
+  EXPECT_EQ(task.batch_calls, 1);
+  EXPECT_EQ(outputs, (std::vector<int>{3, 6}));
+}
+
+TEST(TaskTest, RunBatchRepeatsOneInput) {
+  DoublingTask task;
+  std::vector<int> outputs;
+  ASSERT_TRUE(task.RunBatch(4, 3, outputs));
+  EXPECT_EQ(outputs, (std::vector<int>{8, 8, 8}));
+}
+
+TEST(TaskTest, RunBatchReadsSharedInputsInPlace) {
+  SharedInputTask task(std::make_shared<const std::vector<int>>(std::vector<int>{1}));
+  const std::vector<std::vector<int>> inputs{{1, 2}, {3, 4, 5}};
+  std::vector<int> outputs;
+  ASSERT_TRUE(task.RunBatch(inputs, outputs));
+  EXPECT_EQ(outputs, (std::vector<int>{3, 12}));
+  // The task reads its own shared input again after the batch.
+  EXPECT_EQ(task.GetInputView(), std::vector<int>{1});
+}
+
+TEST(TaskTest, RunBatchLeavesTaskInExceptionStateWhenItThrows) {
+  {
+    ThrowingBatchTask task;
+    std::vector<int> outputs;
+    EXPECT_THROW(task.RunBatch(std::vector<int>{1}, outputs), std::runtime_error);
+    EXPECT_THROW(task.RunBatch(std::vector<int>{1}, outputs), std::runtime_error);
+  }
+  EXPECT_FALSE(ppc::util::DestructorFailureFlag::Get());
+}
+
+TEST(TaskTest, RunBatchThrowsInsideRegularPipeline) {
+  DoublingTask task;
+  task.Validation();
+  std::vector<int> outputs;
+  EXPECT_THROW(task.RunBatch(std::vector<int>{1}, outputs), std::runtime_error);
+}
+
 int main(int argc, char **argv) {
   return ppc::runners::SimpleInit(argc, argv);
 }
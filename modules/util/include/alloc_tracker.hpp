@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace ppc::util {
+
+/// @brief True when the project is built with PPC_ENABLE_ALLOC_TRACKING, i.e. when the global operator new and
+/// operator delete are replaced by counting versions.
+#ifdef PPC_ENABLE_ALLOC_TRACKING
+inline constexpr bool kAllocTrackingEnabled = true;
+#else
+inline constexpr bool kAllocTrackingEnabled = false;
+#endif
+
+/// @brief Heap allocations made by one thread during a measurement.
+struct ThreadAllocationStats {
+  /// Index of the thread's counter slot, stable for the lifetime of the thread
+  int thread = 0;
+  uint64_t allocations = 0;
+  uint64_t bytes = 0;
+  /// Largest growth of the bytes the thread allocated and has not freed itself, over the level at the start
+  uint64_t peak_live_bytes = 0;
+};
+
+/// @brief Heap allocations made by all threads during a measurement, such as one task stage.
+struct AllocationStats {
+  /// Calls of operator new
+  uint64_t allocations = 0;
+  /// Bytes handed out, counted as the usable size the allocator reports
+  uint64_t bytes = 0;
+  /// Largest growth of the process's live heap bytes over the level at the start, whichever task allocated them
+  uint64_t peak_live_bytes = 0;
+  /// Threads that allocated, in slot order
+  std::vector<ThreadAllocationStats> threads;
+};
+
+/// @brief Counts the heap allocations made between its construction and Stop().
+/// @details Every thread counts into its own slot, so the per-thread numbers cover OpenMP, TBB and STL workers.
+/// The numbers are process-wide, not per task: when tasks run concurrently, e.g. in a PipelinedRunner or a
+/// TaskGraph, each measurement also counts the allocations of the others. Overlapping measurements do not
+/// disturb each other, as each one tracks its own high-water mark; beyond kMaxPeakTrackers overlapping ones,
+/// the peak is reported as the growth of the live bytes at Stop(). Starting and stopping only visit the thread
+/// slots in use and do not allocate. Without PPC_ENABLE_ALLOC_TRACKING nothing is counted and all results are
+/// zero.
+class AllocationMeasurement {
+ public:
+  /// @brief Threads beyond this many live ones share the last slot.
+  static constexpr std::size_t kMaxThreadSlots = 256;
+  /// @brief Number of measurements that can track a peak at the same time.
+  static constexpr int kMaxPeakTrackers = 32;
+
+  AllocationMeasurement();
+  AllocationMeasurement(const AllocationMeasurement &) = delete;
+  AllocationMeasurement(AllocationMeasurement &&) = delete;
+  AllocationMeasurement &operator=(const AllocationMeasurement &) = delete;
+  AllocationMeasurement &operator=(AllocationMeasurement &&) = delete;
+  /// @brief Frees the peak tracker for the next measurement.
+  ~AllocationMeasurement();
+
+  /// @brief Returns the allocations made since construction.
+  [[nodiscard]] AllocationStats Stop() const;
+
+ private:
+  struct SlotStart {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    int64_t live = 0;
+  };
+
+  /// Slots that were never in use at the start begin from zero
+  std::array<SlotStart, kMaxThreadSlots> slots_{};
+  int64_t live_ = 0;
+  /// Index of the claimed peak tracker, or -1 when all were taken
+  int tracker_ = -1;
+};
+
+/// @brief Returns the largest number of heap allocations one Run() call may make, from PPC_RUN_ALLOC_BUDGET
+/// (default: empty, no limit).
+std::optional<uint64_t> GetRunAllocationBudget();
+
+/// @brief Checks the allocations of one Run() call against GetRunAllocationBudget().
+/// @param runs Run() calls covered by run, e.g. the batch size.
+/// @throws std::runtime_error If the budget is set and exceeded.
+void CheckRunAllocationBudget(const AllocationStats &run, uint64_t runs = 1);
+
+}  // namespace ppc::util
@@ -13,7 +13,10 @@
 #include <utility>
 
 #include "task/include/task.hpp"
+#include "util/include/alloc_tracker.hpp"
+#include "util/include/mpi_profile.hpp"
 #include "util/include/task_descriptor_util.hpp"
+#include "util/include/trace.hpp"
 #include "util/include/util.hpp"
 
 namespace ppc::util {
@@ -33,6 +36,48 @@ concept HasPrintTestParam = requires(TestType value) {
 template <typename TestTasksList, typename RunTestCase>
 void RunTestCasesWithTag(const TestTasksList &test_tasks_list, std::string_view task_tag, RunTestCase run_test_case);
 
+/// @brief Adds the heap allocations of every stage to the test's properties in the gtest XML/JSON output:
+/// <stage>_allocations, <stage>_allocated_bytes, <stage>_peak_live_bytes, and per allocating thread of Run()
+/// run_thread<N>_allocations and run_thread<N>_allocated_bytes.
+inline void RecordStageAllocations(const ppc::task::PipelineMetrics &metrics) {
+  const auto record = [](const std::string &stage, const AllocationStats &stats) -> void {
+    ::testing::Test::RecordProperty(stage + "_allocations", std::to_string(stats.allocations));
+    ::testing::Test::RecordProperty(stage + "_allocated_bytes", std::to_string(stats.bytes));
+    ::testing::Test::RecordProperty(stage + "_peak_live_bytes", std::to_string(stats.peak_live_bytes));
+  };
+  record("validation", metrics.validation.allocations);
+  record("preprocessing", metrics.preprocessing.allocations);
+  record("run", metrics.run.allocations);
+  record("postprocessing", metrics.postprocessing.allocations);
+  for (const auto &thread : metrics.run.allocations.threads) {
+    const std::string prefix = "run_thread" + std::to_string(thread.thread);
+    ::testing::Test::RecordProperty(prefix + "_allocations", std::to_string(thread.allocations));
+    ::testing::Test::RecordProperty(prefix + "_allocated_bytes", std::to_string(thread.bytes));
+  }
+}
+
+/// @brief Adds the MPI calls this rank made in every stage to the test's properties in the gtest XML/JSON output:
+/// <stage>_<kind>_calls, <stage>_<kind>_bytes and <stage>_<kind>_time for each kind (p2p, collective, wait) that
+/// was called.
+inline void RecordStageMpiProfile(const ppc::task::PipelineMetrics &metrics) {
+  const auto record = [](const std::string &stage, const MpiProfile &stage_profile) -> void {
+    for (std::size_t kind = 0; kind < kNumMpiCallKinds; ++kind) {
+      const auto &stats = stage_profile.kinds.at(kind);
+      if (stats.calls == 0) {
+        continue;
+      }
+      const std::string prefix = stage + "_" + std::string(kMpiCallKindNames.at(kind));
+      ::testing::Test::RecordProperty(prefix + "_calls", std::to_string(stats.calls));
+      ::testing::Test::RecordProperty(prefix + "_bytes", std::to_string(stats.bytes));
+      ::testing::Test::RecordProperty(prefix + "_time", std::to_string(stats.time));
+    }
+  };
+  record("validation", metrics.validation.mpi_profile);
+  record("preprocessing", metrics.preprocessing.mpi_profile);
+  record("run", metrics.run.mpi_profile);
+  record("postprocessing", metrics.postprocessing.mpi_profile);
+}
+
 template <typename InType, typename OutType, typename TestType = void>
 /// @brief Base class for running functional tests on parallel tasks.
 /// @tparam InType Type of input data.
@@ -85,9 +130,19 @@ class BaseRunFuncTests : public ::testing::TestWithParam<FuncTestParam<InType, O
       GTEST_SKIP();
     }
 
+    ClearTraceEvents();
+    trace_pending_ = true;
     InitializeAndRunTask(test_param);
   }
 
+  /// @brief Writes the trace of the test. Writing it is collective, so it runs here, where every rank arrives even
+  /// when the task threw on some of them.
+  void TearDown() override {
+    if (std::exchange(trace_pending_, false)) {
+      WriteTestTrace("trace.json");
+    }
+  }
+
   void ValidateTaskDescriptor(const ppc::task::TaskDescriptor &descriptor) {
     EXPECT_NE(descriptor.type, ppc::task::TypeOfTask::kUnknown);
   }
@@ -126,6 +181,13 @@ class BaseRunFuncTests : public ::testing::TestWithParam<FuncTestParam<InType, O
   void RunTask() {
     EXPECT_TRUE(task_->Run());
     EXPECT_TRUE(task_->PostProcessing());
+    if constexpr (kAllocTrackingEnabled) {
+      RecordStageAllocations(task_->GetStageMetrics());
+      CheckRunAllocationBudget(task_->GetStageMetrics().run.allocations);
+    }
+    if constexpr (kMpiProfilingEnabled) {
+      RecordStageMpiProfile(task_->GetStageMetrics());
+    }
   }
 
   void CheckTaskOutput() {
@@ -134,6 +196,7 @@ class BaseRunFuncTests : public ::testing::TestWithParam<FuncTestParam<InType, O
 
  private:
   ppc::task::TaskPtr<InType, OutType> task_;
+  bool trace_pending_ = false;
 };
 
 namespace detail {
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ppc::util {
+
+/// @brief True when the project is built with PPC_ENABLE_MPI_PROFILING, i.e. when the MPI calls of the task
+/// binaries go through the counting PMPI wrappers.
+#ifdef PPC_ENABLE_MPI_PROFILING
+inline constexpr bool kMpiProfilingEnabled = true;
+#else
+inline constexpr bool kMpiProfilingEnabled = false;
+#endif
+
+/// @brief Groups of profiled MPI calls.
+enum class MpiCallKind : uint8_t {
+  /// Sends and receives, blocking or not (MPI_Send, MPI_Irecv, MPI_Sendrecv, ...)
+  kPointToPoint,
+  /// Collectives, blocking or not, including MPI_Barrier
+  kCollective,
+  /// Completion and probing of requests and messages (MPI_Wait*, MPI_Test*, MPI_Probe, MPI_Iprobe)
+  kWait,
+};
+
+inline constexpr std::size_t kNumMpiCallKinds = 3;
+
+/// @brief Names used in benchmark output, indexed by MpiCallKind.
+inline constexpr std::array<std::string_view, kNumMpiCallKinds> kMpiCallKindNames = {"p2p", "collective", "wait"};
+
+/// @brief Calls of one kind made by this process.
+struct MpiCallStats {
+  uint64_t calls = 0;
+  /// Bytes in the send and receive buffers the calls were given on this rank (arguments that only matter on the
+  /// root are counted on the root only); receives count the received size when it is known on return
+  uint64_t bytes = 0;
+  /// Wall time spent inside the calls, in seconds
+  double time = 0.0;
+};
+
+/// @brief MPI calls of every kind made by this process.
+struct MpiProfile {
+  std::array<MpiCallStats, kNumMpiCallKinds> kinds{};
+
+  [[nodiscard]] const MpiCallStats &Get(MpiCallKind kind) const {
+    return kinds.at(static_cast<std::size_t>(kind));
+  }
+
+  /// @brief Returns the time spent in point-to-point and collective calls.
+  [[nodiscard]] double CommunicationTime() const {
+    return Get(MpiCallKind::kPointToPoint).time + Get(MpiCallKind::kCollective).time;
+  }
+
+  /// @brief Returns the time spent waiting for requests and messages.
+  [[nodiscard]] double WaitTime() const {
+    return Get(MpiCallKind::kWait).time;
+  }
+
+  MpiProfile &operator+=(const MpiProfile &other) {
+    for (std::size_t i = 0; i < kNumMpiCallKinds; ++i) {
+      kinds.at(i).calls += other.kinds.at(i).calls;
+      kinds.at(i).bytes += other.kinds.at(i).bytes;
+      kinds.at(i).time += other.kinds.at(i).time;
+    }
+    return *this;
+  }
+};
+
+/// @brief Adds one call to the process-wide totals; called by the PMPI wrappers.
+void RecordMpiCall(MpiCallKind kind, uint64_t bytes, double seconds);
+
+/// @brief Returns the process-wide totals since the start of the program.
+MpiProfile ReadMpiProfile();
+
+/// @brief Collects the MPI calls made between its construction and Stop().
+/// @details The totals are process-wide, so calls made by other threads in the meantime are included; with several
+/// threads calling MPI at once the summed times can exceed the wall time. Without PPC_ENABLE_MPI_PROFILING nothing
+/// is recorded and all results are zero.
+class MpiProfileMeasurement {
+ public:
+  MpiProfileMeasurement() : start_(ReadMpiProfile()) {}
+
+  /// @brief Returns the calls made since construction.
+  [[nodiscard]] MpiProfile Stop() const;
+
+ private:
+  MpiProfile start_;
+};
+
+/// @brief Ranks of MPI_COMM_WORLD beyond this many are left out of the communication matrix.
+inline constexpr int kMaxMpiPeers = 1024;
+
+/// @brief Size classes of the message-size histograms: class 0 holds calls without data, class b > 0 calls of
+/// [2^(b-1), 2^b) bytes, and the last class everything larger.
+inline constexpr std::size_t kNumMessageSizeClasses = 32;
+
+using MessageSizeHistogram = std::array<uint64_t, kNumMessageSizeClasses>;
+
+/// @brief Returns the size class of a call that moved the given number of bytes.
+std::size_t MessageSizeClass(uint64_t bytes);
+
+/// @brief Returns the smallest size of a size class, e.g. "0", "512", "4K", "1M".
+std::string MessageSizeClassLabel(std::size_t size_class);
+
+/// @brief Point-to-point and collective traffic this process sent, by destination rank.
+struct MpiTraffic {
+  /// Messages and bytes sent to each rank of MPI_COMM_WORLD, indexed by that rank
+  std::vector<uint64_t> messages;
+  std::vector<uint64_t> bytes;
+  /// Calls per size class (see MessageSizeClass()) of each MpiCallKind, counted with MpiCallStats::bytes
+  std::array<MessageSizeHistogram, kNumMpiCallKinds> message_sizes{};
+};
+
+/// @brief Adds one message to the destination's totals; called by the PMPI wrappers while traffic is recorded (see
+/// MpiTrafficMeasurement).
+/// @param world_rank Destination rank in MPI_COMM_WORLD.
+void RecordMpiMessage(int world_rank, uint64_t bytes);
+
+/// @brief Returns the process-wide traffic since the start of the program, with one entry per rank of
+/// MPI_COMM_WORLD (one when MPI is not running).
+MpiTraffic ReadMpiTraffic();
+
+/// @brief Collects the traffic sent between its construction and Stop().
+/// @details Traffic is only recorded while a measurement exists and the calling code is inside an MpiTrafficScope,
+/// so the barriers and gathers of the test harness stay out of the picture. Collectives are attributed by their
+/// logical data flow: rooted ones to or from the root, the all-to-all, all-gather and all-reduce families from every
+/// rank to every other one, scans to the higher ranks. Without PPC_ENABLE_MPI_PROFILING nothing is recorded and all
+/// results are zero.
+class MpiTrafficMeasurement {
+ public:
+  MpiTrafficMeasurement();
+  MpiTrafficMeasurement(const MpiTrafficMeasurement &) = delete;
+  MpiTrafficMeasurement(MpiTrafficMeasurement &&) = delete;
+  MpiTrafficMeasurement &operator=(const MpiTrafficMeasurement &) = delete;
+  MpiTrafficMeasurement &operator=(MpiTrafficMeasurement &&) = delete;
+  ~MpiTrafficMeasurement();
+
+  /// @brief Returns the traffic sent since construction.
+  [[nodiscard]] MpiTraffic Stop() const;
+
+ private:
+  MpiTraffic start_;
+};
+
+/// @brief Marks code whose MPI traffic is recorded by running MpiTrafficMeasurements, such as a task stage.
+class MpiTrafficScope {
+ public:
+  MpiTrafficScope();
+  MpiTrafficScope(const MpiTrafficScope &) = delete;
+  MpiTrafficScope(MpiTrafficScope &&) = delete;
+  MpiTrafficScope &operator=(const MpiTrafficScope &) = delete;
+  MpiTrafficScope &operator=(MpiTrafficScope &&) = delete;
+  ~MpiTrafficScope();
+};
+
+/// @brief Traffic of all ranks: the rank-to-rank matrix and the summed message-size histograms.
+struct MpiCommReport {
+  int ranks = 1;
+  /// Row-major ranks x ranks matrices; row: sending rank, column: receiving rank
+  std::vector<uint64_t> messages;
+  std::vector<uint64_t> bytes;
+  std::array<MessageSizeHistogram, kNumMpiCallKinds> message_sizes{};
+
+  [[nodiscard]] uint64_t BytesBetween(int sender, int receiver) const {
+    return bytes.at((static_cast<std::size_t>(sender) * static_cast<std::size_t>(ranks)) +
+                    static_cast<std::size_t>(receiver));
+  }
+};
+
+/// @brief Collects the traffic of every rank on rank 0.
+/// @details Must be called on every rank when MPI is active; ranks other than 0 get an empty report.
+MpiCommReport GatherMpiCommReport(const MpiTraffic &traffic);
+
+/// @brief Formats a report as a JSON object with "ranks", the "messages" and "bytes" matrices (arrays of rows) and
+/// "message_sizes", the non-empty size classes of each call kind.
+std::string FormatMpiCommReportJson(const MpiCommReport &report);
+
+/// @brief Formats a report as a text heatmap of the bytes sent between ranks, followed by the sent and received
+/// totals of every rank, the busiest rank and the message-size histograms.
+std::string FormatMpiCommHeatmap(const MpiCommReport &report, const std::string &title);
+
+}  // namespace ppc::util
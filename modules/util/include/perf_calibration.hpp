@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+
+namespace ppc::util {
+
+/// @brief Finds the problem size at which one measured run takes about a target time.
+/// @details Doubles the size from start_size until a run takes at least target_time, or halves it while runs take
+/// longer, then bisects between the last sizes below and above the target until they are within 5% of each other.
+/// @param start_size First size tried (values below one are treated as one).
+/// @param target_time Target run time in seconds.
+/// @param measure Runs the task at a size and returns its time in seconds; every size is measured at most once.
+/// @return The measured size whose time came closest to the target.
+int64_t CalibrateSize(int64_t start_size, double target_time, const std::function<double(int64_t)> &measure);
+
+/// @brief Reads a size stored by StoreCalibratedSize() for the same key and target time.
+/// @return The size, or std::nullopt if the file, the key or an entry for this target time is missing.
+std::optional<int64_t> LoadCalibratedSize(const std::string &cache_path, const std::string &key, double target_time);
+
+/// @brief Stores a calibrated size in a JSON cache file, keeping the entries of other keys.
+/// @throws std::runtime_error If the file cannot be written.
+void StoreCalibratedSize(const std::string &cache_path, const std::string &key, double target_time, int64_t size);
+
+}  // namespace ppc::util
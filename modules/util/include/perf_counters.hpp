@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace ppc::util {
+
+/// @brief Events counted by PerfCounters.
+enum class PerfCounterKind : uint8_t {
+  kCycles,
+  kInstructions,
+  kLlcReferences,
+  kLlcMisses,
+  kBranchMisses,
+  kContextSwitches,
+  kCpuMigrations,
+  kPageFaults,
+};
+
+inline constexpr std::size_t kNumPerfCounterKinds = 8;
+
+/// @brief Counter names used in benchmark output, indexed by PerfCounterKind.
+inline constexpr std::array<std::string_view, kNumPerfCounterKinds> kPerfCounterNames = {
+    "cycles",        "instructions",     "llc_references", "llc_misses",
+    "branch_misses", "context_switches", "cpu_migrations", "page_faults"};
+
+/// @brief Readings of the counted events; kinds that could not be counted are marked unavailable.
+struct PerfCounterValues {
+  std::array<double, kNumPerfCounterKinds> values{};
+  std::array<bool, kNumPerfCounterKinds> available{};
+
+  [[nodiscard]] bool Has(PerfCounterKind kind) const {
+    return available.at(static_cast<std::size_t>(kind));
+  }
+
+  [[nodiscard]] double Get(PerfCounterKind kind) const {
+    return values.at(static_cast<std::size_t>(kind));
+  }
+
+  /// @brief Returns the events counted between two readings.
+  static PerfCounterValues Delta(const PerfCounterValues &before, const PerfCounterValues &after) {
+    PerfCounterValues delta;
+    for (std::size_t i = 0; i < kNumPerfCounterKinds; ++i) {
+      delta.available.at(i) = before.available.at(i) && after.available.at(i);
+      delta.values.at(i) = delta.available.at(i) ? after.values.at(i) - before.values.at(i) : 0.0;
+    }
+    return delta;
+  }
+
+  /// @brief Adds the counts of another reading; a kind stays available if either side counted it.
+  PerfCounterValues &operator+=(const PerfCounterValues &other) {
+    for (std::size_t i = 0; i < kNumPerfCounterKinds; ++i) {
+      values.at(i) += other.values.at(i);
+      available.at(i) = available.at(i) || other.available.at(i);
+    }
+    return *this;
+  }
+};
+
+/// @brief Counts hardware and OS events of the whole process.
+/// @details On Linux every event is opened with perf_event_open for each thread that exists when the counters
+/// are created and inherited by the threads they start later, so OpenMP, TBB and STL workers are included. Hardware
+/// events (cycles, instructions, LLC references and misses, branch misses) count user mode only and are often
+/// unavailable in containers and VMs; software events (context switches, CPU migrations, page faults) are used on
+/// their own then. When perf_event_open is not permitted at all, context switches and page faults come from
+/// getrusage() and the other kinds are unavailable. Counts are scaled when the kernel multiplexes the events.
+class PerfCounters {
+ public:
+  /// @param use_perf_events False skips perf_event_open and reads getrusage() only.
+  explicit PerfCounters(bool use_perf_events = true);
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters(PerfCounters &&) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+  PerfCounters &operator=(PerfCounters &&) = delete;
+  ~PerfCounters();
+
+  /// @brief Returns the events counted since the counters were created.
+  [[nodiscard]] PerfCounterValues Read() const;
+
+  /// @brief Checks whether cycles and instructions are counted.
+  [[nodiscard]] bool HasHardwareEvents() const;
+
+  /// @brief Returns the counters read around every Task stage, or nullptr when none are active.
+  static const PerfCounters *Active();
+
+ private:
+  /// File descriptors of every kind, one per counted thread
+  std::array<std::vector<int>, kNumPerfCounterKinds> descriptors_;
+  /// Kinds read from getrusage(), relative to the usage at creation
+  std::array<bool, kNumPerfCounterKinds> from_rusage_{};
+  PerfCounterValues rusage_base_;
+};
+
+/// @brief Makes counters the active set (see PerfCounters::Active()) for its lifetime.
+class ActivePerfCountersScope {
+ public:
+  explicit ActivePerfCountersScope(const PerfCounters &counters);
+  ActivePerfCountersScope(const ActivePerfCountersScope &) = delete;
+  ActivePerfCountersScope(ActivePerfCountersScope &&) = delete;
+  ActivePerfCountersScope &operator=(const ActivePerfCountersScope &) = delete;
+  ActivePerfCountersScope &operator=(ActivePerfCountersScope &&) = delete;
+  ~ActivePerfCountersScope();
+
+ private:
+  const PerfCounters *previous_;
+};
+
+}  // namespace ppc::util
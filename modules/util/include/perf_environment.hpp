@@ -0,0 +1,21 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+namespace ppc::util {
+
+/// @brief Describes the machine state that affects benchmark results.
+/// @details Reports cpu_model, cpu_governor, cpu_cur_freq_mhz, load_average (1, 5 and 15 minutes) and smt
+/// ("on"/"off"). Values come from /proc and /sys on Linux and are "unknown" where they cannot be read.
+std::map<std::string, std::string> CaptureMachineEnvironment();
+
+/// @brief Times a fixed compute and memory kernel, the reference for detecting machine noise.
+/// @details Runs the kernel several times and returns the median in seconds. Under MPI it runs on every rank at
+/// once and returns the slowest rank's median, so it must be called on every rank.
+double MeasureNoiseKernel();
+
+/// @brief Returns the relative difference |after - before| / min(before, after) of two kernel times.
+double NoiseKernelDrift(double before, double after);
+
+}  // namespace ppc::util
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ppc::util {
+
+/// @brief Returns the registered name of a reported Google Benchmark run.
+/// @details Drops the segments Google Benchmark appends to the registered name, such as "/iterations:5",
+/// "/repeats:3" and "/manual_time"; size arguments and harness segments ("/mode:", "/threads:") are kept.
+std::string BenchmarkRunKey(const std::string &reported_name);
+
+/// @brief Adds the measured samples of every benchmark to a Google Benchmark JSON output file.
+/// @details Each iteration entry whose BenchmarkRunKey() has recorded samples gets a "samples" array with the
+/// time of every measured sample in seconds, so tools such as scripts/perf_baseline.py can compare distributions
+/// instead of means. Aggregate entries and benchmarks without samples are left unchanged.
+/// @param samples Samples keyed by registered benchmark name.
+/// @throws std::runtime_error If the output file cannot be read as JSON or written back.
+void AttachSamplesToBenchmarkOutput(const std::string &output_path,
+                                    const std::map<std::string, std::vector<double>> &samples);
+
+/// @brief Adds entries to the "context" object of a Google Benchmark JSON output file, replacing existing keys.
+/// @details Used for values only known after the benchmarks ran, such as the noise check.
+/// @throws std::runtime_error If the output file cannot be read as JSON or written back.
+void AddContextToBenchmarkOutput(const std::string &output_path, const std::map<std::string, std::string> &context);
+
+/// @brief Returns the output file of a rank other than 0: "out.json" becomes "out.rank<rank>.json".
+std::string MakeRankOutputPath(const std::string &output_path, int rank);
+
+/// @brief Returns the file holding the results of all ranks: "out.json" becomes "out.ranks.json".
+std::string MakeMergedOutputPath(const std::string &output_path);
+
+/// @brief Writes the Google Benchmark JSON outputs of all ranks into one file.
+/// @details The file holds the context of rank 0 and a "ranks" array with the "rank", "host_name" and "benchmarks"
+/// of every rank, in rank order.
+/// @param rank_outputs JSON text of each rank's output, indexed by rank.
+/// @throws std::runtime_error If an output is not Google Benchmark JSON or the file cannot be written.
+void WriteMergedBenchmarkOutput(const std::string &merged_path, const std::vector<std::string> &rank_outputs);
+
+}  // namespace ppc::util
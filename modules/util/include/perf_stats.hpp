@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace ppc::util {
+
+/// @brief Robust summary of repeated timing samples, in the unit of the samples.
+/// @details Median and quartiles describe all samples. Samples outside the Tukey fences (1.5 IQR beyond the
+/// quartiles) are rejected as outliers before the mean, standard deviation and confidence interval are computed.
+struct SampleStats {
+  std::size_t count = 0;
+  std::size_t outliers = 0;
+  double median = 0.0;
+  double q1 = 0.0;
+  double q3 = 0.0;
+  double iqr = 0.0;
+  double mean = 0.0;
+  double stddev = 0.0;
+  /// Coefficient of variation (stddev / mean) of the inliers
+  double cv = 0.0;
+  /// Bounds of the 95% confidence interval of the inlier mean
+  double ci_low = 0.0;
+  double ci_high = 0.0;
+};
+
+/// @brief Returns the q-quantile (0 <= q <= 1) of sorted data, interpolating linearly between ranks.
+double Quantile(std::span<const double> sorted, double q);
+
+/// @brief Returns the 0.975 quantile of Student's t distribution, used for two-sided 95% intervals.
+double StudentT975(std::size_t degrees_of_freedom);
+
+/// @brief Summarizes timing samples; an empty span gives an all-zero summary.
+SampleStats SummarizeSamples(std::span<const double> samples);
+
+/// @brief Checks whether a summary meets a precision target.
+/// @param stats Summary of the samples taken so far.
+/// @param target_cv Largest acceptable coefficient of variation; 0 disables this criterion.
+/// @param target_ci Largest acceptable 95% CI half-width relative to the mean; 0 disables this criterion.
+/// @return True if at least two inliers exist and any enabled criterion is met.
+bool IsPreciseEnough(const SampleStats &stats, double target_cv, double target_ci);
+
+}  // namespace ppc::util
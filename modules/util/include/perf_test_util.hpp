@@ -7,21 +7,41 @@
 #include <omp.h>
 #include <tbb/tick_count.h>
 
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <filesystem>
+#include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "oneapi/tbb/global_control.h"
+#include "runtime/include/runtime.hpp"
+#include "task/include/pipelined_runner.hpp"
 #include "task/include/task.hpp"
+#include "util/include/alloc_tracker.hpp"
+#include "util/include/mpi_profile.hpp"
+#include "util/include/perf_calibration.hpp"
+#include "util/include/perf_counters.hpp"
+#include "util/include/perf_stats.hpp"
+#include "util/include/roofline.hpp"
 #include "util/include/task_descriptor_util.hpp"
+#include "util/include/trace.hpp"
 #include "util/include/util.hpp"
 
 namespace ppc::util {
@@ -30,9 +50,302 @@ inline double DefaultTimer() {
   return -1.0;
 }
 
+/// @brief Benchmark variant registered for a performance test.
+enum class PerfMode : uint8_t {
+  /// A fresh task per iteration; only Run() is timed
+  kCold,
+  /// One task instance kept alive; repeated Run() calls are timed after an untimed warm-up run
+  kWarm,
+  /// A fresh task per iteration; Validation through PostProcessing is timed between two barriers
+  kPipeline,
+  /// A stream of tasks per iteration with overlapped stages; throughput is reported in items per second
+  kStream,
+  /// One task per iteration runs a batch of inputs through RunBatch(); throughput is reported in items per second
+  kBatch,
+  /// Unknown benchmark mode
+  kUnknown,
+};
+
+using PerfModeMapping = std::pair<PerfMode, std::string_view>;
+using PerfModeMappingArray = std::array<PerfModeMapping, 5>;
+
+inline constexpr PerfModeMappingArray kPerfModeMappings = {
+    {{PerfMode::kCold, "cold"},
+     {PerfMode::kWarm, "warm"},
+     {PerfMode::kPipeline, "pipeline"},
+     {PerfMode::kStream, "stream"},
+     {PerfMode::kBatch, "batch"}}};
+
+constexpr std::string_view PerfModeToString(PerfMode mode) {
+  for (const auto &[key, value] : kPerfModeMappings) {
+    if (key == mode) {
+      return value;
+    }
+  }
+  return "unknown";
+}
+
+constexpr PerfMode PerfModeFromString(std::string_view mode) {
+  for (const auto &[key, value] : kPerfModeMappings) {
+    if (value == mode) {
+      return key;
+    }
+  }
+  return PerfMode::kUnknown;
+}
+
+/// @brief Parses a comma-separated list of benchmark modes (e.g. "cold,warm").
+/// @throws std::runtime_error If the list contains an unknown mode.
+inline std::vector<PerfMode> ParsePerfModes(std::string_view modes_list) {
+  std::vector<PerfMode> modes;
+  for (size_t start = 0; start <= modes_list.size();) {
+    const size_t separator = modes_list.find(',', start);
+    const size_t token_size = separator == std::string_view::npos ? modes_list.size() - start : separator - start;
+    const auto token = modes_list.substr(start, token_size);
+    if (!token.empty()) {
+      const PerfMode mode = PerfModeFromString(token);
+      if (mode == PerfMode::kUnknown) {
+        throw std::runtime_error("Unknown performance mode: " + std::string(token));
+      }
+      if (std::ranges::find(modes, mode) == modes.end()) {
+        modes.push_back(mode);
+      }
+    }
+    if (separator == std::string_view::npos) {
+      break;
+    }
+    start = separator + 1;
+  }
+  return modes;
+}
+
+/// @brief Returns the benchmark modes requested through PPC_PERF_MODES (default: cold only).
+inline std::vector<PerfMode> GetPerfModes() {
+  const auto modes_env = env::get<std::string>("PPC_PERF_MODES");
+  if (!modes_env.has_value()) {
+    return {PerfMode::kCold};
+  }
+  auto modes = ParsePerfModes(modes_env.value());
+  if (modes.empty()) {
+    return {PerfMode::kCold};
+  }
+  return modes;
+}
+
+/// @brief Returns the number of discarded warm-up runs per benchmark from PPC_PERF_WARMUP_RUNS (default: 0).
+inline uint64_t GetPerfWarmupRuns() {
+  const auto runs = env::get<int>("PPC_PERF_WARMUP_RUNS");
+  return runs.has_value() && runs.value() > 0 ? static_cast<uint64_t>(runs.value()) : 0;
+}
+
+/// @brief Returns the coefficient of variation that ends adaptive sampling, from PPC_PERF_TARGET_CV (default: 0, off).
+inline double GetPerfTargetCv() {
+  const auto target = env::get<double>("PPC_PERF_TARGET_CV");
+  return target.has_value() ? std::max(target.value(), 0.0) : 0.0;
+}
+
+/// @brief Returns the relative 95% CI half-width ending adaptive sampling, from PPC_PERF_TARGET_CI (default: 0, off).
+inline double GetPerfTargetCi() {
+  const auto target = env::get<double>("PPC_PERF_TARGET_CI");
+  return target.has_value() ? std::max(target.value(), 0.0) : 0.0;
+}
+
+/// @brief Checks whether every rank's time is exported per benchmark, from PPC_PERF_RANK_TIMES (default: 0, off).
+inline bool GetPerfRankTimes() {
+  const auto enabled = env::get<int>("PPC_PERF_RANK_TIMES");
+  return enabled.has_value() && enabled.value() != 0;
+}
+
+/// @brief Checks whether hardware and OS event counters are read around every task stage, from PPC_PERF_COUNTERS
+/// (default: 0, off).
+inline bool GetPerfCounters() {
+  const auto enabled = env::get<int>("PPC_PERF_COUNTERS");
+  return enabled.has_value() && enabled.value() != 0;
+}
+
+/// @brief Checks whether the rank-to-rank MPI traffic of every benchmark is reported, from PPC_MPI_COMM_REPORT
+/// (default: 0, off).
+inline bool GetMpiCommReport() {
+  const auto enabled = env::get<int>("PPC_MPI_COMM_REPORT");
+  return enabled.has_value() && enabled.value() != 0;
+}
+
+/// @brief Parses a comma-separated list of thread counts (e.g. "1,2,4").
+/// @throws std::runtime_error If an entry is not a positive integer.
+inline std::vector<int> ParseThreadCounts(std::string_view counts_list) {
+  std::vector<int> counts;
+  for (size_t start = 0; start <= counts_list.size();) {
+    const size_t separator = counts_list.find(',', start);
+    const size_t token_size = separator == std::string_view::npos ? counts_list.size() - start : separator - start;
+    const auto token = counts_list.substr(start, token_size);
+    if (!token.empty()) {
+      int count = 0;
+      const auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), count);
+      if (error != std::errc{} || end != token.data() + token.size() || count < 1) {
+        throw std::runtime_error("Invalid thread count: " + std::string(token));
+      }
+      if (std::ranges::find(counts, count) == counts.end()) {
+        counts.push_back(count);
+      }
+    }
+    if (separator == std::string_view::npos) {
+      break;
+    }
+    start = separator + 1;
+  }
+  return counts;
+}
+
+/// @brief Returns the thread counts of the strong-scaling sweep from PPC_PERF_THREAD_COUNTS (default: empty, off).
+inline std::vector<int> GetPerfThreadCounts() {
+  const auto counts_env = env::get<std::string>("PPC_PERF_THREAD_COUNTS");
+  return counts_env.has_value() ? ParseThreadCounts(counts_env.value()) : std::vector<int>{};
+}
+
+/// @brief Checks whether sized benchmarks grow the problem with the worker count, from PPC_PERF_WEAK_SCALING
+/// (default: 0, off).
+inline bool GetPerfWeakScaling() {
+  const auto enabled = env::get<int>("PPC_PERF_WEAK_SCALING");
+  return enabled.has_value() && enabled.value() != 0;
+}
+
+/// @brief Returns the SEQ run time in seconds that calibrated inputs are sized for, from PPC_PERF_CALIBRATION_TIME
+/// (default: 0, off).
+inline double GetPerfCalibrationTime() {
+  const auto target = env::get<double>("PPC_PERF_CALIBRATION_TIME");
+  return target.has_value() ? std::max(target.value(), 0.0) : 0.0;
+}
+
+/// @brief Returns the JSON file that keeps calibrated sizes between runs, from PPC_PERF_CALIBRATION_CACHE
+/// (default: empty, no cache).
+inline std::string GetPerfCalibrationCache() {
+  return env::get<std::string>("PPC_PERF_CALIBRATION_CACHE").value_or(std::string{});
+}
+
+/// @brief Returns the JSON file with the machine's roofline ceilings, from PPC_PERF_ROOFLINE_CACHE (default: empty,
+/// no roofline reporting).
+inline std::string GetPerfRooflineCache() {
+  return env::get<std::string>("PPC_PERF_ROOFLINE_CACHE").value_or(std::string{});
+}
+
+/// @brief Which ranks write benchmark results; rank 0 always writes PPC_BENCHMARK_OUT.
+enum class RankOutput : uint8_t {
+  /// Ranks other than 0 write nothing.
+  kOff,
+  /// Every other rank writes its own file next to PPC_BENCHMARK_OUT, see MakeRankOutputPath().
+  kFiles,
+  /// Rank 0 also collects the results of all ranks into one file, see MakeMergedOutputPath().
+  kMerged,
+};
+
+/// @brief Returns the per-rank output mode from PPC_BENCHMARK_RANK_OUT: "files", "merged" or empty (default, off).
+/// @throws std::runtime_error If the value is none of these.
+inline RankOutput GetBenchmarkRankOutput() {
+  const auto mode = env::get<std::string>("PPC_BENCHMARK_RANK_OUT").value_or(std::string{});
+  if (mode.empty()) {
+    return RankOutput::kOff;
+  }
+  if (mode == "files") {
+    return RankOutput::kFiles;
+  }
+  if (mode == "merged") {
+    return RankOutput::kMerged;
+  }
+  throw std::runtime_error("Unknown rank output mode: " + mode);
+}
+
+/// @brief Builds the Google Benchmark name for a task and mode.
+/// @details Cold mode keeps the plain task name so existing reports stay comparable;
+/// other modes append a "/mode:<name>" segment.
+inline std::string MakePerfBenchmarkName(const std::string &display_name, PerfMode mode) {
+  if (mode == PerfMode::kCold) {
+    return display_name;
+  }
+  return display_name + "/mode:" + std::string(PerfModeToString(mode));
+}
+
+/// @brief Builds the name of one thread-count sweep point: the mode name followed by "/threads:<count>".
+inline std::string MakeThreadSweepBenchmarkName(const std::string &display_name, PerfMode mode, int num_threads) {
+  return MakePerfBenchmarkName(display_name, mode) + "/threads:" + std::to_string(num_threads);
+}
+
+/// @brief Checks whether a task type runs on threads and is therefore part of a thread-count sweep.
+inline bool IsThreadTaskType(ppc::task::TypeOfTask type) {
+  return type == ppc::task::TypeOfTask::kOMP || type == ppc::task::TypeOfTask::kTBB ||
+         type == ppc::task::TypeOfTask::kSTL || type == ppc::task::TypeOfTask::kALL;
+}
+
+/// @brief Returns the name shared by all implementations of a task, i.e. the display name without the
+/// "_<technology>_<status>" suffix.
+inline std::string MakeScalingKey(const ppc::task::TaskDescriptor &descriptor) {
+  const std::string suffix = "_" + std::string(ppc::task::TypeOfTaskToString(descriptor.type)) + "_" +
+                             std::string(ppc::task::StatusOfTaskToString(descriptor.status));
+  const std::string_view name = descriptor.display_name;
+  return std::string(name.ends_with(suffix) ? name.substr(0, name.size() - suffix.size()) : name);
+}
+
+/// @brief Work done by one Run() call on a given input, summed over all ranks and threads.
+/// @details Declared by a perf fixture through BaseRunPerfTests::GetWorkMetrics(); each non-zero field becomes a
+/// rate counter (see detail::ExportWorkCounters()).
+struct WorkMetrics {
+  /// @brief Bytes read from memory.
+  double bytes_read = 0.0;
+  /// @brief Bytes written to memory.
+  double bytes_written = 0.0;
+  /// @brief Floating-point operations.
+  double flops = 0.0;
+  /// @brief Elements processed, e.g. matrix entries or pixels.
+  double elements = 0.0;
+
+  /// @brief Returns true if any quantity was declared.
+  [[nodiscard]] bool HasWork() const {
+    return bytes_read > 0.0 || bytes_written > 0.0 || flops > 0.0 || elements > 0.0;
+  }
+};
+
 struct PerfAttr {
-  /// @brief Number of times the task is run for performance evaluation.
+  /// @brief Number of times the task is run for performance evaluation; the minimum in adaptive sampling.
   uint64_t num_running = 5;
+  /// @brief Untimed runs before the measured ones; their results are discarded.
+  uint64_t warmup_running = GetPerfWarmupRuns();
+  /// @brief Adaptive sampling keeps running until the coefficient of variation is at most this value (0: off).
+  double target_cv = GetPerfTargetCv();
+  /// @brief Adaptive sampling keeps running until the relative 95% CI half-width is at most this value (0: off).
+  double target_ci = GetPerfTargetCi();
+  /// @brief Upper bound on measured runs in adaptive sampling; the total measured time is also capped by
+  /// GetPerfMaxTime().
+  uint64_t max_running = 100;
+  /// @brief Export each rank's mean time as a rank_time_<rank> counter next to the min/mean/max summary.
+  bool per_rank_times = GetPerfRankTimes();
+  /// @brief Export the times measured by the reporting rank itself (rank, local_time_*, local_<stage>_time), so
+  /// every per-rank output file describes its own rank; on when PPC_BENCHMARK_RANK_OUT is set.
+  bool local_rank_counters = GetBenchmarkRankOutput() != RankOutput::kOff;
+  /// @brief Count cycles, instructions, cache and branch misses, context switches, migrations and page faults of
+  /// each stage with ppc::util::PerfCounters and export them with the derived IPC and LLC miss rates. The events
+  /// are counted for the reporting rank's process; stream mode does not report them.
+  bool perf_counters = GetPerfCounters();
+  /// @brief Record the messages and bytes the task stages send between ranks and the message-size histograms, and
+  /// report them after each benchmark (needs PPC_ENABLE_MPI_PROFILING).
+  bool mpi_comm_report = GetMpiCommReport();
+  /// @brief Thread counts at which OMP, TBB, STL and ALL tasks are also benchmarked, reporting speedup and
+  /// efficiency against the SEQ implementation of the same task (empty: no sweep).
+  std::vector<int> thread_counts = GetPerfThreadCounts();
+  /// @brief Multiply each size from GetTestSizes() by the number of ranks and threads the task uses (weak scaling).
+  bool weak_scaling = GetPerfWeakScaling();
+  /// @brief Size the benchmark input so the SEQ Run() takes about this many seconds (0: off); needs
+  /// GetCalibrationStartSize(). Capped at half of GetPerfMaxTime().
+  double calibration_time = GetPerfCalibrationTime();
+  /// @brief JSON file reusing calibrated sizes across runs (empty: calibrate in every run).
+  std::string calibration_cache = GetPerfCalibrationCache();
+  /// @brief JSON file with the roofline ceilings of this machine; when set, tasks that declare their work also
+  /// report the fraction of the relevant roof they reach. Missing ceilings are measured and added (empty: off).
+  std::string roofline_cache = GetPerfRooflineCache();
+  /// @brief Benchmark variants registered for the task, reported side by side.
+  std::vector<PerfMode> modes = GetPerfModes();
+  /// @brief Number of tasks pushed through the pipelined runner per iteration in stream mode.
+  uint64_t stream_length = 4;
+  /// @brief Number of times the input is passed to one RunBatch() call per iteration in batch mode.
+  uint64_t batch_size = 16;
   /// @brief Timer function returning current time in seconds.
   /// @cond
   std::function<double()> current_timer = DefaultTimer;
@@ -85,13 +398,53 @@ inline std::function<double()> MakeTechnologyTimer(ppc::task::TypeOfTask task_ty
   throw std::runtime_error("The task type is not supported for performance testing.");
 }
 
-inline double MaxElapsedTimeAcrossMpiRanks(double elapsed, ppc::task::TypeOfTask task_type) {
+/// @brief Elapsed time of one sample on every MPI rank.
+struct SampleTime {
+  /// Time of the slowest rank, used as the sample time
+  double elapsed = 0.0;
+  /// Time measured by each rank; a single entry for tasks that do not use MPI
+  std::vector<double> rank_times;
+};
+
+/// @brief Gathers the elapsed time of every rank for MPI-based tasks.
+inline SampleTime GatherSampleTime(double elapsed, ppc::task::TypeOfTask task_type) {
+  SampleTime sample{.elapsed = elapsed, .rank_times = {elapsed}};
   if (task_type != ppc::task::TypeOfTask::kMPI && task_type != ppc::task::TypeOfTask::kALL) {
-    return elapsed;
+    return sample;
   }
-  double max_elapsed = elapsed;
-  MPI_Allreduce(&elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
-  return max_elapsed;
+  int num_ranks = 1;
+  MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+  sample.rank_times.resize(static_cast<std::size_t>(num_ranks));
+  MPI_Allgather(&elapsed, 1, MPI_DOUBLE, sample.rank_times.data(), 1, MPI_DOUBLE, MPI_COMM_WORLD);
+  sample.elapsed = std::ranges::max(sample.rank_times);
+  return sample;
+}
+
+/// @brief Reduces per-stage times to their maximum across MPI ranks for MPI-based tasks.
+inline ppc::task::StageTimings MaxStageTimingsAcrossMpiRanks(const ppc::task::StageTimings &timings,
+                                                             ppc::task::TypeOfTask task_type) {
+  if (task_type != ppc::task::TypeOfTask::kMPI && task_type != ppc::task::TypeOfTask::kALL) {
+    return timings;
+  }
+  std::array<double, 4> local{timings.validation, timings.preprocessing, timings.run, timings.postprocessing};
+  std::array<double, 4> global{};
+  MPI_Allreduce(local.data(), global.data(), static_cast<int>(local.size()), MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+  return {.validation = global[0], .preprocessing = global[1], .run = global[2], .postprocessing = global[3]};
+}
+
+inline void AccumulateStageTimings(ppc::task::StageTimings &total, const ppc::task::StageTimings &timings) {
+  total.validation += timings.validation;
+  total.preprocessing += timings.preprocessing;
+  total.run += timings.run;
+  total.postprocessing += timings.postprocessing;
+}
+
+/// @brief Exports per-stage times (seconds per iteration) as Google Benchmark user counters.
+inline void SetStageTimeCounters(benchmark::State &state, const ppc::task::StageTimings &timings) {
+  state.counters["validation_time"] = timings.validation;
+  state.counters["preprocessing_time"] = timings.preprocessing;
+  state.counters["run_time"] = timings.run;
+  state.counters["postprocessing_time"] = timings.postprocessing;
 }
 
 inline void SkipBenchmarkWithError(benchmark::State &state, const char *message) noexcept {
@@ -110,34 +463,927 @@ inline void CheckPerfTimeLimit(double elapsed) {
   }
 }
 
+/// @brief Times one Run() call between a rank barrier and the end of the call.
+/// @details Tasks register with the watchdog when they are built and read their budget in Validation(), so the
+/// timed call only pays for storing the stage deadline.
+template <typename InType, typename OutType>
+double TimeTaskRun(const ppc::task::TaskPtr<InType, OutType> &task, const std::function<double()> &timer) {
+  SynchronizeMpiRanks();
+  ppc::runtime::ResetThreadBusyTimes();
+  const double begin = timer();
+  task->Run();
+  return timer() - begin;
+}
+
 template <typename InType, typename OutType>
-double RunTaskForBenchmark(const ppc::task::TaskPtr<InType, OutType> &task) {
+SampleTime RunTaskForBenchmark(const ppc::task::TaskPtr<InType, OutType> &task) {
   const auto task_type = task->GetDynamicTypeOfTask();
   const auto timer = MakeTechnologyTimer(task_type);
   task->GetStateOfTesting() = ppc::task::StateOfTesting::kPerf;
 
   task->Validation();
   task->PreProcessing();
+  const double elapsed = TimeTaskRun(task, timer);
+  task->PostProcessing();
+  auto sample = GatherSampleTime(elapsed, task_type);
+  CheckPerfTimeLimit(sample.elapsed);
+  return sample;
+}
+
+/// @brief Times the whole pipeline, Validation through PostProcessing, between two rank barriers.
+/// @details Charges data distribution done outside Run() (e.g. scatter in PreProcessing) to the measurement.
+template <typename InType, typename OutType>
+SampleTime RunPipelineForBenchmark(const ppc::task::TaskPtr<InType, OutType> &task) {
+  const auto task_type = task->GetDynamicTypeOfTask();
+  const auto timer = MakeTechnologyTimer(task_type);
+  task->GetStateOfTesting() = ppc::task::StateOfTesting::kPerf;
+
   SynchronizeMpiRanks();
+  ppc::runtime::ResetThreadBusyTimes();
   const double begin = timer();
+  task->Validation();
+  task->PreProcessing();
   task->Run();
-  const double elapsed = timer() - begin;
   task->PostProcessing();
-  const double max_elapsed = MaxElapsedTimeAcrossMpiRanks(elapsed, task_type);
-  CheckPerfTimeLimit(max_elapsed);
-  return max_elapsed;
+  SynchronizeMpiRanks();
+  auto sample = GatherSampleTime(timer() - begin, task_type);
+  CheckPerfTimeLimit(sample.elapsed);
+  return sample;
+}
+
+/// @brief Brings a task to the Run stage and performs one untimed warm-up run.
+/// @details Absorbs cold-start costs (thread team creation, first-touch page faults) before measuring.
+template <typename InType, typename OutType>
+void PrepareTaskForWarmRuns(const ppc::task::TaskPtr<InType, OutType> &task) {
+  task->GetStateOfTesting() = ppc::task::StateOfTesting::kPerf;
+  task->Validation();
+  task->PreProcessing();
+  SynchronizeMpiRanks();
+  task->Run();
+}
+
+/// @brief Times one more Run() call on a task that is already in the Run stage.
+template <typename InType, typename OutType>
+SampleTime RunWarmTaskForBenchmark(const ppc::task::TaskPtr<InType, OutType> &task,
+                                   const std::function<double()> &timer) {
+  const double elapsed = TimeTaskRun(task, timer);
+  auto sample = GatherSampleTime(elapsed, task->GetDynamicTypeOfTask());
+  CheckPerfTimeLimit(sample.elapsed);
+  return sample;
+}
+
+/// @brief Sampling settings captured from PerfAttr at registration time.
+struct SamplingOptions {
+  uint64_t warmup_runs = 0;
+  uint64_t min_samples = 1;
+  uint64_t max_samples = 1;
+  double target_cv = 0.0;
+  double target_ci = 0.0;
+  /// Name under which the measured samples are kept in RecordedSamples(); empty keeps none
+  std::string record_as{};
+
+  /// @brief Adaptive sampling measures inside a single benchmark iteration until a precision target is met.
+  [[nodiscard]] bool IsAdaptive() const {
+    return target_cv > 0.0 || target_ci > 0.0;
+  }
+};
+
+/// @brief Returns true on every rank if the flag is true on any rank, so all ranks take the same number of samples.
+inline bool AnyMpiRank(bool flag) {
+  if (!IsMpiActive()) {
+    return flag;
+  }
+  int local = flag ? 1 : 0;
+  int global = local;
+  MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_LOR, MPI_COMM_WORLD);
+  return global != 0;
+}
+
+/// @brief Exports the sample statistics (seconds) as Google Benchmark user counters.
+inline void SetSampleStatCounters(benchmark::State &state, const SampleStats &stats) {
+  state.counters["samples"] = static_cast<double>(stats.count);
+  state.counters["median_time"] = stats.median;
+  state.counters["iqr_time"] = stats.iqr;
+  state.counters["ci95_low_time"] = stats.ci_low;
+  state.counters["ci95_high_time"] = stats.ci_high;
+  state.counters["cv"] = stats.cv;
+  state.counters["outliers"] = static_cast<double>(stats.outliers);
+}
+
+/// @brief Accumulates per-rank and per-thread times over the measured samples and exports how balanced they are.
+/// @details For each group it reports the mean per-sample time of the fastest, average and slowest member and the
+/// imbalance factor max / mean - 1. Thread times are the ParallelRun() busy times of this rank and are reported
+/// only when the task used ParallelRun().
+class LoadBalanceCounters {
+ public:
+  void Add(const SampleTime &sample, const std::vector<double> &thread_times) {
+    Accumulate(rank_totals_, sample.rank_times);
+    ++rank_samples_;
+    if (!thread_times.empty()) {
+      Accumulate(thread_totals_, thread_times);
+      ++thread_samples_;
+    }
+  }
+
+  /// @param per_rank Also export every rank's mean time as rank_time_<rank>.
+  void Export(benchmark::UserCounters &counters, bool per_rank) const {
+    ExportSpread(counters, "rank", rank_totals_, rank_samples_);
+    ExportSpread(counters, "thread", thread_totals_, thread_samples_);
+    if (!per_rank) {
+      return;
+    }
+    for (std::size_t rank = 0; rank < rank_totals_.size(); ++rank) {
+      counters["rank_time_" + std::to_string(rank)] = rank_totals_[rank] / static_cast<double>(rank_samples_);
+    }
+  }
+
+ private:
+  static void Accumulate(std::vector<double> &totals, const std::vector<double> &times) {
+    totals.resize(std::max(totals.size(), times.size()), 0.0);
+    for (std::size_t i = 0; i < times.size(); ++i) {
+      totals[i] += times[i];
+    }
+  }
+
+  static void ExportSpread(benchmark::UserCounters &counters, const std::string &group,
+                           const std::vector<double> &totals, uint64_t samples) {
+    if (totals.empty() || samples == 0) {
+      return;
+    }
+    const auto count = static_cast<double>(samples);
+    const auto [min_total, max_total] = std::ranges::minmax(totals);
+    double sum = 0.0;
+    for (const double total : totals) {
+      sum += total;
+    }
+    const double mean_total = sum / static_cast<double>(totals.size());
+    counters[group + "_time_min"] = min_total / count;
+    counters[group + "_time_mean"] = mean_total / count;
+    counters[group + "_time_max"] = max_total / count;
+    counters[group + "_imbalance"] = mean_total > 0.0 ? (max_total / mean_total) - 1.0 : 0.0;
+  }
+
+  std::vector<double> rank_totals_;
+  std::vector<double> thread_totals_;
+  uint64_t rank_samples_ = 0;
+  uint64_t thread_samples_ = 0;
+};
+
+/// @brief Times measured by the calling rank alone.
+/// @details The regular counters describe the slowest rank; these describe the rank whose output they end up in:
+/// its own sample times and, in the modes that time stages, its own stage times before the reduction across ranks.
+class LocalRankCounters {
+ public:
+  LocalRankCounters() {
+    if (IsMpiActive()) {
+      MPI_Comm_rank(MPI_COMM_WORLD, &rank_);
+    }
+  }
+
+  void Add(const SampleTime &sample) {
+    const auto rank = static_cast<std::size_t>(rank_);
+    if (rank < sample.rank_times.size()) {
+      times_.push_back(sample.rank_times[rank]);
+    } else {
+      // Tasks that do not use MPI only keep the local time.
+      times_.push_back(sample.rank_times.empty() ? sample.elapsed : sample.rank_times.front());
+    }
+  }
+
+  void Add(const SampleTime &sample, const ppc::task::StageTimings &stage_timings) {
+    Add(sample);
+    AccumulateStageTimings(stage_totals_, stage_timings);
+    ++stage_samples_;
+  }
+
+  void Export(benchmark::UserCounters &counters) const {
+    if (times_.empty()) {
+      return;
+    }
+    double sum = 0.0;
+    for (const double time : times_) {
+      sum += time;
+    }
+    counters["rank"] = static_cast<double>(rank_);
+    counters["local_time_median"] = SummarizeSamples(times_).median;
+    counters["local_time_mean"] = sum / static_cast<double>(times_.size());
+    if (stage_samples_ == 0) {
+      return;
+    }
+    const auto count = static_cast<double>(stage_samples_);
+    counters["local_validation_time"] = stage_totals_.validation / count;
+    counters["local_preprocessing_time"] = stage_totals_.preprocessing / count;
+    counters["local_run_time"] = stage_totals_.run / count;
+    counters["local_postprocessing_time"] = stage_totals_.postprocessing / count;
+  }
+
+ private:
+  int rank_ = 0;
+  std::vector<double> times_;
+  ppc::task::StageTimings stage_totals_;
+  uint64_t stage_samples_ = 0;
+};
+
+/// @brief Per-stage metrics of a benchmark's samples, exported per Run() call.
+/// @details Counters are named "<stage>_<metric>" and come in three groups:
+/// - events of the active ppc::util::PerfCounters (e.g. run_cycles), only for events that could be counted; the
+///   run stage also gets run_ipc (instructions per cycle), run_llc_miss_rate (misses per LLC reference) and
+///   run_llc_mpki (misses per thousand instructions) when their inputs are available;
+/// - heap allocations: "<stage>_allocations" and "<stage>_allocated_bytes" (means), "<stage>_peak_live_bytes"
+///   (largest over the samples), run_allocating_threads and run_thread_allocations_max, the most allocations made
+///   by a single thread;
+/// - MPI calls of this rank: "<stage>_communication_time" (point-to-point and collective calls),
+///   "<stage>_wait_time" (MPI_Wait*, MPI_Test*, probes) and "<stage>_compute_time", the rest of the stage's local
+///   time; the run stage also reports run_<kind>_calls, run_<kind>_bytes and run_<kind>_time for kind p2p,
+///   collective and wait, and run_mpi_fraction, the share of the run spent in MPI.
+class StageMetricsTotals {
+ public:
+  /// @brief Selects the groups Export() writes; allocations and MPI calls are only measured in matching builds.
+  struct Groups {
+    bool perf_counters = false;
+    bool allocations = kAllocTrackingEnabled;
+    bool mpi = kMpiProfilingEnabled;
+  };
+
+  void Add(const ppc::task::PipelineMetrics &metrics) {
+    AddSetup(metrics);
+    AddRun(metrics.run);
+  }
+
+  /// Adds the validation, preprocessing and postprocessing stages of one pipeline pass.
+  void AddSetup(const ppc::task::PipelineMetrics &metrics) {
+    Accumulate(totals_.validation, metrics.validation);
+    Accumulate(totals_.preprocessing, metrics.preprocessing);
+    Accumulate(totals_.postprocessing, metrics.postprocessing);
+    ++setup_samples_;
+  }
+
+  /// Adds one Run() call, or one batch of them.
+  void AddRun(const ppc::task::StageMetrics &run) {
+    Accumulate(totals_.run, run);
+    ++run_samples_;
+    allocating_threads_ = std::max(allocating_threads_, run.allocations.threads.size());
+    for (const auto &thread : run.allocations.threads) {
+      thread_allocations_max_ = std::max(thread_allocations_max_, thread.allocations);
+    }
+  }
+
+  /// @param runs_per_sample Run() calls covered by one added run, e.g. the batch size.
+  void Export(benchmark::UserCounters &counters, double runs_per_sample, const Groups &groups) const {
+    const auto setup_samples = static_cast<double>(setup_samples_);
+    const double runs = static_cast<double>(run_samples_) * runs_per_sample;
+    ExportStage(counters, "validation", totals_.validation, setup_samples, groups);
+    ExportStage(counters, "preprocessing", totals_.preprocessing, setup_samples, groups);
+    ExportStage(counters, "postprocessing", totals_.postprocessing, setup_samples, groups);
+    ExportStage(counters, "run", totals_.run, runs, groups);
+    if (run_samples_ == 0) {
+      return;
+    }
+    if (groups.perf_counters) {
+      ExportRunRates(counters, totals_.run.counters);
+    }
+    if (groups.allocations) {
+      counters["run_allocating_threads"] = static_cast<double>(allocating_threads_);
+      counters["run_thread_allocations_max"] = static_cast<double>(thread_allocations_max_) / runs_per_sample;
+    }
+    if (groups.mpi) {
+      ExportRunMpiCalls(counters, totals_.run, runs);
+    }
+  }
+
+ private:
+  /// Sums everything but the peak live bytes, which keep their largest value.
+  static void Accumulate(ppc::task::StageMetrics &total, const ppc::task::StageMetrics &stage) {
+    total.time += stage.time;
+    total.counters += stage.counters;
+    total.allocations.allocations += stage.allocations.allocations;
+    total.allocations.bytes += stage.allocations.bytes;
+    total.allocations.peak_live_bytes = std::max(total.allocations.peak_live_bytes, stage.allocations.peak_live_bytes);
+    total.mpi_profile += stage.mpi_profile;
+  }
+
+  static void ExportStage(benchmark::UserCounters &counters, const std::string &stage,
+                          const ppc::task::StageMetrics &total, double samples, const Groups &groups) {
+    if (samples <= 0.0) {
+      return;
+    }
+    if (groups.perf_counters) {
+      for (std::size_t kind = 0; kind < kNumPerfCounterKinds; ++kind) {
+        if (total.counters.available.at(kind)) {
+          counters[stage + "_" + std::string(kPerfCounterNames.at(kind))] = total.counters.values.at(kind) / samples;
+        }
+      }
+    }
+    if (groups.allocations) {
+      counters[stage + "_allocations"] = static_cast<double>(total.allocations.allocations) / samples;
+      counters[stage + "_allocated_bytes"] = static_cast<double>(total.allocations.bytes) / samples;
+      counters[stage + "_peak_live_bytes"] = static_cast<double>(total.allocations.peak_live_bytes);
+    }
+    if (groups.mpi) {
+      const double communication = total.mpi_profile.CommunicationTime();
+      const double wait = total.mpi_profile.WaitTime();
+      counters[stage + "_communication_time"] = communication / samples;
+      counters[stage + "_wait_time"] = wait / samples;
+      counters[stage + "_compute_time"] = std::max(total.time - communication - wait, 0.0) / samples;
+    }
+  }
+
+  static void ExportRunRates(benchmark::UserCounters &counters, const PerfCounterValues &run) {
+    const auto ratio = [&run](PerfCounterKind numerator, PerfCounterKind denominator) -> std::optional<double> {
+      if (!run.Has(numerator) || !run.Has(denominator) || run.Get(denominator) <= 0.0) {
+        return std::nullopt;
+      }
+      return run.Get(numerator) / run.Get(denominator);
+    };
+    if (const auto ipc = ratio(PerfCounterKind::kInstructions, PerfCounterKind::kCycles)) {
+      counters["run_ipc"] = *ipc;
+    }
+    if (const auto miss_rate = ratio(PerfCounterKind::kLlcMisses, PerfCounterKind::kLlcReferences)) {
+      counters["run_llc_miss_rate"] = *miss_rate;
+    }
+    if (const auto misses_per_instruction = ratio(PerfCounterKind::kLlcMisses, PerfCounterKind::kInstructions)) {
+      constexpr double kInstructionsPerKilo = 1000.0;
+      counters["run_llc_mpki"] = *misses_per_instruction * kInstructionsPerKilo;
+    }
+  }
+
+  static void ExportRunMpiCalls(benchmark::UserCounters &counters, const ppc::task::StageMetrics &run, double runs) {
+    for (std::size_t kind = 0; kind < kNumMpiCallKinds; ++kind) {
+      const auto &stats = run.mpi_profile.kinds.at(kind);
+      const std::string prefix = "run_" + std::string(kMpiCallKindNames.at(kind));
+      counters[prefix + "_calls"] = static_cast<double>(stats.calls) / runs;
+      counters[prefix + "_bytes"] = static_cast<double>(stats.bytes) / runs;
+      counters[prefix + "_time"] = stats.time / runs;
+    }
+    const double mpi_time = run.mpi_profile.CommunicationTime() + run.mpi_profile.WaitTime();
+    counters["run_mpi_fraction"] = run.time > 0.0 ? std::min(mpi_time / run.time, 1.0) : 0.0;
+  }
+
+  ppc::task::PipelineMetrics totals_;
+  uint64_t setup_samples_ = 0;
+  uint64_t run_samples_ = 0;
+  std::size_t allocating_threads_ = 0;
+  uint64_t thread_allocations_max_ = 0;
+};
+
+/// @brief Opens the counters of one benchmark and notes once per process when hardware events are unavailable.
+inline void OpenBenchmarkPerfCounters(std::optional<PerfCounters> &counters,
+                                      std::optional<ActivePerfCountersScope> &active) {
+  counters.emplace();
+  active.emplace(*counters);
+  static bool reported = false;
+  if (!counters->HasHardwareEvents() && !reported) {
+    reported = true;
+    std::cerr << "Hardware perf events are unavailable (perf_event_paranoid, container or VM); only software and "
+                 "getrusage() counters are reported.\n";
+  }
+}
+
+/// @brief Starts recording the MPI traffic of one benchmark and notes once per process when the build cannot.
+inline void StartBenchmarkMpiTraffic(std::optional<MpiTrafficMeasurement> &traffic) {
+  if constexpr (kMpiProfilingEnabled) {
+    traffic.emplace();
+  } else {
+    static bool reported = false;
+    if (!reported && GetMPIRank() == 0) {
+      std::cerr << "PPC_MPI_COMM_REPORT needs a build with PPC_ENABLE_MPI_PROFILING; no traffic is reported.\n";
+    }
+    reported = true;
+  }
+}
+
+/// @brief Prints the traffic heatmap of a benchmark on rank 0 and writes the JSON report to <name>.comm.json in
+/// PPC_TEST_TMPDIR. Benchmarks whose stages made no MPI calls are skipped. Must be called on every rank.
+inline void WriteBenchmarkMpiCommReport(const MpiTraffic &traffic, const std::string &name) {
+  const auto report = GatherMpiCommReport(traffic);
+  const auto is_zero = [](uint64_t value) -> bool { return value == 0; };
+  const bool has_calls = std::ranges::any_of(report.message_sizes, [&is_zero](const auto &histogram) -> bool {
+    return !std::ranges::all_of(histogram, is_zero);
+  });
+  if (report.bytes.empty() || (!has_calls && std::ranges::all_of(report.messages, is_zero))) {
+    return;
+  }
+  std::cout << FormatMpiCommHeatmap(report, name);
+  const auto tmp_dir = env::get<std::string>("PPC_TEST_TMPDIR");
+  if (!tmp_dir.has_value()) {
+    return;
+  }
+  const auto path = std::filesystem::path(tmp_dir.value()) / (ppc::util::test::SanitizeToken(name) + ".comm.json");
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to write MPI traffic report " + path.string());
+  }
+  file << FormatMpiCommReportJson(report) << '\n';
+  std::cout << "MPI traffic report: " << path.string() << '\n';
+}
+
+/// @brief Measured sample times in seconds of every benchmark run in this process, keyed by registered name.
+/// @details Written to the JSON output after the run (see AttachSamplesToBenchmarkOutput) so results can be compared
+/// sample by sample; repeated runs of a benchmark append to its entry.
+inline std::map<std::string, std::vector<double>> &RecordedSamples() {
+  static std::map<std::string, std::vector<double>> samples;
+  return samples;
+}
+
+/// @brief Runs the discarded warm-up samples and the measured ones, then exports their statistics.
+/// @details With a fixed count every benchmark iteration is one sample. In adaptive sampling the benchmark has a
+/// single iteration that takes samples until the precision target is met, max_samples is reached or the measured
+/// time reaches GetPerfMaxTime(); the iteration then reports the median.
+/// @param sample Takes one sample and returns its time in seconds; the argument is false for warm-up runs.
+template <typename Sample>
+void CollectSamples(benchmark::State &state, const SamplingOptions &sampling, Sample &&sample) {
+  for (uint64_t run = 0; run < sampling.warmup_runs; ++run) {
+    sample(false);
+  }
+  std::vector<double> samples;
+  for (auto _ : state) {
+    if (!sampling.IsAdaptive()) {
+      samples.push_back(sample(true));
+      state.SetIterationTime(samples.back());
+      continue;
+    }
+    double measured_time = 0.0;
+    bool more = true;
+    while (more) {
+      samples.push_back(sample(true));
+      measured_time += samples.back();
+      more = samples.size() < sampling.max_samples && measured_time < GetPerfMaxTime() &&
+             (samples.size() < sampling.min_samples ||
+              !IsPreciseEnough(SummarizeSamples(samples), sampling.target_cv, sampling.target_ci));
+      more = AnyMpiRank(more);
+    }
+    state.SetIterationTime(SummarizeSamples(samples).median);
+  }
+  SetSampleStatCounters(state, SummarizeSamples(samples));
+  if (!sampling.record_as.empty()) {
+    auto &recorded = RecordedSamples()[sampling.record_as];
+    recorded.insert(recorded.end(), samples.begin(), samples.end());
+  }
+}
+
+/// @brief Per-benchmark settings captured from PerfAttr at registration time.
+struct BenchmarkOptions {
+  PerfMode mode = PerfMode::kCold;
+  uint64_t stream_length = 1;
+  uint64_t batch_size = 1;
+  bool per_rank_times = false;
+  bool local_rank_counters = false;
+  bool perf_counters = false;
+  bool mpi_comm_report = false;
+  SamplingOptions sampling;
+  /// Name shared by all implementations of the task, see MakeScalingKey()
+  std::string scaling_key;
+  ppc::task::TypeOfTask task_type = ppc::task::TypeOfTask::kUnknown;
+  /// Thread count of a sweep point; 0 runs at the PPC_NUM_THREADS of the process
+  int num_threads = 0;
+  /// The benchmark takes the size from GetTestSizes() as its "size" argument
+  bool sized = false;
+  bool weak_scaling = false;
+  /// Ceilings of the task's backend at its thread count; unknown when roofline reporting is off
+  RooflineCeilings roofline;
+};
+
+/// @brief Input of a benchmark for one size from GetTestSizes().
+template <typename InType>
+struct SizedInput {
+  ppc::task::SharedInput<InType> input;
+  /// Size the input was built for: the declared size, times the worker count under weak scaling
+  int64_t problem_size = 0;
+  /// Work of one Run() on the input, from GetWorkMetrics()
+  WorkMetrics work;
+};
+
+/// @brief Number of Run() calls timed by one sample of the mode.
+inline double RunsPerSample(const BenchmarkOptions &options) {
+  if (options.mode == PerfMode::kStream) {
+    return static_cast<double>(std::max<uint64_t>(options.stream_length, 1));
+  }
+  if (options.mode == PerfMode::kBatch) {
+    return static_cast<double>(std::max<uint64_t>(options.batch_size, 1));
+  }
+  return 1.0;
+}
+
+/// @brief Exports the declared work as rates over the median sample time: gb_per_second (bytes read and written),
+/// gflop_per_second and elements_per_second. Fields left at zero are not exported.
+/// @details With known ceilings it also exports roof_fraction: the FLOP rate over the attainable rate at the task's
+/// arithmetic_intensity (FLOPs per byte) when both are declared, otherwise the rate over the memory or compute roof.
+inline void ExportWorkCounters(benchmark::UserCounters &counters, const WorkMetrics &work, double runs_per_sample,
+                               const RooflineCeilings &roofline = {}) {
+  const auto median = counters.find("median_time");
+  if (median == counters.end() || static_cast<double>(median->second) <= 0.0) {
+    return;
+  }
+  const double run_time = static_cast<double>(median->second) / runs_per_sample;
+  const double bytes = work.bytes_read + work.bytes_written;
+  if (bytes > 0.0) {
+    counters["gb_per_second"] = bytes / run_time * 1e-9;
+  }
+  if (work.flops > 0.0) {
+    counters["gflop_per_second"] = work.flops / run_time * 1e-9;
+  }
+  if (work.elements > 0.0) {
+    counters["elements_per_second"] = work.elements / run_time;
+  }
+  if (!roofline.IsKnown() || (bytes <= 0.0 && work.flops <= 0.0)) {
+    return;
+  }
+  if (bytes > 0.0 && work.flops > 0.0) {
+    const double intensity = work.flops / bytes;
+    counters["arithmetic_intensity"] = intensity;
+    counters["roof_fraction"] = work.flops / run_time / roofline.Attainable(intensity);
+  } else if (work.flops > 0.0) {
+    counters["roof_fraction"] = work.flops / run_time / roofline.flops;
+  } else {
+    counters["roof_fraction"] = bytes / run_time / roofline.triad;
+  }
+}
+
+/// @brief Inputs keyed by declared size; unsized benchmarks use the single entry 0.
+template <typename InType>
+using SizedInputs = std::map<int64_t, SizedInput<InType>>;
+
+/// @brief Runs the threading runtimes and GetNumThreads() at a given thread count for the lifetime of the scope.
+/// @details Overrides PPC_NUM_THREADS and resizes the active RuntimeManager; without one, OpenMP and TBB are
+/// limited directly. The previous configuration is restored on destruction.
+class ScopedThreadCount {
+ public:
+  explicit ScopedThreadCount(int num_threads)
+      : num_threads_env_("PPC_NUM_THREADS", std::to_string(num_threads)), previous_omp_threads_(omp_get_max_threads()) {
+    auto *runtime = ppc::runtime::RuntimeManager::Instance();
+    if (runtime != nullptr) {
+      previous_runtime_threads_ = runtime->GetNumThreads();
+      runtime->Resize(num_threads);
+      return;
+    }
+    tbb_control_.emplace(tbb::global_control::max_allowed_parallelism, static_cast<std::size_t>(num_threads));
+    omp_set_num_threads(num_threads);
+  }
+  ScopedThreadCount(const ScopedThreadCount &) = delete;
+  ScopedThreadCount(ScopedThreadCount &&) = delete;
+  ScopedThreadCount &operator=(const ScopedThreadCount &) = delete;
+  ScopedThreadCount &operator=(ScopedThreadCount &&) = delete;
+  ~ScopedThreadCount() {
+    auto *runtime = ppc::runtime::RuntimeManager::Instance();
+    try {
+      if (runtime != nullptr && previous_runtime_threads_ > 0) {
+        runtime->Resize(previous_runtime_threads_);
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "Failed to restore the runtime thread count: " << e.what() << '\n';
+    }
+    omp_set_num_threads(previous_omp_threads_);
+  }
+
+ private:
+  env::detail::set_scoped_environment_variable num_threads_env_;
+  int previous_omp_threads_;
+  int previous_runtime_threads_ = 0;
+  std::optional<tbb::global_control> tbb_control_;
+};
+
+/// @brief Median sample time of every SEQ benchmark run so far, keyed by scaling key and mode.
+inline std::map<std::string, double> &ScalingBaselines() {
+  static std::map<std::string, double> baselines;
+  return baselines;
+}
+
+inline int MpiWorldSize() {
+  if (!IsMpiActive()) {
+    return 1;
+  }
+  int size = 1;
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  return size;
+}
+
+/// @brief Returns how many ranks and threads a task of the given type works with.
+inline int64_t CountWorkers(ppc::task::TypeOfTask type, int num_threads) {
+  const int64_t ranks = IsMpiTaskType(type) ? MpiWorldSize() : 1;
+  return ranks * (IsThreadTaskType(type) ? std::max(num_threads, 1) : 1);
+}
+
+/// @brief Records SEQ medians as scaling baselines and exports threads, speedup and efficiency for sweep points.
+/// @details The ratio of the SEQ median to this benchmark's median in the same mode and at the same declared size is
+/// the speedup, and divided by the number of workers (the thread count, times the number of ranks for ALL tasks)
+/// the efficiency. Under weak scaling the ratio is the efficiency and multiplied by the workers the scaled speedup.
+/// Both are left out when no SEQ benchmark of the task ran before this one.
+/// @param size Declared size of a sized benchmark, 0 otherwise.
+inline void ExportScalingCounters(benchmark::UserCounters &counters, const BenchmarkOptions &options,
+                                  int64_t size = 0) {
+  const auto median = counters.find("median_time");
+  if (median == counters.end()) {
+    return;
+  }
+  std::string key = MakePerfBenchmarkName(options.scaling_key, options.mode);
+  if (options.sized) {
+    key += "/size:" + std::to_string(size);
+  }
+  if (options.task_type == ppc::task::TypeOfTask::kSEQ) {
+    ScalingBaselines()[key] = median->second;
+    return;
+  }
+  if (options.num_threads <= 0) {
+    return;
+  }
+  counters["threads"] = static_cast<double>(options.num_threads);
+  const auto baseline = ScalingBaselines().find(key);
+  if (baseline == ScalingBaselines().end() || median->second <= 0.0) {
+    return;
+  }
+  const auto workers = static_cast<double>(CountWorkers(options.task_type, options.num_threads));
+  const double ratio = baseline->second / median->second;
+  counters["speedup"] = options.weak_scaling ? ratio * workers : ratio;
+  counters["efficiency"] = options.weak_scaling ? ratio : ratio / workers;
+}
+
+/// @brief Returns the largest value across MPI ranks, so every rank takes the same calibration steps.
+inline double MaxAcrossMpiRanks(double value) {
+  if (!IsMpiActive()) {
+    return value;
+  }
+  double global = value;
+  MPI_Allreduce(&value, &global, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+  return global;
+}
+
+/// @brief Returns rank 0's value on every rank.
+inline int64_t BroadcastFromRootRank(int64_t value) {
+  if (IsMpiActive()) {
+    MPI_Bcast(&value, 1, MPI_INT64_T, 0, MPI_COMM_WORLD);
+  }
+  return value;
+}
+
+/// @brief Times Run() of a fresh task for input calibration; unlike RunTaskForBenchmark() no time limit applies.
+template <typename InType, typename OutType>
+double TimeCalibrationRun(const ppc::task::TaskPtr<InType, OutType> &task) {
+  task->GetStateOfTesting() = ppc::task::StateOfTesting::kPerf;
+  task->Validation();
+  task->PreProcessing();
+  const double elapsed = TimeTaskRun(task, MakeTechnologyTimer(task->GetDynamicTypeOfTask()));
+  task->PostProcessing();
+  return MaxAcrossMpiRanks(elapsed);
+}
+
+template <typename InType, typename OutType>
+using TaskGetterFunction = std::function<ppc::task::TaskPtr<InType, OutType>(ppc::task::SharedInput<InType>)>;
+
+/// @brief SEQ task getters registered by MakePerfTaskTuples(), keyed by MakeScalingKey(); they calibrate inputs.
+template <typename InType, typename OutType>
+std::map<std::string, TaskGetterFunction<InType, OutType>> &SeqTaskGetters() {
+  static std::map<std::string, TaskGetterFunction<InType, OutType>> getters;
+  return getters;
+}
+
+/// @brief Calibrated sizes keyed by MakeScalingKey(), so every implementation of a task uses the same input.
+inline std::map<std::string, int64_t> &CalibratedSizes() {
+  static std::map<std::string, int64_t> sizes;
+  return sizes;
+}
+
+/// @brief Registrations postponed until every regular benchmark is registered, see RegisterDeferredBenchmarks().
+inline std::vector<std::function<void()>> &DeferredBenchmarkRegistrations() {
+  static std::vector<std::function<void()>> registrations;
+  return registrations;
+}
+
+/// @brief Runs a fresh task per sample, timing Run() only (cold) or the whole pipeline (pipeline mode).
+template <typename TaskGetter, typename InType>
+void RunColdIterations(const TaskGetter &task_getter, const ppc::task::SharedInput<InType> &input_data,
+                       const BenchmarkOptions &options, benchmark::State &state) {
+  ppc::task::StageTimings total;
+  LoadBalanceCounters balance;
+  LocalRankCounters local;
+  StageMetricsTotals metrics;
+  uint64_t measured = 0;
+  CollectSamples(state, options.sampling, [&](bool measure) -> double {
+    auto task = task_getter(input_data);
+    const auto sample =
+        options.mode == PerfMode::kPipeline ? RunPipelineForBenchmark(task) : RunTaskForBenchmark(task);
+    benchmark::DoNotOptimize(task->GetOutput());
+    CheckRunAllocationBudget(task->GetStageMetrics().run.allocations);
+    if (measure) {
+      AccumulateStageTimings(total,
+                             MaxStageTimingsAcrossMpiRanks(task->GetStageTimings(), task->GetDynamicTypeOfTask()));
+      balance.Add(sample, ppc::runtime::GetThreadBusyTimes());
+      local.Add(sample, task->GetStageTimings());
+      metrics.Add(task->GetStageMetrics());
+      ++measured;
+    }
+    return sample.elapsed;
+  });
+  const auto samples = static_cast<double>(measured);
+  SetStageTimeCounters(state, {.validation = total.validation / samples,
+                               .preprocessing = total.preprocessing / samples,
+                               .run = total.run / samples,
+                               .postprocessing = total.postprocessing / samples});
+  balance.Export(state.counters, options.per_rank_times);
+  if (options.local_rank_counters) {
+    local.Export(state.counters);
+  }
+  metrics.Export(state.counters, 1.0, {.perf_counters = options.perf_counters});
+}
+
+/// @brief Keeps one task alive for the whole benchmark and times repeated Run() calls.
+/// @note Run() must be repeatable on the same instance (the pipeline allows kRun -> kRun).
+template <typename TaskGetter, typename InType>
+void RunWarmIterations(const TaskGetter &task_getter, const ppc::task::SharedInput<InType> &input_data,
+                       const BenchmarkOptions &options, benchmark::State &state) {
+  auto task = task_getter(input_data);
+  const auto timer = MakeTechnologyTimer(task->GetDynamicTypeOfTask());
+  PrepareTaskForWarmRuns(task);
+  double total_run = 0.0;
+  LoadBalanceCounters balance;
+  LocalRankCounters local;
+  StageMetricsTotals metrics;
+  uint64_t measured = 0;
+  CollectSamples(state, options.sampling, [&](bool measure) -> double {
+    const auto sample = RunWarmTaskForBenchmark(task, timer);
+    benchmark::DoNotOptimize(task->GetOutput());
+    CheckRunAllocationBudget(task->GetStageMetrics().run.allocations);
+    if (measure) {
+      total_run += task->GetStageMetrics().run.time;
+      balance.Add(sample, ppc::runtime::GetThreadBusyTimes());
+      local.Add(sample, task->GetStageTimings());
+      metrics.AddRun(task->GetStageMetrics().run);
+      ++measured;
+    }
+    return sample.elapsed;
+  });
+  task->PostProcessing();
+  metrics.AddSetup(task->GetStageMetrics());
+  // Validation, preprocessing and postprocessing happen once per benchmark in warm mode.
+  auto timings = task->GetStageTimings();
+  timings.run = total_run / static_cast<double>(measured);
+  SetStageTimeCounters(state, MaxStageTimingsAcrossMpiRanks(timings, task->GetDynamicTypeOfTask()));
+  balance.Export(state.counters, options.per_rank_times);
+  if (options.local_rank_counters) {
+    local.Export(state.counters);
+  }
+  metrics.Export(state.counters, 1.0, {.perf_counters = options.perf_counters});
+}
+
+/// @brief Pushes a stream of fresh tasks per sample through a PipelinedRunner and reports items per second.
+/// @details The runner is created once and reused by every sample, and task construction is not timed; the clock
+/// runs from the first Submit() until every output is available. MPI-based tasks fall back to serial stage
+/// execution (see ppc::task::DefaultPipelineExecution).
+template <typename TaskGetter, typename InType>
+void RunStreamIterations(const TaskGetter &task_getter, const ppc::task::SharedInput<InType> &input_data,
+                         const BenchmarkOptions &options, benchmark::State &state) {
+  using TaskPtrType = std::invoke_result_t<const TaskGetter &, const ppc::task::SharedInput<InType> &>;
+  using TaskType = typename TaskPtrType::element_type;
+  using OutType = std::remove_cvref_t<decltype(std::declval<TaskType &>().GetOutput())>;
+  const uint64_t items = options.stream_length == 0 ? 1 : options.stream_length;
+  double total_time = 0.0;
+  LoadBalanceCounters balance;
+  LocalRankCounters local;
+  uint64_t measured = 0;
+  // One runner serves every sample, so its stage threads keep their OpenMP teams warm between samples.
+  std::optional<ppc::task::PipelinedRunner<InType, OutType>> runner;
+  CollectSamples(state, options.sampling, [&](bool measure) -> double {
+    // The tasks are created before the clock starts.
+    std::vector<TaskPtrType> tasks;
+    tasks.reserve(items);
+    for (uint64_t item = 0; item < items; ++item) {
+      tasks.push_back(task_getter(input_data));
+      tasks.back()->GetStateOfTesting() = ppc::task::StateOfTesting::kPerf;
+    }
+    const auto task_type = tasks.front()->GetDynamicTypeOfTask();
+    const auto timer = MakeTechnologyTimer(task_type);
+    if (!runner) {
+      runner.emplace(ppc::task::DefaultPipelineExecution(task_type));
+    }
+    std::vector<std::future<OutType>> results;
+    results.reserve(items);
+
+    SynchronizeMpiRanks();
+    ppc::runtime::ResetThreadBusyTimes();
+    const double begin = timer();
+    for (auto &task : tasks) {
+      results.push_back(runner->Submit(std::move(task)));
+    }
+    for (auto &result : results) {
+      benchmark::DoNotOptimize(result.get());
+    }
+    SynchronizeMpiRanks();
+    const auto sample = GatherSampleTime(timer() - begin, task_type);
+    CheckPerfTimeLimit(sample.elapsed / static_cast<double>(items));
+    if (measure) {
+      total_time += sample.elapsed;
+      balance.Add(sample, ppc::runtime::GetThreadBusyTimes());
+      local.Add(sample);
+      ++measured;
+    }
+    return sample.elapsed;
+  });
+  const auto total_items = static_cast<double>(items) * static_cast<double>(measured);
+  state.counters["stream_length"] = static_cast<double>(items);
+  state.counters["items_per_second"] = total_time > 0.0 ? total_items / total_time : 0.0;
+  balance.Export(state.counters, options.per_rank_times);
+  if (options.local_rank_counters) {
+    local.Export(state.counters);
+  }
+}
+
+/// @brief Runs the input batch_size times through one fresh task per sample and reports items per second.
+/// @details Task construction is not timed; RunBatch() is timed between two rank barriers, so per-task setup is
+/// paid once per batch rather than once per item. The batch repeats the shared input rather than holding
+/// batch_size copies of it; see Task::RunBatchImpl() for how each item is loaded.
+template <typename TaskGetter, typename InType>
+void RunBatchIterations(const TaskGetter &task_getter, const ppc::task::SharedInput<InType> &input_data,
+                        const BenchmarkOptions &options, benchmark::State &state) {
+  using TaskPtrType = std::invoke_result_t<const TaskGetter &, const ppc::task::SharedInput<InType> &>;
+  using TaskType = typename TaskPtrType::element_type;
+  using OutType = std::remove_cvref_t<decltype(std::declval<TaskType &>().GetOutput())>;
+  const uint64_t items = options.batch_size == 0 ? 1 : options.batch_size;
+  std::vector<OutType> outputs;
+  double total_time = 0.0;
+  LoadBalanceCounters balance;
+  LocalRankCounters local;
+  StageMetricsTotals metrics;
+  uint64_t measured = 0;
+  CollectSamples(state, options.sampling, [&](bool measure) -> double {
+    auto task = task_getter(input_data);
+    const auto task_type = task->GetDynamicTypeOfTask();
+    const auto timer = MakeTechnologyTimer(task_type);
+    task->GetStateOfTesting() = ppc::task::StateOfTesting::kPerf;
+
+    SynchronizeMpiRanks();
+    ppc::runtime::ResetThreadBusyTimes();
+    const double begin = timer();
+    const bool batch_ok = task->RunBatch(*input_data, items, outputs);
+    SynchronizeMpiRanks();
+    const auto sample = GatherSampleTime(timer() - begin, task_type);
+    if (!batch_ok) {
+      throw std::runtime_error("Task batch run failed.");
+    }
+    CheckPerfTimeLimit(sample.elapsed / static_cast<double>(items));
+    CheckRunAllocationBudget(task->GetStageMetrics().run.allocations, items);
+    benchmark::DoNotOptimize(outputs);
+    if (measure) {
+      total_time += sample.elapsed;
+      balance.Add(sample, ppc::runtime::GetThreadBusyTimes());
+      local.Add(sample);
+      metrics.AddRun(task->GetStageMetrics().run);
+      ++measured;
+    }
+    return sample.elapsed;
+  });
+  const auto total_items = static_cast<double>(items) * static_cast<double>(measured);
+  state.counters["batch_size"] = static_cast<double>(items);
+  state.counters["items_per_second"] = total_time > 0.0 ? total_items / total_time : 0.0;
+  balance.Export(state.counters, options.per_rank_times);
+  if (options.local_rank_counters) {
+    local.Export(state.counters);
+  }
+  metrics.Export(state.counters, static_cast<double>(items), {.perf_counters = options.perf_counters});
 }
 
 template <typename TaskGetter, typename InType>
-void RunBenchmarkBody(const TaskGetter &task_getter, const InType &input_data, const std::string &test_env_token,
+void RunBenchmarkBody(const TaskGetter &task_getter, const SizedInputs<InType> &inputs,
+                      const std::string &test_env_token, const BenchmarkOptions &options,
                       benchmark::State &state) noexcept {
   try {
+    const int64_t size = options.sized ? state.range(0) : 0;
+    const auto &[input_data, problem_size, work] = inputs.at(size);
+    auto run_options = options;
+    if (options.sized && !run_options.sampling.record_as.empty()) {
+      run_options.sampling.record_as += "/size:" + std::to_string(size);
+    }
     const auto benchmark_env_scope = ppc::util::test::ScopedPerTestEnv(test_env_token);
-    for (auto _ : state) {
-      auto task = task_getter(input_data);
-      const double elapsed = RunTaskForBenchmark(task);
-      state.SetIterationTime(elapsed);
-      benchmark::DoNotOptimize(task->GetOutput());
+    ClearTraceEvents();
+    std::optional<ScopedThreadCount> thread_count;
+    if (options.num_threads > 0) {
+      thread_count.emplace(options.num_threads);
+    }
+    // Opened after the thread count is applied so the counters cover the worker threads that exist by now.
+    std::optional<PerfCounters> perf_counters;
+    std::optional<ActivePerfCountersScope> active_perf_counters;
+    if (options.perf_counters) {
+      OpenBenchmarkPerfCounters(perf_counters, active_perf_counters);
+    }
+    std::optional<MpiTrafficMeasurement> mpi_traffic;
+    if (options.mpi_comm_report) {
+      StartBenchmarkMpiTraffic(mpi_traffic);
+    }
+    if (options.mode == PerfMode::kWarm) {
+      RunWarmIterations(task_getter, input_data, run_options, state);
+    } else if (options.mode == PerfMode::kStream) {
+      RunStreamIterations(task_getter, input_data, run_options, state);
+    } else if (options.mode == PerfMode::kBatch) {
+      RunBatchIterations(task_getter, input_data, run_options, state);
+    } else {
+      RunColdIterations(task_getter, input_data, run_options, state);
+    }
+    if (problem_size > 0) {
+      state.counters["problem_size"] = static_cast<double>(problem_size);
+    }
+    ExportWorkCounters(state.counters, work, RunsPerSample(options), options.roofline);
+    ExportScalingCounters(state.counters, options, size);
+    WriteTestTrace(ppc::util::test::SanitizeToken(run_options.sampling.record_as) + ".trace.json");
+    if (mpi_traffic.has_value()) {
+      WriteBenchmarkMpiCommReport(mpi_traffic->Stop(), run_options.sampling.record_as);
     }
   } catch (const std::exception &e) {
     PerformanceFailureFlag::Set();
@@ -148,29 +1394,34 @@ void RunBenchmarkBody(const TaskGetter &task_getter, const InType &input_data, c
   }
 }
 
+/// @brief Benchmark callable; shares the fixture's inputs instead of holding its own copies.
 template <typename TaskGetter, typename InType>
 class BenchmarkTaskBody final {
  public:
-  BenchmarkTaskBody(TaskGetter task_getter, InType input_data, std::string test_env_token)
+  BenchmarkTaskBody(TaskGetter task_getter, SizedInputs<InType> inputs, std::string test_env_token,
+                    BenchmarkOptions options)
       : task_getter_(std::move(task_getter)),
-        input_data_(std::move(input_data)),
-        test_env_token_(std::move(test_env_token)) {}
+        inputs_(std::move(inputs)),
+        test_env_token_(std::move(test_env_token)),
+        options_(std::move(options)) {}
 
   void operator()(benchmark::State &state) const noexcept {
-    RunBenchmarkBody(task_getter_, input_data_, test_env_token_, state);
+    RunBenchmarkBody(task_getter_, inputs_, test_env_token_, options_, state);
   }
 
  private:
   TaskGetter task_getter_;
-  InType input_data_;
+  SizedInputs<InType> inputs_;
   std::string test_env_token_;
+  BenchmarkOptions options_;
 };
 
 }  // namespace detail
 
 template <typename InType, typename OutType>
-using PerfTestParam = std::tuple<std::function<ppc::task::TaskPtr<InType, OutType>(InType)>, std::string,
-                                 ppc::task::TaskCategory, ppc::task::TaskDescriptor>;
+using PerfTestParam =
+    std::tuple<std::function<ppc::task::TaskPtr<InType, OutType>(ppc::task::SharedInput<InType>)>, std::string,
+               ppc::task::TaskCategory, ppc::task::TaskDescriptor>;
 
 template <typename InType, typename OutType>
 /// @brief Base class for performance testing of parallel tasks.
@@ -188,6 +1439,33 @@ class BaseRunPerfTests : public ::testing::TestWithParam<PerfTestParam<InType, O
   /// @brief Supplies input data for performance testing.
   virtual InType GetTestInputData() = 0;
 
+  /// @brief Declares problem sizes to benchmark the task at, e.g. benchmark::CreateRange(1 << 10, 1 << 20, 8).
+  /// @details Every benchmark is then also registered once per size with a "size" argument, and its input comes
+  /// from GetTestInputDataForSize(). Only the GetTestInputData() input is checked by CheckTestOutputData().
+  /// @return Sizes in registration order; empty (the default) keeps the single GetTestInputData() input.
+  virtual std::vector<int64_t> GetTestSizes() {
+    return {};
+  }
+
+  /// @brief Returns the size calibration starts from when PerfAttr::calibration_time is set; 0 (the default)
+  /// opts the test out of calibration.
+  /// @details The calibrated input comes from GetTestInputDataForSize() and replaces GetTestInputData() in the
+  /// regular benchmarks of every implementation; it is not checked by CheckTestOutputData().
+  virtual int64_t GetCalibrationStartSize() {
+    return 0;
+  }
+
+  /// @brief Supplies the input for one problem size; required by GetTestSizes() and GetCalibrationStartSize().
+  virtual InType GetTestInputDataForSize(int64_t /*size*/) {
+    throw std::runtime_error("GetTestSizes() is overridden but GetTestInputDataForSize() is not");
+  }
+
+  /// @brief Declares the work one Run() does on an input so rates such as GB/s and GFLOP/s are reported next to
+  /// the time; called for every benchmarked input. The default declares none.
+  virtual WorkMetrics GetWorkMetrics(const InType & /*input*/) {
+    return {};
+  }
+
   virtual void SetPerfAttributes(PerfAttr &perf_attrs) {
     perf_attrs.current_timer = detail::MakeTechnologyTimer(task_->GetDynamicTypeOfTask());
   }
@@ -207,39 +1485,195 @@ class BaseRunPerfTests : public ::testing::TestWithParam<PerfTestParam<InType, O
     const auto test_env_token = ppc::util::test::MakeCurrentGTestToken(descriptor.display_name);
     const auto test_env_scope = ppc::util::test::ScopedPerTestEnv(test_env_token);
 
-    const auto input_data = GetTestInputData();
+    // One immutable input per test, shared by the validation task and every benchmark iteration.
+    const auto input_data = std::make_shared<const InType>(GetTestInputData());
     task_ = task_getter(input_data);
     task_->GetStateOfTesting() = ppc::task::StateOfTesting::kPerf;
     SynchronizeMpiRanks();
     detail::RunTaskForValidation(task_);
 
-    OutType output_data = task_->GetOutput();
-    ASSERT_TRUE(CheckTestOutputData(output_data));
+    ASSERT_TRUE(CheckTestOutputData(task_->GetOutput()));
 
     PerfAttr perf_attr;
     SetPerfAttributes(perf_attr);
     const auto num_iterations = perf_attr.num_running == 0 ? 1 : perf_attr.num_running;
+    const detail::SamplingOptions sampling{.warmup_runs = perf_attr.warmup_running,
+                                           .min_samples = num_iterations,
+                                           .max_samples = std::max(perf_attr.max_running, num_iterations),
+                                           .target_cv = perf_attr.target_cv,
+                                           .target_ci = perf_attr.target_ci};
 
-    using BenchmarkInputType = std::decay_t<decltype(input_data)>;
-    auto benchmark_body =
-        detail::BenchmarkTaskBody<decltype(task_getter), BenchmarkInputType>(task_getter, input_data, test_env_token);
+    // Sized benchmarks are registered next to the regular one, which keeps the checked GetTestInputData() input.
+    const auto sizes = GetTestSizes();
+    const auto make_input = [this](ppc::task::SharedInput<InType> input,
+                                   int64_t problem_size) -> detail::SizedInput<InType> {
+      const auto work = GetWorkMetrics(*input);
+      return {.input = std::move(input), .problem_size = problem_size, .work = work};
+    };
+    detail::SizedInputs<InType> default_inputs{{0, make_input(input_data, 0)}};
+    if (perf_attr.calibration_time > 0.0 && GetCalibrationStartSize() > 0) {
+      const int64_t calibrated_size = CalibrateInputSize(descriptor, task_getter, perf_attr);
+      default_inputs[0] =
+          make_input(std::make_shared<const InType>(GetTestInputDataForSize(calibrated_size)), calibrated_size);
+    }
+    // Inputs are generated once per scale: without weak scaling every sweep point shares the regular ones.
+    std::map<int64_t, detail::SizedInputs<InType>> inputs_by_scale;
+    const auto make_sized_inputs = [&](int num_threads) -> const detail::SizedInputs<InType> & {
+      const int64_t scale = perf_attr.weak_scaling ? detail::CountWorkers(descriptor.type, num_threads) : 1;
+      auto [entry, inserted] = inputs_by_scale.try_emplace(scale);
+      if (inserted) {
+        for (const int64_t size : sizes) {
+          entry->second[size] =
+              make_input(std::make_shared<const InType>(GetTestInputDataForSize(size * scale)), size * scale);
+        }
+      }
+      return entry->second;
+    };
+    const auto &sized_inputs = make_sized_inputs(GetNumThreads());
+    std::map<int, detail::SizedInputs<InType>> sweep_sized_inputs;
+    if (IsThreadTaskType(descriptor.type)) {
+      for (const int num_threads : perf_attr.thread_counts) {
+        sweep_sized_inputs[num_threads] = make_sized_inputs(num_threads);
+      }
+    }
 
-    benchmark::RegisterBenchmark(descriptor.display_name, std::move(benchmark_body))
-        ->UseManualTime()
-        ->Unit(benchmark::kSecond)
-        ->Iterations(static_cast<std::int64_t>(num_iterations));
+    const auto register_benchmark = [task_getter, test_env_token, sampling, num_iterations, sizes](
+                                        const std::string &name, detail::BenchmarkOptions options,
+                                        detail::SizedInputs<InType> benchmark_inputs) -> void {
+      const bool sized = options.sized;
+      options.sampling.record_as = name;
+      auto *registered =
+          benchmark::RegisterBenchmark(name, detail::BenchmarkTaskBody<decltype(task_getter), InType>(
+                                                 task_getter, std::move(benchmark_inputs), test_env_token,
+                                                 std::move(options)))
+              ->UseManualTime()
+              ->Unit(benchmark::kSecond)
+              ->Iterations(sampling.IsAdaptive() ? 1 : static_cast<std::int64_t>(num_iterations));
+      if (sized) {
+        registered->ArgName("size");
+        for (const int64_t size : sizes) {
+          registered->Arg(size);
+        }
+      }
+    };
+    // Ceilings are measured once per backend configuration and only for tasks that declare their work.
+    const bool report_roofline = !perf_attr.roofline_cache.empty() && default_inputs.at(0).work.HasWork();
+    const auto roofline_at = [&](int num_threads) -> RooflineCeilings {
+      if (!report_roofline) {
+        return {};
+      }
+      const detail::ScopedThreadCount thread_count(num_threads);
+      return GetRoofline(descriptor.type, num_threads, perf_attr.roofline_cache);
+    };
+    const auto roofline = roofline_at(GetNumThreads());
+    std::map<int, RooflineCeilings> sweep_rooflines;
+    if (IsThreadTaskType(descriptor.type)) {
+      for (const int num_threads : perf_attr.thread_counts) {
+        sweep_rooflines[num_threads] = roofline_at(num_threads);
+      }
+    }
+    for (const PerfMode mode : perf_attr.modes) {
+      const detail::BenchmarkOptions options{.mode = mode,
+                                             .stream_length = perf_attr.stream_length,
+                                             .batch_size = perf_attr.batch_size,
+                                             .per_rank_times = perf_attr.per_rank_times,
+                                             .local_rank_counters = perf_attr.local_rank_counters,
+                                             .perf_counters = perf_attr.perf_counters,
+                                             .mpi_comm_report = perf_attr.mpi_comm_report,
+                                             .sampling = sampling,
+                                             .scaling_key = MakeScalingKey(descriptor),
+                                             .task_type = descriptor.type,
+                                             .num_threads = 0,
+                                             .sized = false,
+                                             .weak_scaling = perf_attr.weak_scaling,
+                                             .roofline = roofline};
+      auto sized_options = options;
+      sized_options.sized = true;
+      const std::string name = MakePerfBenchmarkName(descriptor.display_name, mode);
+      register_benchmark(name, options, default_inputs);
+      if (!sizes.empty()) {
+        register_benchmark(name, sized_options, sized_inputs);
+      }
+      if (!IsThreadTaskType(descriptor.type)) {
+        continue;
+      }
+      // Sweep points run after every regular benchmark, so the SEQ baseline is known whatever the test order.
+      for (const int num_threads : perf_attr.thread_counts) {
+        auto point = options;
+        auto sized_point = sized_options;
+        point.num_threads = num_threads;
+        sized_point.num_threads = num_threads;
+        point.roofline = sweep_rooflines.at(num_threads);
+        sized_point.roofline = point.roofline;
+        detail::DeferredBenchmarkRegistrations().emplace_back(
+            [register_benchmark, point_name = MakeThreadSweepBenchmarkName(descriptor.display_name, mode, num_threads),
+             point, sized_point, default_inputs, point_inputs = sweep_sized_inputs.at(num_threads)]() -> void {
+              register_benchmark(point_name, point, default_inputs);
+              if (!point_inputs.empty()) {
+                register_benchmark(point_name, sized_point, point_inputs);
+              }
+            });
+      }
+    }
   }
 
  private:
+  /// Picks the input size for the regular benchmarks: the size already chosen for another implementation of the
+  /// task, the cached size, or a new calibration of the SEQ implementation (this one if none is registered).
+  int64_t CalibrateInputSize(const ppc::task::TaskDescriptor &descriptor,
+                             const detail::TaskGetterFunction<InType, OutType> &task_getter,
+                             const PerfAttr &perf_attr) {
+    const auto key = MakeScalingKey(descriptor);
+    auto &calibrated = detail::CalibratedSizes();
+    if (const auto known = calibrated.find(key); known != calibrated.end()) {
+      return known->second;
+    }
+    const double target_time = std::min(perf_attr.calibration_time, GetPerfMaxTime() / 2.0);
+    const bool use_cache = !perf_attr.calibration_cache.empty();
+    int64_t size = 0;
+    if (use_cache && GetMPIRank() == 0) {
+      size = LoadCalibratedSize(perf_attr.calibration_cache, key, target_time).value_or(0);
+    }
+    size = detail::BroadcastFromRootRank(size);
+    if (size == 0) {
+      const auto &seq_getters = detail::SeqTaskGetters<InType, OutType>();
+      const auto seq_getter = seq_getters.find(key);
+      const auto &getter = seq_getter != seq_getters.end() ? seq_getter->second : task_getter;
+      size = CalibrateSize(GetCalibrationStartSize(), target_time, [&](int64_t candidate) -> double {
+        return detail::TimeCalibrationRun(getter(std::make_shared<const InType>(GetTestInputDataForSize(candidate))));
+      });
+      if (use_cache && GetMPIRank() == 0) {
+        StoreCalibratedSize(perf_attr.calibration_cache, key, target_time, size);
+      }
+    }
+    calibrated[key] = size;
+    return size;
+  }
+
   ppc::task::TaskPtr<InType, OutType> task_{};
 };
 
+/// @brief Registers the benchmarks postponed by the performance tests, i.e. the thread-count sweep points.
+/// @details Called by the performance runner after the tests have run and before the benchmarks start.
+inline void RegisterDeferredBenchmarks() {
+  auto &registrations = detail::DeferredBenchmarkRegistrations();
+  for (const auto &registration : registrations) {
+    registration();
+  }
+  registrations.clear();
+}
+
 template <typename TaskType, typename InputType>
 auto MakePerfTaskTuples(const std::string &settings_path, std::string_view settings_task_path = {}) {
   const auto descriptor =
       MakeTaskDescriptor(GetNamespace<TaskType>(), TaskType::GetStaticTypeOfTask(), settings_path, settings_task_path);
+  if constexpr (TaskType::GetStaticTypeOfTask() == ppc::task::TypeOfTask::kSEQ) {
+    using OutputType = std::remove_cvref_t<decltype(std::declval<TaskType &>().GetOutput())>;
+    detail::SeqTaskGetters<InputType, OutputType>()[MakeScalingKey(descriptor)] =
+        ppc::task::SharedTaskGetter<TaskType, InputType>;
+  }
 
-  return std::make_tuple(std::make_tuple(ppc::task::TaskGetter<TaskType, InputType>, descriptor.display_name,
+  return std::make_tuple(std::make_tuple(ppc::task::SharedTaskGetter<TaskType, InputType>, descriptor.display_name,
                                          descriptor.category, descriptor));
 }
 
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <string>
+
+#include "task/include/task.hpp"
+
+namespace ppc::util {
+
+/// @brief Memory and compute ceilings of one backend configuration.
+struct RooflineCeilings {
+  /// @brief STREAM copy bandwidth in bytes per second.
+  double copy = 0.0;
+  /// @brief STREAM scale bandwidth in bytes per second.
+  double scale = 0.0;
+  /// @brief STREAM add bandwidth in bytes per second.
+  double add = 0.0;
+  /// @brief STREAM triad bandwidth in bytes per second; the memory roof.
+  double triad = 0.0;
+  /// @brief Floating-point operations per second of the multiply-add kernel; the compute roof.
+  double flops = 0.0;
+
+  /// @brief Returns true when both roofs were measured.
+  [[nodiscard]] bool IsKnown() const {
+    return triad > 0.0 && flops > 0.0;
+  }
+
+  /// @brief Returns the attainable FLOP rate at an arithmetic intensity (FLOPs per byte).
+  [[nodiscard]] double Attainable(double intensity) const {
+    return std::min(flops, intensity * triad);
+  }
+};
+
+/// @brief Measures the STREAM copy/scale/add/triad bandwidths and the multiply-add FLOP rate of a backend.
+/// @details SEQ runs the kernels on one thread; OMP, TBB and STL split them across num_threads workers of that
+/// backend. MPI runs the SEQ kernels and ALL the OMP kernels on every rank at once and reports the sum over the
+/// ranks, timed by the slowest one, so both must be called on every rank. The FLOP kernel is compiled with the
+/// project flags, so its rate is the ceiling for portable code rather than the hardware datasheet peak.
+/// Each kernel reports its best of several runs.
+RooflineCeilings MeasureRoofline(ppc::task::TypeOfTask backend, int num_threads);
+
+/// @brief Returns the cache key of a backend configuration: host, backend, thread count and rank count.
+/// @details The thread count is 1 for SEQ and MPI and the rank count is 1 for backends without MPI, so the key
+/// only changes with settings that affect the ceilings.
+std::string MakeRooflineKey(ppc::task::TypeOfTask backend, int num_threads);
+
+/// @brief Reads ceilings stored by StoreRoofline().
+/// @return The ceilings, or std::nullopt if the file or the key is missing.
+std::optional<RooflineCeilings> LoadRoofline(const std::string &cache_path, const std::string &key);
+
+/// @brief Stores ceilings in a JSON cache file, keeping the entries of other keys.
+/// @throws std::runtime_error If the file cannot be written.
+void StoreRoofline(const std::string &cache_path, const std::string &key, const RooflineCeilings &ceilings);
+
+/// @brief Returns the ceilings of a backend configuration, measuring and caching them on first use.
+/// @details Must be called on every rank. Rank 0 reads the cache and stores new measurements; the kernels run on
+/// every rank for MPI and ALL and on rank 0 otherwise, and the result is shared with all ranks. Results are also
+/// kept for the rest of the process.
+/// @param cache_path JSON cache file; empty measures without caching on disk.
+RooflineCeilings GetRoofline(ppc::task::TypeOfTask backend, int num_threads, const std::string &cache_path);
+
+}  // namespace ppc::util
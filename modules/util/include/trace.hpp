@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ppc::util {
+
+/// @brief True when the project is built with PPC_ENABLE_TRACING, i.e. when the PPC_TRACE_* macros record events.
+#ifdef PPC_ENABLE_TRACING
+inline constexpr bool kTracingEnabled = true;
+#else
+inline constexpr bool kTracingEnabled = false;
+#endif
+
+/// @brief One completed traced scope.
+struct TraceEvent {
+  /// Name shown on the timeline; must outlive the trace (string literals do)
+  const char *name = nullptr;
+  /// Category used for filtering in the trace viewer, such as "task" or "mpi"
+  const char *category = nullptr;
+  /// Begin and end in nanoseconds of GetTraceClock()
+  int64_t begin_ns = 0;
+  int64_t end_ns = 0;
+};
+
+/// @brief Events recorded by one thread.
+struct ThreadTraceEvents {
+  /// Index of the thread's buffer; becomes the thread id on the timeline
+  int thread = 0;
+  /// Events in the order their scopes ended
+  std::vector<TraceEvent> events;
+  /// Oldest events overwritten because the ring buffer was full
+  uint64_t dropped = 0;
+};
+
+/// @brief Returns the trace clock: steady-clock nanoseconds since the first call in this process.
+int64_t GetTraceClock();
+
+/// @brief Appends an event to the calling thread's ring buffer.
+/// @details Each thread writes only its own fixed-size buffer, so recording takes no lock; the buffer is registered
+/// once per thread and handed on to the next new thread when its thread exits. When a buffer is full the oldest
+/// events are overwritten.
+void RecordTraceEvent(const TraceEvent &event);
+
+/// @brief Returns the events of every thread buffer, oldest first.
+/// @note Call only while no traced scope is running, e.g. between tests.
+std::vector<ThreadTraceEvents> CollectTraceEvents();
+
+/// @brief Discards all recorded events. Same restriction as CollectTraceEvents().
+void ClearTraceEvents();
+
+/// @brief Formats the events of one rank as Chrome trace event objects (pid: rank, tid: thread, times in us).
+/// @param offset_ns Clock offset of the rank to rank 0, subtracted from every timestamp.
+/// @return JSON array text, including the process and thread name metadata events.
+std::string FormatChromeTraceEvents(const std::vector<ThreadTraceEvents> &threads, int rank, int64_t offset_ns);
+
+/// @brief Writes the events of all ranks as one Chrome trace JSON file (chrome://tracing, ui.perfetto.dev) and
+/// clears them.
+/// @details Must be called on every rank when MPI is active. Rank 0 estimates each rank's clock offset from the
+/// fastest of several ping-pong exchanges, the ranks send their shifted events to rank 0, and rank 0 writes the
+/// file, so all ranks and threads share one timeline.
+/// @throws std::runtime_error On rank 0 if the file cannot be written.
+void WriteTrace(const std::string &path);
+
+/// @brief Writes the trace of the current test to a file in PPC_TEST_TMPDIR; does nothing when the variable is unset
+/// or tracing is compiled out. Same calling rules as WriteTrace().
+void WriteTestTrace(const std::string &file_name);
+
+/// @brief Records one TraceEvent spanning its own lifetime. Used through PPC_TRACE_SCOPE.
+class TraceScope {
+ public:
+  TraceScope(const char *name, const char *category) : name_(name), category_(category), begin_(GetTraceClock()) {}
+  TraceScope(const TraceScope &) = delete;
+  TraceScope(TraceScope &&) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+  TraceScope &operator=(TraceScope &&) = delete;
+  ~TraceScope() {
+    RecordTraceEvent({.name = name_, .category = category_, .begin_ns = begin_, .end_ns = GetTraceClock()});
+  }
+
+ private:
+  const char *name_;
+  const char *category_;
+  int64_t begin_;
+};
+
+}  // namespace ppc::util
+
+// NOLINTBEGIN(cppcoreguidelines-macro-usage)
+#define PPC_TRACE_CONCAT_IMPL(a, b) a##b
+#define PPC_TRACE_CONCAT(a, b) PPC_TRACE_CONCAT_IMPL(a, b)
+
+/// @brief Traces the enclosing scope under a string-literal name and category. Compiles to nothing unless the
+/// project is built with PPC_ENABLE_TRACING.
+#ifdef PPC_ENABLE_TRACING
+#define PPC_TRACE_SCOPE_CATEGORY(name, category) \
+  const ::ppc::util::TraceScope PPC_TRACE_CONCAT(ppc_trace_scope_, __LINE__)(name, category)
+#else
+#define PPC_TRACE_SCOPE_CATEGORY(name, category) static_cast<void>(0)
+#endif
+
+/// @brief Traces the enclosing scope under a string-literal name in the "user" category.
+#define PPC_TRACE_SCOPE(name) PPC_TRACE_SCOPE_CATEGORY(name, "user")
+// NOLINTEND(cppcoreguidelines-macro-usage)
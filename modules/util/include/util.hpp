@@ -96,11 +96,16 @@ double GetTaskMaxTime();
 double GetPerfMaxTime();
 double GetTimeMPI();
 int GetMPIRank();
+bool IsMpiActive();
 void ConfigureMpiEnvironment();
 void SynchronizeMpiRanks();
 
 template <typename T>
 std::string GetNamespace() {
+  // Adapters (e.g. ppc::task::StaticTaskAdapter) are named after the task they wrap.
+  if constexpr (requires { typename T::WrappedTask; }) {
+    return GetNamespace<typename T::WrappedTask>();
+  }
   std::string name = typeid(T).name();
 #ifdef __GNUC__
   int status = 0;
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <stop_token>
+#include <string_view>
+#include <thread>
+
+namespace ppc::util {
+
+/// @brief Enforces time budgets on running pipeline stages from one persistent background thread.
+/// @details When a watched budget expires, the watchdog requests a stop on the source passed to Start() so
+/// cooperative code can bail out. If the stage is still running after a grace period, it reports the
+/// stage and MPI rank and aborts the whole job, so no rank is left hanging. The job is aborted with MPI_Abort only
+/// when MPI provides at least MPI_THREAD_SERIALIZED, because the call comes from the watchdog thread; otherwise the
+/// process exits with std::_Exit and mpirun tears down the remaining ranks.
+/// Owners such as tasks register once, which is where the environment and the MPI state are read; watching a
+/// stage then only stores its deadline, and wakes the thread only if that deadline comes before its next check.
+/// Registration is a no-op when PPC_IGNORE_TEST_TIME_LIMIT is set to a non-zero value.
+class Watchdog {
+ public:
+  using Clock = std::chrono::steady_clock;
+  /// @brief Identifies a registered owner.
+  using Handle = std::uint64_t;
+
+  /// @brief Shortest time a stage gets to react to a stop request before the job is aborted.
+  static constexpr std::chrono::seconds kMinGracePeriod{5};
+
+  Watchdog() = default;
+  Watchdog(const Watchdog &) = delete;
+  Watchdog(Watchdog &&) = delete;
+  Watchdog &operator=(const Watchdog &) = delete;
+  Watchdog &operator=(Watchdog &&) = delete;
+  /// @brief Stops and joins the watchdog thread.
+  ~Watchdog();
+
+  /// @brief Returns the process-wide watchdog.
+  static Watchdog &Instance();
+
+  /// @brief Registers an owner whose stages are watched one at a time.
+  /// @return Handle to pass to Start(), Stop() and Unregister(), or 0 when the time limit is ignored.
+  Handle Register();
+
+  /// @brief Removes an owner registered by Register(). Handle 0 is ignored.
+  void Unregister(Handle handle);
+
+  /// @brief Starts watching a stage of a registered owner. Handle 0 is ignored.
+  /// @param owner Owner label used in the timeout report, e.g. "seq".
+  /// @param stage Stage label used in the timeout report.
+  /// @param budget_seconds Allowed stage duration; the grace period is max(kMinGracePeriod, budget).
+  /// @param stop_source Receives the stop request on expiry.
+  /// @note Both labels must stay valid until Stop(); string literals are the intended use.
+  void Start(Handle handle, std::string_view owner, std::string_view stage, double budget_seconds,
+             const std::stop_source &stop_source);
+
+  /// @brief Stops watching the current stage of a registered owner. Handle 0 is ignored.
+  void Stop(Handle handle);
+
+ private:
+  struct Entry {
+    std::string_view owner{};
+    std::string_view stage{};
+    int rank = 0;
+    /// Whether MPI allows the watchdog thread to call MPI_Abort
+    bool mpi_abort = false;
+    double budget_seconds = 0.0;
+    Clock::time_point deadline = Clock::time_point::max();
+    Clock::time_point abort_deadline = Clock::time_point::max();
+    std::stop_source stop_source{std::nostopstate};
+    bool expired = false;
+  };
+
+  void EnsureThreadStarted();
+  void ThreadLoop(const std::stop_token &thread_stop);
+  [[nodiscard]] Clock::time_point NextWakeUp() const;
+  void CheckDeadlines(Clock::time_point now);
+
+  std::mutex mutex_;
+  std::condition_variable_any changed_;
+  std::map<Handle, Entry> entries_;
+  Handle next_handle_ = 1;
+  /// Time the thread will next check the deadlines
+  Clock::time_point wake_up_ = Clock::time_point::max();
+  bool replan_ = false;
+  std::jthread thread_;
+};
+
+/// @brief Keeps an owner registered with the process-wide watchdog for its lifetime.
+class WatchdogSlot {
+ public:
+  WatchdogSlot() : handle_(Watchdog::Instance().Register()) {}
+  WatchdogSlot(const WatchdogSlot &) = delete;
+  WatchdogSlot(WatchdogSlot &&) = delete;
+  WatchdogSlot &operator=(const WatchdogSlot &) = delete;
+  WatchdogSlot &operator=(WatchdogSlot &&) = delete;
+  ~WatchdogSlot() {
+    Watchdog::Instance().Unregister(handle_);
+  }
+
+  /// @brief Returns false when the time limit is ignored and stages of this owner are not watched.
+  [[nodiscard]] bool IsActive() const {
+    return handle_ != 0;
+  }
+
+  [[nodiscard]] Watchdog::Handle GetHandle() const {
+    return handle_;
+  }
+
+ private:
+  Watchdog::Handle handle_;
+};
+
+/// @brief Watches one stage of a registered owner for the lifetime of the scope.
+class WatchdogScope {
+ public:
+  /// @param slot Registration of the owner running the stage.
+  /// @param owner Owner label used in the timeout report.
+  /// @param stage Stage label used in the timeout report.
+  /// @param budget_seconds Allowed stage duration in seconds.
+  /// @param stop_source Receives the stop request on expiry.
+  WatchdogScope(const WatchdogSlot &slot, std::string_view owner, std::string_view stage, double budget_seconds,
+                const std::stop_source &stop_source)
+      : handle_(slot.GetHandle()) {
+    Watchdog::Instance().Start(handle_, owner, stage, budget_seconds, stop_source);
+  }
+  WatchdogScope(const WatchdogScope &) = delete;
+  WatchdogScope(WatchdogScope &&) = delete;
+  WatchdogScope &operator=(const WatchdogScope &) = delete;
+  WatchdogScope &operator=(WatchdogScope &&) = delete;
+  ~WatchdogScope() {
+    Watchdog::Instance().Stop(handle_);
+  }
+
+ private:
+  Watchdog::Handle handle_;
+};
+
+}  // namespace ppc::util
@@ -0,0 +1,386 @@
+#include "util/include/alloc_tracker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "util/include/util.hpp"
+
+#ifdef PPC_ENABLE_ALLOC_TRACKING
+#  if defined(_WIN32)
+#    include <malloc.h>
+#  elif defined(__APPLE__)
+#    include <malloc/malloc.h>
+#  else
+#    include <malloc.h>
+#  endif
+#endif
+
+namespace {
+
+constexpr std::size_t kMaxThreadSlots = ppc::util::AllocationMeasurement::kMaxThreadSlots;
+constexpr int kMaxPeakTrackers = ppc::util::AllocationMeasurement::kMaxPeakTrackers;
+
+using PeakTrackers = std::array<std::atomic<int64_t>, kMaxPeakTrackers>;
+
+struct alignas(64) ThreadSlot {
+  std::atomic<bool> in_use{false};
+  std::atomic<uint64_t> allocations{0};
+  std::atomic<uint64_t> bytes{0};
+  /// Bytes allocated by this thread minus the bytes it freed; may go negative when other threads free its memory
+  std::atomic<int64_t> live{0};
+  /// High-water marks of live, one per running measurement
+  PeakTrackers peaks{};
+};
+
+struct AllocationCounters {
+  std::array<ThreadSlot, kMaxThreadSlots> slots;
+  /// One past the highest slot index ever handed to a thread
+  std::atomic<std::size_t> slots_used{0};
+  std::atomic<int64_t> live{0};
+  PeakTrackers peaks{};
+  /// Bit i is set while a measurement owns peak tracker i
+  std::atomic<uint32_t> trackers_claimed{0};
+  /// Bit i is set once the owner of tracker i has initialized it; allocations only raise these trackers
+  std::atomic<uint32_t> trackers_active{0};
+};
+
+static_assert(kMaxPeakTrackers <= 32, "Peak trackers are claimed through a 32-bit mask");
+
+// Only atomics, so the counters are constant-initialized and usable by allocations made before main().
+AllocationCounters &Counters() {
+  static AllocationCounters counters;
+  return counters;
+}
+
+/// Calls visit(index) for every slot a thread may have counted into: the ones handed out so far and the shared one.
+template <typename Visit>
+void ForEachUsedSlot(Visit visit) {
+  const std::size_t used = std::min(Counters().slots_used.load(std::memory_order_acquire), kMaxThreadSlots - 1);
+  for (std::size_t i = 0; i < used; ++i) {
+    visit(i);
+  }
+  visit(kMaxThreadSlots - 1);
+}
+
+int ClaimPeakTracker() {
+  auto &claimed = Counters().trackers_claimed;
+  uint32_t current = claimed.load(std::memory_order_relaxed);
+  for (int tracker = std::countr_one(current); tracker < kMaxPeakTrackers; tracker = std::countr_one(current)) {
+    if (claimed.compare_exchange_weak(current, current | (1U << tracker), std::memory_order_acq_rel)) {
+      return tracker;
+    }
+  }
+  return -1;
+}
+
+#ifdef PPC_ENABLE_ALLOC_TRACKING
+
+void RaisePeak(std::atomic<int64_t> &peak, int64_t value) {
+  int64_t current = peak.load(std::memory_order_relaxed);
+  while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+/// Owns the calling thread's slot for the lifetime of the thread; acquiring one never allocates.
+class SlotHolder {
+ public:
+  SlotHolder() = default;
+  SlotHolder(const SlotHolder &) = delete;
+  SlotHolder(SlotHolder &&) = delete;
+  SlotHolder &operator=(const SlotHolder &) = delete;
+  SlotHolder &operator=(SlotHolder &&) = delete;
+  ~SlotHolder() {
+    if (slot_ != nullptr && slot_ != &Counters().slots.back()) {
+      slot_->in_use.store(false, std::memory_order_release);
+    }
+    // Allocations made by later thread-exit code go to the shared slot.
+    slot_ = &Counters().slots.back();
+  }
+
+  ThreadSlot &Get() {
+    if (slot_ == nullptr) {
+      slot_ = &Counters().slots.back();
+      for (std::size_t i = 0; i + 1 < kMaxThreadSlots; ++i) {
+        auto &slot = Counters().slots.at(i);
+        bool expected = false;
+        if (slot.in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+          slot_ = &slot;
+          auto &used = Counters().slots_used;
+          std::size_t current = used.load(std::memory_order_relaxed);
+          while (current < i + 1 && !used.compare_exchange_weak(current, i + 1, std::memory_order_release)) {
+          }
+          break;
+        }
+      }
+    }
+    return *slot_;
+  }
+
+ private:
+  ThreadSlot *slot_ = nullptr;
+};
+
+ThreadSlot &CurrentSlot() {
+  thread_local SlotHolder holder;
+  return holder.Get();
+}
+
+std::size_t UsableSize(void *ptr, std::size_t alignment) {
+#  if defined(_WIN32)
+  return alignment > alignof(std::max_align_t) ? _aligned_msize(ptr, alignment, 0) : _msize(ptr);
+#  elif defined(__APPLE__)
+  static_cast<void>(alignment);
+  return malloc_size(ptr);
+#  else
+  static_cast<void>(alignment);
+  return malloc_usable_size(ptr);
+#  endif
+}
+
+void RecordAllocation(void *ptr, std::size_t alignment) {
+  const auto size = static_cast<int64_t>(UsableSize(ptr, alignment));
+  auto &slot = CurrentSlot();
+  slot.allocations.fetch_add(1, std::memory_order_relaxed);
+  slot.bytes.fetch_add(static_cast<uint64_t>(size), std::memory_order_relaxed);
+  const int64_t slot_live = slot.live.fetch_add(size, std::memory_order_relaxed) + size;
+  auto &counters = Counters();
+  const int64_t live = counters.live.fetch_add(size, std::memory_order_relaxed) + size;
+  for (uint32_t active = counters.trackers_active.load(std::memory_order_acquire); active != 0;
+       active &= active - 1) {
+    const auto tracker = static_cast<std::size_t>(std::countr_zero(active));
+    RaisePeak(slot.peaks.at(tracker), slot_live);
+    RaisePeak(counters.peaks.at(tracker), live);
+  }
+}
+
+void RecordDeallocation(void *ptr, std::size_t alignment) {
+  const auto size = static_cast<int64_t>(UsableSize(ptr, alignment));
+  CurrentSlot().live.fetch_sub(size, std::memory_order_relaxed);
+  Counters().live.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void *Allocate(std::size_t size, std::size_t alignment) {
+  size = std::max<std::size_t>(size, 1);
+  void *ptr = nullptr;
+  if (alignment <= alignof(std::max_align_t)) {
+    ptr = std::malloc(size);  // NOLINT(cppcoreguidelines-no-malloc)
+  } else {
+#  if defined(_WIN32)
+    ptr = _aligned_malloc(size, alignment);
+#  else
+    if (posix_memalign(&ptr, alignment, size) != 0) {
+      ptr = nullptr;
+    }
+#  endif
+  }
+  if (ptr != nullptr) {
+    RecordAllocation(ptr, alignment);
+  }
+  return ptr;
+}
+
+void *AllocateOrThrow(std::size_t size, std::size_t alignment) {
+  void *ptr = Allocate(size, alignment);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void Deallocate(void *ptr, std::size_t alignment) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  RecordDeallocation(ptr, alignment);
+#  if defined(_WIN32)
+  if (alignment > alignof(std::max_align_t)) {
+    _aligned_free(ptr);
+    return;
+  }
+#  endif
+  std::free(ptr);  // NOLINT(cppcoreguidelines-no-malloc)
+}
+
+#endif
+
+}  // namespace
+
+#ifdef PPC_ENABLE_ALLOC_TRACKING
+
+// Replacements of the global allocation functions; every other operator new and delete forwards to these.
+// NOLINTBEGIN(misc-new-delete-overloads,cert-dcl54-cpp,hicpp-new-delete-operators)
+void *operator new(std::size_t size) {
+  return AllocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void *operator new[](std::size_t size) {
+  return AllocateOrThrow(size, alignof(std::max_align_t));
+}
+
+void *operator new(std::size_t size, const std::nothrow_t & /*tag*/) noexcept {
+  return Allocate(size, alignof(std::max_align_t));
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t & /*tag*/) noexcept {
+  return Allocate(size, alignof(std::max_align_t));
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  return AllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+  return AllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t & /*tag*/) noexcept {
+  return Allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t & /*tag*/) noexcept {
+  return Allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *ptr) noexcept {
+  Deallocate(ptr, alignof(std::max_align_t));
+}
+
+void operator delete[](void *ptr) noexcept {
+  Deallocate(ptr, alignof(std::max_align_t));
+}
+
+void operator delete(void *ptr, std::size_t /*size*/) noexcept {
+  Deallocate(ptr, alignof(std::max_align_t));
+}
+
+void operator delete[](void *ptr, std::size_t /*size*/) noexcept {
+  Deallocate(ptr, alignof(std::max_align_t));
+}
+
+void operator delete(void *ptr, const std::nothrow_t & /*tag*/) noexcept {
+  Deallocate(ptr, alignof(std::max_align_t));
+}
+
+void operator delete[](void *ptr, const std::nothrow_t & /*tag*/) noexcept {
+  Deallocate(ptr, alignof(std::max_align_t));
+}
+
+void operator delete(void *ptr, std::align_val_t alignment) noexcept {
+  Deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void *ptr, std::align_val_t alignment) noexcept {
+  Deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *ptr, std::size_t /*size*/, std::align_val_t alignment) noexcept {
+  Deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void *ptr, std::size_t /*size*/, std::align_val_t alignment) noexcept {
+  Deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *ptr, std::align_val_t alignment, const std::nothrow_t & /*tag*/) noexcept {
+  Deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void *ptr, std::align_val_t alignment, const std::nothrow_t & /*tag*/) noexcept {
+  Deallocate(ptr, static_cast<std::size_t>(alignment));
+}
+// NOLINTEND(misc-new-delete-overloads,cert-dcl54-cpp,hicpp-new-delete-operators)
+
+#endif
+
+ppc::util::AllocationMeasurement::AllocationMeasurement() : tracker_(ClaimPeakTracker()) {
+  auto &counters = Counters();
+  const auto tracker = static_cast<std::size_t>(tracker_);
+  ForEachUsedSlot([&](std::size_t i) -> void {
+    auto &slot = counters.slots.at(i);
+    auto &start = slots_.at(i);
+    start.allocations = slot.allocations.load(std::memory_order_relaxed);
+    start.bytes = slot.bytes.load(std::memory_order_relaxed);
+    start.live = slot.live.load(std::memory_order_relaxed);
+    if (tracker_ >= 0) {
+      slot.peaks.at(tracker).store(start.live, std::memory_order_relaxed);
+    }
+  });
+  live_ = counters.live.load(std::memory_order_relaxed);
+  if (tracker_ >= 0) {
+    counters.peaks.at(tracker).store(live_, std::memory_order_relaxed);
+    counters.trackers_active.fetch_or(1U << tracker_, std::memory_order_release);
+  }
+}
+
+ppc::util::AllocationMeasurement::~AllocationMeasurement() {
+  if (tracker_ < 0) {
+    return;
+  }
+  // The next owner resets the tracker of every slot in use; slots handed out later have never been raised.
+  auto &counters = Counters();
+  counters.trackers_active.fetch_and(~(1U << tracker_), std::memory_order_acq_rel);
+  counters.trackers_claimed.fetch_and(~(1U << tracker_), std::memory_order_release);
+}
+
+ppc::util::AllocationStats ppc::util::AllocationMeasurement::Stop() const {
+  auto &counters = Counters();
+  std::array<ThreadAllocationStats, kMaxThreadSlots> threads{};
+  const auto tracker = static_cast<std::size_t>(tracker_);
+  ForEachUsedSlot([&](std::size_t i) -> void {
+    const auto &slot = counters.slots.at(i);
+    const auto &start = slots_.at(i);
+    const int64_t live = slot.live.load(std::memory_order_relaxed);
+    const int64_t peak = tracker_ >= 0 ? slot.peaks.at(tracker).load(std::memory_order_relaxed) : live;
+    threads.at(i) = {.thread = static_cast<int>(i),
+                     .allocations = slot.allocations.load(std::memory_order_relaxed) - start.allocations,
+                     .bytes = slot.bytes.load(std::memory_order_relaxed) - start.bytes,
+                     .peak_live_bytes = static_cast<uint64_t>(std::max<int64_t>(peak - start.live, 0))};
+  });
+  const int64_t peak = tracker_ >= 0 ? counters.peaks.at(tracker).load(std::memory_order_relaxed)
+                                     : counters.live.load(std::memory_order_relaxed);
+
+  // Counters are read above, so building the result is not measured.
+  AllocationStats stats{.allocations = 0,
+                        .bytes = 0,
+                        .peak_live_bytes = static_cast<uint64_t>(std::max<int64_t>(peak - live_, 0)),
+                        .threads = {}};
+  for (const auto &thread : threads) {
+    if (thread.allocations == 0) {
+      continue;
+    }
+    stats.allocations += thread.allocations;
+    stats.bytes += thread.bytes;
+    stats.threads.push_back(thread);
+  }
+  return stats;
+}
+
+std::optional<uint64_t> ppc::util::GetRunAllocationBudget() {
+  const auto budget = env::get<int64_t>("PPC_RUN_ALLOC_BUDGET");
+  if (!budget.has_value() || budget.value() < 0) {
+    return std::nullopt;
+  }
+  return static_cast<uint64_t>(budget.value());
+}
+
+void ppc::util::CheckRunAllocationBudget(const AllocationStats &run, uint64_t runs) {
+  const auto budget = GetRunAllocationBudget();
+  if (!budget.has_value() || !kAllocTrackingEnabled) {
+    return;
+  }
+  const uint64_t per_run = run.allocations / std::max<uint64_t>(runs, 1);
+  if (per_run > budget.value()) {
+    throw std::runtime_error("Run() made " + std::to_string(per_run) + " heap allocations (" +
+                             std::to_string(run.bytes / std::max<uint64_t>(runs, 1)) +
+                             " bytes), more than PPC_RUN_ALLOC_BUDGET=" + std::to_string(budget.value()));
+  }
+}
@@ -0,0 +1,835 @@
+#include "util/include/mpi_profile.hpp"
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "util/include/util.hpp"
+
+namespace {
+
+constexpr double kNanosecondsPerSecond = 1e9;
+
+struct MpiCallCounters {
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<uint64_t> time_ns{0};
+};
+
+std::array<MpiCallCounters, ppc::util::kNumMpiCallKinds> &Counters() {
+  static std::array<MpiCallCounters, ppc::util::kNumMpiCallKinds> counters;
+  return counters;
+}
+
+struct PeerCounters {
+  std::atomic<uint64_t> messages{0};
+  std::atomic<uint64_t> bytes{0};
+};
+
+struct TrafficCounters {
+  std::array<PeerCounters, ppc::util::kMaxMpiPeers> peers;
+  std::array<std::array<std::atomic<uint64_t>, ppc::util::kNumMessageSizeClasses>, ppc::util::kNumMpiCallKinds>
+      message_sizes{};
+  /// Live MpiTrafficMeasurement and MpiTrafficScope objects; traffic is recorded while both are positive
+  std::atomic<int> measurements{0};
+  std::atomic<int> scopes{0};
+};
+
+TrafficCounters &Traffic() {
+  static TrafficCounters traffic;
+  return traffic;
+}
+
+bool IsTrafficRecorded() {
+  const auto &traffic = Traffic();
+  return traffic.measurements.load(std::memory_order_relaxed) > 0 && traffic.scopes.load(std::memory_order_relaxed) > 0;
+}
+
+int WorldSize() {
+  int size = 1;
+  if (ppc::util::IsMpiActive()) {
+    PMPI_Comm_size(MPI_COMM_WORLD, &size);
+  }
+  return size;
+}
+
+std::string FormatBytes(uint64_t bytes) {
+  constexpr std::array<const char *, 5> kUnits = {"B", "KiB", "MiB", "GiB", "TiB"};
+  constexpr double kStep = 1024.0;
+  auto value = static_cast<double>(bytes);
+  std::size_t unit = 0;
+  while (value >= kStep && unit + 1 < kUnits.size()) {
+    value /= kStep;
+    ++unit;
+  }
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(unit == 0 ? 0 : 1) << value << ' ' << kUnits.at(unit);
+  return out.str();
+}
+
+#ifdef PPC_ENABLE_MPI_PROFILING
+
+using ppc::util::MpiCallKind;
+
+/// Nesting depth of profiled calls on this thread; calls an MPI library makes to its own MPI_ functions are not
+/// counted twice.
+int &CallDepth() {
+  thread_local int depth = 0;
+  return depth;
+}
+
+/// Times one wrapped call and records it when it returns.
+class ProfiledCall {
+ public:
+  ProfiledCall(MpiCallKind kind, uint64_t bytes)
+      : kind_(kind), bytes_(bytes), outermost_(CallDepth()++ == 0), begin_(std::chrono::steady_clock::now()) {}
+  ProfiledCall(const ProfiledCall &) = delete;
+  ProfiledCall(ProfiledCall &&) = delete;
+  ProfiledCall &operator=(const ProfiledCall &) = delete;
+  ProfiledCall &operator=(ProfiledCall &&) = delete;
+  ~ProfiledCall() {
+    --CallDepth();
+    if (outermost_) {
+      ppc::util::RecordMpiCall(kind_, bytes_,
+                               std::chrono::duration<double>(std::chrono::steady_clock::now() - begin_).count());
+    }
+  }
+
+  void AddBytes(uint64_t bytes) {
+    bytes_ += bytes;
+  }
+
+ private:
+  MpiCallKind kind_;
+  uint64_t bytes_;
+  bool outermost_;
+  std::chrono::steady_clock::time_point begin_;
+};
+
+uint64_t TypeBytes(int count, MPI_Datatype type) {
+  if (count <= 0 || type == MPI_DATATYPE_NULL) {
+    return 0;
+  }
+  int size = 0;
+  PMPI_Type_size(type, &size);
+  return static_cast<uint64_t>(count) * static_cast<uint64_t>(size);
+}
+
+uint64_t SumTypeBytes(const int counts[], int n, MPI_Datatype type) {  // NOLINT(*-avoid-c-arrays)
+  uint64_t bytes = 0;
+  for (int i = 0; i < n; ++i) {
+    bytes += TypeBytes(counts[i], type);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  }
+  return bytes;
+}
+
+int CommRank(MPI_Comm comm) {
+  int rank = 0;
+  PMPI_Comm_rank(comm, &rank);
+  return rank;
+}
+
+int CommSize(MPI_Comm comm) {
+  int size = 1;
+  PMPI_Comm_size(comm, &size);
+  return size;
+}
+
+bool IsInPlace(const void *buffer) {
+  return buffer == MPI_IN_PLACE;
+}
+
+/// Bytes a receive actually got, taken from its status.
+uint64_t ReceivedBytes(const MPI_Status *status, MPI_Datatype type) {
+  int count = 0;
+  if (PMPI_Get_count(status, type, &count) != MPI_SUCCESS || count == MPI_UNDEFINED) {
+    return 0;
+  }
+  return TypeBytes(count, type);
+}
+
+uint64_t ReduceBytes(const void *sendbuf, int count, MPI_Datatype type, bool receives) {
+  return (IsInPlace(sendbuf) ? 0 : TypeBytes(count, type)) + (receives ? TypeBytes(count, type) : 0);
+}
+
+uint64_t GatherBytes(const void *sendbuf, int sendcount, MPI_Datatype sendtype, uint64_t receive_bytes) {
+  return (IsInPlace(sendbuf) ? 0 : TypeBytes(sendcount, sendtype)) + receive_bytes;
+}
+
+uint64_t ScatterBytes(uint64_t send_bytes, const void *recvbuf, int recvcount, MPI_Datatype recvtype) {
+  return send_bytes + (IsInPlace(recvbuf) ? 0 : TypeBytes(recvcount, recvtype));
+}
+
+bool RecordsTraffic() {
+  return IsTrafficRecorded() && CallDepth() == 0;
+}
+
+/// Ranks in MPI_COMM_WORLD of the ranks of comm; empty for intercommunicators.
+std::vector<int> WorldRanks(MPI_Comm comm) {
+  const int size = CommSize(comm);
+  std::vector<int> world_ranks(static_cast<std::size_t>(size));
+  std::iota(world_ranks.begin(), world_ranks.end(), 0);
+  if (comm == MPI_COMM_WORLD) {
+    return world_ranks;
+  }
+  int inter = 0;
+  PMPI_Comm_test_inter(comm, &inter);
+  if (inter != 0) {
+    return {};
+  }
+  const std::vector<int> ranks = world_ranks;
+  MPI_Group group = MPI_GROUP_NULL;
+  MPI_Group world = MPI_GROUP_NULL;
+  PMPI_Comm_group(comm, &group);
+  PMPI_Comm_group(MPI_COMM_WORLD, &world);
+  PMPI_Group_translate_ranks(group, size, ranks.data(), world, world_ranks.data());
+  PMPI_Group_free(&group);
+  PMPI_Group_free(&world);
+  return world_ranks;
+}
+
+/// Records one message to a rank of comm; MPI_PROC_NULL and the wildcards are negative and skipped.
+void RecordMessage(MPI_Comm comm, int peer, uint64_t bytes) {
+  if (!RecordsTraffic() || peer < 0) {
+    return;
+  }
+  const auto world_ranks = WorldRanks(comm);
+  if (static_cast<std::size_t>(peer) < world_ranks.size()) {
+    ppc::util::RecordMpiMessage(world_ranks[static_cast<std::size_t>(peer)], bytes);
+  }
+}
+
+/// Records one message to every other rank of comm that bytes_to(rank) gives a non-zero size.
+template <typename BytesTo>
+void RecordMessagesToPeers(MPI_Comm comm, const BytesTo &bytes_to) {
+  if (!RecordsTraffic()) {
+    return;
+  }
+  const int self = CommRank(comm);
+  const auto world_ranks = WorldRanks(comm);
+  for (std::size_t peer = 0; peer < world_ranks.size(); ++peer) {
+    const uint64_t bytes = bytes_to(static_cast<int>(peer));
+    if (static_cast<int>(peer) != self && bytes > 0) {
+      ppc::util::RecordMpiMessage(world_ranks[peer], bytes);
+    }
+  }
+}
+
+/// Records the same message size to every other rank of comm.
+void RecordMessagesToPeers(MPI_Comm comm, uint64_t bytes) {
+  RecordMessagesToPeers(comm, [bytes](int /*peer*/) -> uint64_t { return bytes; });
+}
+
+#endif
+
+}  // namespace
+
+void ppc::util::RecordMpiCall(MpiCallKind kind, uint64_t bytes, double seconds) {
+  auto &counters = Counters().at(static_cast<std::size_t>(kind));
+  counters.calls.fetch_add(1, std::memory_order_relaxed);
+  counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+  counters.time_ns.fetch_add(static_cast<uint64_t>(seconds * kNanosecondsPerSecond), std::memory_order_relaxed);
+  if (IsTrafficRecorded()) {
+    Traffic()
+        .message_sizes.at(static_cast<std::size_t>(kind))
+        .at(MessageSizeClass(bytes))
+        .fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+ppc::util::MpiProfile ppc::util::ReadMpiProfile() {
+  MpiProfile profile;
+  for (std::size_t i = 0; i < kNumMpiCallKinds; ++i) {
+    const auto &counters = Counters().at(i);
+    profile.kinds.at(i) = {
+        .calls = counters.calls.load(std::memory_order_relaxed),
+        .bytes = counters.bytes.load(std::memory_order_relaxed),
+        .time = static_cast<double>(counters.time_ns.load(std::memory_order_relaxed)) / kNanosecondsPerSecond};
+  }
+  return profile;
+}
+
+ppc::util::MpiProfile ppc::util::MpiProfileMeasurement::Stop() const {
+  auto profile = ReadMpiProfile();
+  for (std::size_t i = 0; i < kNumMpiCallKinds; ++i) {
+    profile.kinds.at(i).calls -= start_.kinds.at(i).calls;
+    profile.kinds.at(i).bytes -= start_.kinds.at(i).bytes;
+    profile.kinds.at(i).time -= start_.kinds.at(i).time;
+  }
+  return profile;
+}
+
+std::size_t ppc::util::MessageSizeClass(uint64_t bytes) {
+  return std::min<std::size_t>(static_cast<std::size_t>(std::bit_width(bytes)), kNumMessageSizeClasses - 1);
+}
+
+std::string ppc::util::MessageSizeClassLabel(std::size_t size_class) {
+  if (size_class == 0) {
+    return "0";
+  }
+  constexpr std::array<const char *, 4> kSuffixes = {"", "K", "M", "G"};
+  constexpr std::size_t kBitsPerSuffix = 10;
+  const std::size_t shift = size_class - 1;
+  const std::size_t suffix = std::min(shift / kBitsPerSuffix, kSuffixes.size() - 1);
+  return std::to_string(uint64_t{1} << (shift - (suffix * kBitsPerSuffix))) + kSuffixes.at(suffix);
+}
+
+void ppc::util::RecordMpiMessage(int world_rank, uint64_t bytes) {
+  if (world_rank < 0 || world_rank >= kMaxMpiPeers) {
+    return;
+  }
+  auto &peer = Traffic().peers.at(static_cast<std::size_t>(world_rank));
+  peer.messages.fetch_add(1, std::memory_order_relaxed);
+  peer.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+ppc::util::MpiTraffic ppc::util::ReadMpiTraffic() {
+  const auto ranks = static_cast<std::size_t>(std::min(WorldSize(), kMaxMpiPeers));
+  MpiTraffic traffic{.messages = std::vector<uint64_t>(ranks), .bytes = std::vector<uint64_t>(ranks)};
+  const auto &counters = Traffic();
+  for (std::size_t rank = 0; rank < ranks; ++rank) {
+    traffic.messages[rank] = counters.peers.at(rank).messages.load(std::memory_order_relaxed);
+    traffic.bytes[rank] = counters.peers.at(rank).bytes.load(std::memory_order_relaxed);
+  }
+  for (std::size_t kind = 0; kind < kNumMpiCallKinds; ++kind) {
+    for (std::size_t size_class = 0; size_class < kNumMessageSizeClasses; ++size_class) {
+      traffic.message_sizes.at(kind).at(size_class) =
+          counters.message_sizes.at(kind).at(size_class).load(std::memory_order_relaxed);
+    }
+  }
+  return traffic;
+}
+
+ppc::util::MpiTrafficMeasurement::MpiTrafficMeasurement() {
+  Traffic().measurements.fetch_add(1, std::memory_order_relaxed);
+  start_ = ReadMpiTraffic();
+}
+
+ppc::util::MpiTrafficMeasurement::~MpiTrafficMeasurement() {
+  Traffic().measurements.fetch_sub(1, std::memory_order_relaxed);
+}
+
+ppc::util::MpiTrafficScope::MpiTrafficScope() {
+  Traffic().scopes.fetch_add(1, std::memory_order_relaxed);
+}
+
+ppc::util::MpiTrafficScope::~MpiTrafficScope() {
+  Traffic().scopes.fetch_sub(1, std::memory_order_relaxed);
+}
+
+ppc::util::MpiTraffic ppc::util::MpiTrafficMeasurement::Stop() const {
+  auto traffic = ReadMpiTraffic();
+  for (std::size_t rank = 0; rank < std::min(traffic.bytes.size(), start_.bytes.size()); ++rank) {
+    traffic.messages[rank] -= start_.messages[rank];
+    traffic.bytes[rank] -= start_.bytes[rank];
+  }
+  for (std::size_t kind = 0; kind < kNumMpiCallKinds; ++kind) {
+    for (std::size_t size_class = 0; size_class < kNumMessageSizeClasses; ++size_class) {
+      traffic.message_sizes.at(kind).at(size_class) -= start_.message_sizes.at(kind).at(size_class);
+    }
+  }
+  return traffic;
+}
+
+ppc::util::MpiCommReport ppc::util::GatherMpiCommReport(const MpiTraffic &traffic) {
+  const auto ranks = traffic.bytes.size();
+  // One row per rank: messages to every rank, bytes to every rank, then the flattened histograms.
+  const std::size_t row_size = (2 * ranks) + (kNumMpiCallKinds * kNumMessageSizeClasses);
+  std::vector<uint64_t> row;
+  row.reserve(row_size);
+  row.insert(row.end(), traffic.messages.begin(), traffic.messages.end());
+  row.insert(row.end(), traffic.bytes.begin(), traffic.bytes.end());
+  for (const auto &histogram : traffic.message_sizes) {
+    row.insert(row.end(), histogram.begin(), histogram.end());
+  }
+
+  int rank = 0;
+  std::vector<uint64_t> rows = row;
+  if (ranks > 1) {
+    PMPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    rows.assign(rank == 0 ? row_size * ranks : 0, 0);
+    PMPI_Gather(row.data(), static_cast<int>(row_size), MPI_UINT64_T, rows.data(), static_cast<int>(row_size),
+                MPI_UINT64_T, 0, MPI_COMM_WORLD);
+  }
+  if (rank != 0) {
+    return {};
+  }
+
+  MpiCommReport report{.ranks = static_cast<int>(ranks),
+                       .messages = std::vector<uint64_t>(ranks * ranks),
+                       .bytes = std::vector<uint64_t>(ranks * ranks)};
+  for (std::size_t sender = 0; sender < ranks; ++sender) {
+    const auto *sender_row = &rows[sender * row_size];
+    std::copy_n(sender_row, ranks, &report.messages[sender * ranks]);
+    std::copy_n(sender_row + ranks, ranks, &report.bytes[sender * ranks]);
+    const auto *histograms = sender_row + (2 * ranks);
+    for (std::size_t kind = 0; kind < kNumMpiCallKinds; ++kind) {
+      for (std::size_t size_class = 0; size_class < kNumMessageSizeClasses; ++size_class) {
+        report.message_sizes.at(kind).at(size_class) += histograms[(kind * kNumMessageSizeClasses) + size_class];
+      }
+    }
+  }
+  return report;
+}
+
+std::string ppc::util::FormatMpiCommReportJson(const MpiCommReport &report) {
+  const auto ranks = static_cast<std::size_t>(report.ranks);
+  const auto matrix = [ranks](const std::vector<uint64_t> &values) -> nlohmann::json {
+    auto rows = nlohmann::json::array();
+    for (std::size_t sender = 0; sender < ranks; ++sender) {
+      const auto begin = values.begin() + static_cast<std::ptrdiff_t>(sender * ranks);
+      rows.push_back(std::vector<uint64_t>(begin, begin + static_cast<std::ptrdiff_t>(ranks)));
+    }
+    return rows;
+  };
+  auto message_sizes = nlohmann::json::object();
+  for (std::size_t kind = 0; kind < kNumMpiCallKinds; ++kind) {
+    auto classes = nlohmann::json::array();
+    for (std::size_t size_class = 0; size_class < kNumMessageSizeClasses; ++size_class) {
+      const uint64_t calls = report.message_sizes.at(kind).at(size_class);
+      if (calls > 0) {
+        classes.push_back({{"min_bytes", size_class == 0 ? 0 : uint64_t{1} << (size_class - 1)}, {"calls", calls}});
+      }
+    }
+    message_sizes[std::string(kMpiCallKindNames.at(kind))] = std::move(classes);
+  }
+  const nlohmann::json json = {{"ranks", report.ranks},
+                               {"messages", matrix(report.messages)},
+                               {"bytes", matrix(report.bytes)},
+                               {"message_sizes", message_sizes}};
+  return json.dump();
+}
+
+std::string ppc::util::FormatMpiCommHeatmap(const MpiCommReport &report, const std::string &title) {
+  constexpr std::string_view kShades = " .:-=+*#%@";
+  const int ranks = report.ranks;
+  std::vector<uint64_t> sent(static_cast<std::size_t>(ranks), 0);
+  std::vector<uint64_t> received(static_cast<std::size_t>(ranks), 0);
+  uint64_t largest = 0;
+  for (int sender = 0; sender < ranks; ++sender) {
+    for (int receiver = 0; receiver < ranks; ++receiver) {
+      const uint64_t bytes = report.BytesBetween(sender, receiver);
+      sent[static_cast<std::size_t>(sender)] += bytes;
+      received[static_cast<std::size_t>(receiver)] += bytes;
+      largest = std::max(largest, bytes);
+    }
+  }
+  const uint64_t total = std::accumulate(sent.begin(), sent.end(), uint64_t{0});
+
+  std::ostringstream out;
+  out << "MPI traffic of " << title << ": bytes sent from each rank (row) to each rank (column), largest cell "
+      << FormatBytes(largest) << '\n';
+  const int width = static_cast<int>(std::to_string(std::max(ranks - 1, 0)).size()) + 1;
+  out << std::setw(6) << "rank" << "  ";
+  for (int receiver = 0; receiver < ranks; ++receiver) {
+    out << std::setw(width) << receiver;
+  }
+  out << "  |" << std::setw(12) << "sent" << std::setw(12) << "received" << '\n';
+  for (int sender = 0; sender < ranks; ++sender) {
+    out << std::setw(6) << sender << "  ";
+    for (int receiver = 0; receiver < ranks; ++receiver) {
+      const uint64_t bytes = report.BytesBetween(sender, receiver);
+      // Any traffic gets at least the faintest shade; the largest cell gets the darkest.
+      const std::size_t shade =
+          bytes == 0 ? 0
+                     : 1 + static_cast<std::size_t>(static_cast<double>(bytes) / static_cast<double>(largest) *
+                                                    static_cast<double>(kShades.size() - 2));
+      out << std::setw(width) << kShades[shade];
+    }
+    out << "  |" << std::setw(12) << FormatBytes(sent[static_cast<std::size_t>(sender)]) << std::setw(12)
+        << FormatBytes(received[static_cast<std::size_t>(sender)]) << '\n';
+  }
+  if (total > 0) {
+    // A rank that takes part in most of the traffic, such as a root everything is funneled through.
+    int busiest = 0;
+    for (int rank = 1; rank < ranks; ++rank) {
+      const auto index = static_cast<std::size_t>(rank);
+      const auto best = static_cast<std::size_t>(busiest);
+      if (sent[index] + received[index] > sent[best] + received[best]) {
+        busiest = rank;
+      }
+    }
+    const auto percent = [total](uint64_t bytes) -> int {
+      constexpr double kPercent = 100.0;
+      return static_cast<int>((static_cast<double>(bytes) * kPercent / static_cast<double>(total)) + 0.5);
+    };
+    out << "busiest rank " << busiest << ": sends " << percent(sent[static_cast<std::size_t>(busiest)])
+        << "% and receives " << percent(received[static_cast<std::size_t>(busiest)]) << "% of "
+        << FormatBytes(total) << '\n';
+  }
+  out << "calls per message size (smallest size of each class):\n";
+  for (std::size_t kind = 0; kind < kNumMpiCallKinds; ++kind) {
+    const auto &histogram = report.message_sizes.at(kind);
+    if (std::ranges::all_of(histogram, [](uint64_t calls) -> bool { return calls == 0; })) {
+      continue;
+    }
+    out << "  " << std::left << std::setw(12) << kMpiCallKindNames.at(kind) << std::right;
+    for (std::size_t size_class = 0; size_class < kNumMessageSizeClasses; ++size_class) {
+      if (histogram.at(size_class) > 0) {
+        out << ' ' << MessageSizeClassLabel(size_class) << ':' << histogram.at(size_class);
+      }
+    }
+    out << '\n';
+  }
+  return out.str();
+}
+
+#ifdef PPC_ENABLE_MPI_PROFILING
+
+// PMPI wrappers: each MPI_ function records itself and forwards to its PMPI_ twin.
+// NOLINTBEGIN(readability-identifier-naming,*-avoid-c-arrays,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+extern "C" {
+
+// Point-to-point
+
+int MPI_Send(const void *buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm) {
+  RecordMessage(comm, dest, TypeBytes(count, datatype));
+  const ProfiledCall call(MpiCallKind::kPointToPoint, TypeBytes(count, datatype));
+  return PMPI_Send(buf, count, datatype, dest, tag, comm);
+}
+
+int MPI_Ssend(const void *buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm) {
+  RecordMessage(comm, dest, TypeBytes(count, datatype));
+  const ProfiledCall call(MpiCallKind::kPointToPoint, TypeBytes(count, datatype));
+  return PMPI_Ssend(buf, count, datatype, dest, tag, comm);
+}
+
+int MPI_Bsend(const void *buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm) {
+  RecordMessage(comm, dest, TypeBytes(count, datatype));
+  const ProfiledCall call(MpiCallKind::kPointToPoint, TypeBytes(count, datatype));
+  return PMPI_Bsend(buf, count, datatype, dest, tag, comm);
+}
+
+int MPI_Rsend(const void *buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm) {
+  RecordMessage(comm, dest, TypeBytes(count, datatype));
+  const ProfiledCall call(MpiCallKind::kPointToPoint, TypeBytes(count, datatype));
+  return PMPI_Rsend(buf, count, datatype, dest, tag, comm);
+}
+
+int MPI_Isend(const void *buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm,
+              MPI_Request *request) {
+  RecordMessage(comm, dest, TypeBytes(count, datatype));
+  const ProfiledCall call(MpiCallKind::kPointToPoint, TypeBytes(count, datatype));
+  return PMPI_Isend(buf, count, datatype, dest, tag, comm, request);
+}
+
+int MPI_Issend(const void *buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Comm comm,
+               MPI_Request *request) {
+  RecordMessage(comm, dest, TypeBytes(count, datatype));
+  const ProfiledCall call(MpiCallKind::kPointToPoint, TypeBytes(count, datatype));
+  return PMPI_Issend(buf, count, datatype, dest, tag, comm, request);
+}
+
+int MPI_Recv(void *buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Comm comm, MPI_Status *status) {
+  ProfiledCall call(MpiCallKind::kPointToPoint, 0);
+  MPI_Status local_status{};
+  MPI_Status *used_status = status == MPI_STATUS_IGNORE ? &local_status : status;
+  const int result = PMPI_Recv(buf, count, datatype, source, tag, comm, used_status);
+  call.AddBytes(ReceivedBytes(used_status, datatype));
+  return result;
+}
+
+int MPI_Irecv(void *buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Comm comm,
+              MPI_Request *request) {
+  // The received size is only known on completion; the buffer size is counted instead.
+  const ProfiledCall call(MpiCallKind::kPointToPoint, TypeBytes(count, datatype));
+  return PMPI_Irecv(buf, count, datatype, source, tag, comm, request);
+}
+
+int MPI_Sendrecv(const void *sendbuf, int sendcount, MPI_Datatype sendtype, int dest, int sendtag, void *recvbuf,
+                 int recvcount, MPI_Datatype recvtype, int source, int recvtag, MPI_Comm comm, MPI_Status *status) {
+  RecordMessage(comm, dest, TypeBytes(sendcount, sendtype));
+  ProfiledCall call(MpiCallKind::kPointToPoint, TypeBytes(sendcount, sendtype));
+  MPI_Status local_status{};
+  MPI_Status *used_status = status == MPI_STATUS_IGNORE ? &local_status : status;
+  const int result = PMPI_Sendrecv(sendbuf, sendcount, sendtype, dest, sendtag, recvbuf, recvcount, recvtype, source,
+                                   recvtag, comm, used_status);
+  call.AddBytes(ReceivedBytes(used_status, recvtype));
+  return result;
+}
+
+int MPI_Sendrecv_replace(void *buf, int count, MPI_Datatype datatype, int dest, int sendtag, int source, int recvtag,
+                         MPI_Comm comm, MPI_Status *status) {
+  RecordMessage(comm, dest, TypeBytes(count, datatype));
+  const ProfiledCall call(MpiCallKind::kPointToPoint, 2 * TypeBytes(count, datatype));
+  return PMPI_Sendrecv_replace(buf, count, datatype, dest, sendtag, source, recvtag, comm, status);
+}
+
+// Completion and probing
+
+int MPI_Wait(MPI_Request *request, MPI_Status *status) {
+  const ProfiledCall call(MpiCallKind::kWait, 0);
+  return PMPI_Wait(request, status);
+}
+
+int MPI_Waitall(int count, MPI_Request array_of_requests[], MPI_Status *array_of_statuses) {
+  const ProfiledCall call(MpiCallKind::kWait, 0);
+  return PMPI_Waitall(count, array_of_requests, array_of_statuses);
+}
+
+int MPI_Waitany(int count, MPI_Request array_of_requests[], int *index, MPI_Status *status) {
+  const ProfiledCall call(MpiCallKind::kWait, 0);
+  return PMPI_Waitany(count, array_of_requests, index, status);
+}
+
+int MPI_Waitsome(int incount, MPI_Request array_of_requests[], int *outcount, int array_of_indices[],
+                 MPI_Status array_of_statuses[]) {
+  const ProfiledCall call(MpiCallKind::kWait, 0);
+  return PMPI_Waitsome(incount, array_of_requests, outcount, array_of_indices, array_of_statuses);
+}
+
+int MPI_Test(MPI_Request *request, int *flag, MPI_Status *status) {
+  const ProfiledCall call(MpiCallKind::kWait, 0);
+  return PMPI_Test(request, flag, status);
+}
+
+int MPI_Testall(int count, MPI_Request array_of_requests[], int *flag, MPI_Status array_of_statuses[]) {
+  const ProfiledCall call(MpiCallKind::kWait, 0);
+  return PMPI_Testall(count, array_of_requests, flag, array_of_statuses);
+}
+
+int MPI_Testany(int count, MPI_Request array_of_requests[], int *index, int *flag, MPI_Status *status) {
+  const ProfiledCall call(MpiCallKind::kWait, 0);
+  return PMPI_Testany(count, array_of_requests, index, flag, status);
+}
+
+int MPI_Testsome(int incount, MPI_Request array_of_requests[], int *outcount, int array_of_indices[],
+                 MPI_Status array_of_statuses[]) {
+  const ProfiledCall call(MpiCallKind::kWait, 0);
+  return PMPI_Testsome(incount, array_of_requests, outcount, array_of_indices, array_of_statuses);
+}
+
+int MPI_Probe(int source, int tag, MPI_Comm comm, MPI_Status *status) {
+  const ProfiledCall call(MpiCallKind::kWait, 0);
+  return PMPI_Probe(source, tag, comm, status);
+}
+
+int MPI_Iprobe(int source, int tag, MPI_Comm comm, int *flag, MPI_Status *status) {
+  const ProfiledCall call(MpiCallKind::kWait, 0);
+  return PMPI_Iprobe(source, tag, comm, flag, status);
+}
+
+// Collectives
+
+int MPI_Barrier(MPI_Comm comm) {
+  const ProfiledCall call(MpiCallKind::kCollective, 0);
+  return PMPI_Barrier(comm);
+}
+
+int MPI_Ibarrier(MPI_Comm comm, MPI_Request *request) {
+  const ProfiledCall call(MpiCallKind::kCollective, 0);
+  return PMPI_Ibarrier(comm, request);
+}
+
+int MPI_Bcast(void *buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm) {
+  if (CommRank(comm) == root) {
+    RecordMessagesToPeers(comm, TypeBytes(count, datatype));
+  }
+  const ProfiledCall call(MpiCallKind::kCollective, TypeBytes(count, datatype));
+  return PMPI_Bcast(buffer, count, datatype, root, comm);
+}
+
+int MPI_Ibcast(void *buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm, MPI_Request *request) {
+  if (CommRank(comm) == root) {
+    RecordMessagesToPeers(comm, TypeBytes(count, datatype));
+  }
+  const ProfiledCall call(MpiCallKind::kCollective, TypeBytes(count, datatype));
+  return PMPI_Ibcast(buffer, count, datatype, root, comm, request);
+}
+
+int MPI_Reduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op, int root,
+               MPI_Comm comm) {
+  if (CommRank(comm) != root) {
+    RecordMessage(comm, root, TypeBytes(count, datatype));
+  }
+  const ProfiledCall call(MpiCallKind::kCollective,
+                          ReduceBytes(sendbuf, count, datatype, CommRank(comm) == root));
+  return PMPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+}
+
+int MPI_Ireduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op, int root,
+                MPI_Comm comm, MPI_Request *request) {
+  if (CommRank(comm) != root) {
+    RecordMessage(comm, root, TypeBytes(count, datatype));
+  }
+  const ProfiledCall call(MpiCallKind::kCollective,
+                          ReduceBytes(sendbuf, count, datatype, CommRank(comm) == root));
+  return PMPI_Ireduce(sendbuf, recvbuf, count, datatype, op, root, comm, request);
+}
+
+int MPI_Allreduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+  RecordMessagesToPeers(comm, TypeBytes(count, datatype));
+  const ProfiledCall call(MpiCallKind::kCollective, ReduceBytes(sendbuf, count, datatype, true));
+  return PMPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+}
+
+int MPI_Iallreduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
+                   MPI_Request *request) {
+  RecordMessagesToPeers(comm, TypeBytes(count, datatype));
+  const ProfiledCall call(MpiCallKind::kCollective, ReduceBytes(sendbuf, count, datatype, true));
+  return PMPI_Iallreduce(sendbuf, recvbuf, count, datatype, op, comm, request);
+}
+
+int MPI_Scan(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+  RecordMessagesToPeers(comm, [rank = CommRank(comm), bytes = TypeBytes(count, datatype)](int peer) -> uint64_t {
+    return peer > rank ? bytes : 0;
+  });
+  const ProfiledCall call(MpiCallKind::kCollective, ReduceBytes(sendbuf, count, datatype, true));
+  return PMPI_Scan(sendbuf, recvbuf, count, datatype, op, comm);
+}
+
+int MPI_Exscan(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+  RecordMessagesToPeers(comm, [rank = CommRank(comm), bytes = TypeBytes(count, datatype)](int peer) -> uint64_t {
+    return peer > rank ? bytes : 0;
+  });
+  const ProfiledCall call(MpiCallKind::kCollective, ReduceBytes(sendbuf, count, datatype, true));
+  return PMPI_Exscan(sendbuf, recvbuf, count, datatype, op, comm);
+}
+
+int MPI_Reduce_scatter(const void *sendbuf, void *recvbuf, const int recvcounts[], MPI_Datatype datatype, MPI_Op op,
+                       MPI_Comm comm) {
+  RecordMessagesToPeers(comm, [&](int peer) -> uint64_t { return TypeBytes(recvcounts[peer], datatype); });
+  const int size = CommSize(comm);
+  const uint64_t send_bytes = IsInPlace(sendbuf) ? 0 : SumTypeBytes(recvcounts, size, datatype);
+  const ProfiledCall call(MpiCallKind::kCollective,
+                          send_bytes + SumTypeBytes(&recvcounts[CommRank(comm)], 1, datatype));
+  return PMPI_Reduce_scatter(sendbuf, recvbuf, recvcounts, datatype, op, comm);
+}
+
+int MPI_Reduce_scatter_block(const void *sendbuf, void *recvbuf, int recvcount, MPI_Datatype datatype, MPI_Op op,
+                             MPI_Comm comm) {
+  RecordMessagesToPeers(comm, TypeBytes(recvcount, datatype));
+  const uint64_t send_bytes = IsInPlace(sendbuf) ? 0 : TypeBytes(recvcount * CommSize(comm), datatype);
+  const ProfiledCall call(MpiCallKind::kCollective, send_bytes + TypeBytes(recvcount, datatype));
+  return PMPI_Reduce_scatter_block(sendbuf, recvbuf, recvcount, datatype, op, comm);
+}
+
+int MPI_Gather(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf, int recvcount,
+               MPI_Datatype recvtype, int root, MPI_Comm comm) {
+  if (CommRank(comm) != root) {
+    RecordMessage(comm, root, TypeBytes(sendcount, sendtype));
+  }
+  const uint64_t receive_bytes = CommRank(comm) == root ? TypeBytes(recvcount * CommSize(comm), recvtype) : 0;
+  const ProfiledCall call(MpiCallKind::kCollective, GatherBytes(sendbuf, sendcount, sendtype, receive_bytes));
+  return PMPI_Gather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root, comm);
+}
+
+int MPI_Igather(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf, int recvcount,
+                MPI_Datatype recvtype, int root, MPI_Comm comm, MPI_Request *request) {
+  if (CommRank(comm) != root) {
+    RecordMessage(comm, root, TypeBytes(sendcount, sendtype));
+  }
+  const uint64_t receive_bytes = CommRank(comm) == root ? TypeBytes(recvcount * CommSize(comm), recvtype) : 0;
+  const ProfiledCall call(MpiCallKind::kCollective, GatherBytes(sendbuf, sendcount, sendtype, receive_bytes));
+  return PMPI_Igather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root, comm, request);
+}
+
+int MPI_Gatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf, const int recvcounts[],
+                const int displs[], MPI_Datatype recvtype, int root, MPI_Comm comm) {
+  if (CommRank(comm) != root) {
+    RecordMessage(comm, root, TypeBytes(sendcount, sendtype));
+  }
+  const uint64_t receive_bytes = CommRank(comm) == root ? SumTypeBytes(recvcounts, CommSize(comm), recvtype) : 0;
+  const ProfiledCall call(MpiCallKind::kCollective, GatherBytes(sendbuf, sendcount, sendtype, receive_bytes));
+  return PMPI_Gatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, root, comm);
+}
+
+int MPI_Allgather(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf, int recvcount,
+                  MPI_Datatype recvtype, MPI_Comm comm) {
+  RecordMessagesToPeers(comm, IsInPlace(sendbuf) ? TypeBytes(recvcount, recvtype) : TypeBytes(sendcount, sendtype));
+  const uint64_t receive_bytes = TypeBytes(recvcount * CommSize(comm), recvtype);
+  const ProfiledCall call(MpiCallKind::kCollective, GatherBytes(sendbuf, sendcount, sendtype, receive_bytes));
+  return PMPI_Allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+}
+
+int MPI_Iallgather(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf, int recvcount,
+                   MPI_Datatype recvtype, MPI_Comm comm, MPI_Request *request) {
+  RecordMessagesToPeers(comm, IsInPlace(sendbuf) ? TypeBytes(recvcount, recvtype) : TypeBytes(sendcount, sendtype));
+  const uint64_t receive_bytes = TypeBytes(recvcount * CommSize(comm), recvtype);
+  const ProfiledCall call(MpiCallKind::kCollective, GatherBytes(sendbuf, sendcount, sendtype, receive_bytes));
+  return PMPI_Iallgather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm, request);
+}
+
+int MPI_Allgatherv(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf, const int recvcounts[],
+                   const int displs[], MPI_Datatype recvtype, MPI_Comm comm) {
+  RecordMessagesToPeers(comm, IsInPlace(sendbuf) ? TypeBytes(recvcounts[CommRank(comm)], recvtype)
+                                               : TypeBytes(sendcount, sendtype));
+  const uint64_t receive_bytes = SumTypeBytes(recvcounts, CommSize(comm), recvtype);
+  const ProfiledCall call(MpiCallKind::kCollective, GatherBytes(sendbuf, sendcount, sendtype, receive_bytes));
+  return PMPI_Allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, comm);
+}
+
+int MPI_Scatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf, int recvcount,
+                MPI_Datatype recvtype, int root, MPI_Comm comm) {
+  if (CommRank(comm) == root) {
+    RecordMessagesToPeers(comm, TypeBytes(sendcount, sendtype));
+  }
+  const uint64_t send_bytes = CommRank(comm) == root ? TypeBytes(sendcount * CommSize(comm), sendtype) : 0;
+  const ProfiledCall call(MpiCallKind::kCollective, ScatterBytes(send_bytes, recvbuf, recvcount, recvtype));
+  return PMPI_Scatter(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root, comm);
+}
+
+int MPI_Iscatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf, int recvcount,
+                 MPI_Datatype recvtype, int root, MPI_Comm comm, MPI_Request *request) {
+  if (CommRank(comm) == root) {
+    RecordMessagesToPeers(comm, TypeBytes(sendcount, sendtype));
+  }
+  const uint64_t send_bytes = CommRank(comm) == root ? TypeBytes(sendcount * CommSize(comm), sendtype) : 0;
+  const ProfiledCall call(MpiCallKind::kCollective, ScatterBytes(send_bytes, recvbuf, recvcount, recvtype));
+  return PMPI_Iscatter(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, root, comm, request);
+}
+
+int MPI_Scatterv(const void *sendbuf, const int sendcounts[], const int displs[], MPI_Datatype sendtype,
+                 void *recvbuf, int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm) {
+  if (CommRank(comm) == root) {
+    RecordMessagesToPeers(comm, [&](int peer) -> uint64_t { return TypeBytes(sendcounts[peer], sendtype); });
+  }
+  const uint64_t send_bytes = CommRank(comm) == root ? SumTypeBytes(sendcounts, CommSize(comm), sendtype) : 0;
+  const ProfiledCall call(MpiCallKind::kCollective, ScatterBytes(send_bytes, recvbuf, recvcount, recvtype));
+  return PMPI_Scatterv(sendbuf, sendcounts, displs, sendtype, recvbuf, recvcount, recvtype, root, comm);
+}
+
+int MPI_Alltoall(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf, int recvcount,
+                 MPI_Datatype recvtype, MPI_Comm comm) {
+  RecordMessagesToPeers(comm, IsInPlace(sendbuf) ? TypeBytes(recvcount, recvtype) : TypeBytes(sendcount, sendtype));
+  const int size = CommSize(comm);
+  const uint64_t send_bytes = IsInPlace(sendbuf) ? 0 : TypeBytes(sendcount * size, sendtype);
+  const ProfiledCall call(MpiCallKind::kCollective, send_bytes + TypeBytes(recvcount * size, recvtype));
+  return PMPI_Alltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+}
+
+int MPI_Ialltoall(const void *sendbuf, int sendcount, MPI_Datatype sendtype, void *recvbuf, int recvcount,
+                  MPI_Datatype recvtype, MPI_Comm comm, MPI_Request *request) {
+  RecordMessagesToPeers(comm, IsInPlace(sendbuf) ? TypeBytes(recvcount, recvtype) : TypeBytes(sendcount, sendtype));
+  const int size = CommSize(comm);
+  const uint64_t send_bytes = IsInPlace(sendbuf) ? 0 : TypeBytes(sendcount * size, sendtype);
+  const ProfiledCall call(MpiCallKind::kCollective, send_bytes + TypeBytes(recvcount * size, recvtype));
+  return PMPI_Ialltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm, request);
+}
+
+int MPI_Alltoallv(const void *sendbuf, const int sendcounts[], const int sdispls[], MPI_Datatype sendtype,
+                  void *recvbuf, const int recvcounts[], const int rdispls[], MPI_Datatype recvtype, MPI_Comm comm) {
+  RecordMessagesToPeers(comm, [&](int peer) -> uint64_t {
+    return IsInPlace(sendbuf) ? TypeBytes(recvcounts[peer], recvtype) : TypeBytes(sendcounts[peer], sendtype);
+  });
+  const int size = CommSize(comm);
+  const uint64_t send_bytes = IsInPlace(sendbuf) ? 0 : SumTypeBytes(sendcounts, size, sendtype);
+  const ProfiledCall call(MpiCallKind::kCollective, send_bytes + SumTypeBytes(recvcounts, size, recvtype));
+  return PMPI_Alltoallv(sendbuf, sendcounts, sdispls, sendtype, recvbuf, recvcounts, rdispls, recvtype, comm);
+}
+
+}  // extern "C"
+// NOLINTEND(readability-identifier-naming,*-avoid-c-arrays,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+#endif
@@ -0,0 +1,112 @@
+#include "util/include/perf_calibration.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include "util/include/util.hpp"
+
+namespace {
+
+// Upper bound on measured sizes, so a task whose time does not depend on the size cannot loop forever.
+constexpr int kMaxCalibrationRuns = 64;
+// Bisection stops once the sizes below and above the target differ by at most this fraction.
+constexpr double kCalibrationTolerance = 0.05;
+
+nlohmann::json ReadCache(const std::string &cache_path) {
+  std::ifstream file(cache_path);
+  if (!file.is_open()) {
+    return nlohmann::json::object();
+  }
+  auto cache = nlohmann::json::parse(file, nullptr, false);
+  return cache.is_object() ? cache : nlohmann::json::object();
+}
+
+bool SameTarget(double lhs, double rhs) {
+  return std::abs(lhs - rhs) <= 1e-9 * std::max(std::abs(lhs), std::abs(rhs));
+}
+
+}  // namespace
+
+int64_t ppc::util::CalibrateSize(int64_t start_size, double target_time,
+                                 const std::function<double(int64_t)> &measure) {
+  std::map<int64_t, double> times;
+  const auto below_target = [&](int64_t size) -> bool {
+    auto [entry, inserted] = times.try_emplace(size, 0.0);
+    if (inserted) {
+      entry->second = measure(size);
+    }
+    return entry->second < target_time;
+  };
+
+  int64_t size = std::max<int64_t>(start_size, 1);
+  int64_t below = 0;
+  int64_t above = 0;
+  (below_target(size) ? below : above) = size;
+  while (std::ssize(times) < kMaxCalibrationRuns && (below == 0 || above == 0)) {
+    if (above == 0) {
+      if (size > std::numeric_limits<int64_t>::max() / 2) {
+        break;
+      }
+      size *= 2;
+    } else {
+      if (size == 1) {
+        break;
+      }
+      size /= 2;
+    }
+    (below_target(size) ? below : above) = size;
+  }
+  const auto bracket_is_wide = [&below, &above] -> bool {
+    const auto tolerance = static_cast<int64_t>(kCalibrationTolerance * static_cast<double>(below));
+    return above - below > std::max<int64_t>(1, tolerance);
+  };
+  if (below != 0 && above != 0) {
+    while (std::ssize(times) < kMaxCalibrationRuns && bracket_is_wide()) {
+      const int64_t middle = below + ((above - below) / 2);
+      (below_target(middle) ? below : above) = middle;
+    }
+  }
+  return std::ranges::min_element(times, {}, [target_time](const auto &entry) -> double {
+           return std::abs(entry.second - target_time);
+         })->first;
+}
+
+std::optional<int64_t> ppc::util::LoadCalibratedSize(const std::string &cache_path, const std::string &key,
+                                                     double target_time) {
+  const auto cache = ReadCache(cache_path);
+  const auto entry = cache.find(key);
+  if (entry == cache.end() || !entry->is_object() || !entry->contains("target_time") || !entry->contains("size")) {
+    return std::nullopt;
+  }
+  const auto &stored_target = (*entry)["target_time"];
+  const auto &stored_size = (*entry)["size"];
+  if (!stored_target.is_number() || !stored_size.is_number_integer() ||
+      !SameTarget(stored_target.get<double>(), target_time)) {
+    return std::nullopt;
+  }
+  return stored_size.get<int64_t>();
+}
+
+void ppc::util::StoreCalibratedSize(const std::string &cache_path, const std::string &key, double target_time,
+                                    int64_t size) {
+  auto cache = ReadCache(cache_path);
+  cache[key] = {{"target_time", target_time}, {"size", size}};
+  const std::filesystem::path path(cache_path);
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path());
+  }
+  std::ofstream file(cache_path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to write the calibration cache " + cache_path);
+  }
+  file << cache.dump(2) << '\n';
+}
@@ -0,0 +1,190 @@
+#include "util/include/perf_counters.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+std::atomic<const ppc::util::PerfCounters *> &ActiveCounters() {
+  static std::atomic<const ppc::util::PerfCounters *> active{nullptr};
+  return active;
+}
+
+#ifdef __linux__
+
+struct EventConfig {
+  uint32_t type;
+  uint64_t config;
+};
+
+constexpr uint64_t kLlcConfig = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8U);
+
+/// perf_event_open() type and config of every PerfCounterKind.
+constexpr std::array<EventConfig, ppc::util::kNumPerfCounterKinds> kEventConfigs = {{
+    {.type = PERF_TYPE_HARDWARE, .config = PERF_COUNT_HW_CPU_CYCLES},
+    {.type = PERF_TYPE_HARDWARE, .config = PERF_COUNT_HW_INSTRUCTIONS},
+    {.type = PERF_TYPE_HW_CACHE, .config = kLlcConfig | (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16U)},
+    {.type = PERF_TYPE_HW_CACHE, .config = kLlcConfig | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U)},
+    {.type = PERF_TYPE_HARDWARE, .config = PERF_COUNT_HW_BRANCH_MISSES},
+    {.type = PERF_TYPE_SOFTWARE, .config = PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {.type = PERF_TYPE_SOFTWARE, .config = PERF_COUNT_SW_CPU_MIGRATIONS},
+    {.type = PERF_TYPE_SOFTWARE, .config = PERF_COUNT_SW_PAGE_FAULTS},
+}};
+
+/// Returns the ids of the threads of this process.
+std::vector<int> ListThreads() {
+  std::vector<int> threads;
+  std::error_code error;
+  for (const auto &entry : std::filesystem::directory_iterator("/proc/self/task", error)) {
+    int thread = 0;
+    const auto name = entry.path().filename().string();
+    const auto [end, parse_error] = std::from_chars(name.data(), name.data() + name.size(), thread);
+    if (parse_error == std::errc{} && end == name.data() + name.size()) {
+      threads.push_back(thread);
+    }
+  }
+  if (threads.empty()) {
+    threads.push_back(0);
+  }
+  return threads;
+}
+
+int OpenEvent(const EventConfig &event, int thread) {
+  perf_event_attr attr{};
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = event.type;
+  attr.config = event.config;
+  attr.inherit = 1;
+  // Software events such as context switches happen in the kernel; counting a process's own kernel-side software
+  // events is allowed with the default perf_event_paranoid setting, hardware events are counted in user mode.
+  attr.exclude_kernel = event.type == PERF_TYPE_SOFTWARE ? 0 : 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, thread, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+
+/// Reads one descriptor, scaled up when the kernel ran the event only part of the time.
+double ReadEvent(int descriptor) {
+  std::array<uint64_t, 3> data{};
+  if (read(descriptor, data.data(), sizeof(data)) != static_cast<ssize_t>(sizeof(data))) {
+    return 0.0;
+  }
+  const auto [value, enabled, running] = data;
+  if (running == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(value) * (static_cast<double>(enabled) / static_cast<double>(running));
+}
+
+#endif
+
+/// Reads the kinds getrusage() provides for the whole process.
+ppc::util::PerfCounterValues ReadRusage() {
+  ppc::util::PerfCounterValues values;
+#ifndef _WIN32
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return values;
+  }
+  const auto switches = static_cast<std::size_t>(ppc::util::PerfCounterKind::kContextSwitches);
+  const auto faults = static_cast<std::size_t>(ppc::util::PerfCounterKind::kPageFaults);
+  values.values.at(switches) = static_cast<double>(usage.ru_nvcsw + usage.ru_nivcsw);
+  values.available.at(switches) = true;
+  values.values.at(faults) = static_cast<double>(usage.ru_minflt + usage.ru_majflt);
+  values.available.at(faults) = true;
+#endif
+  return values;
+}
+
+}  // namespace
+
+ppc::util::PerfCounters::PerfCounters(bool use_perf_events) {
+#ifdef __linux__
+  if (use_perf_events) {
+    const auto threads = ListThreads();
+    for (std::size_t kind = 0; kind < kNumPerfCounterKinds; ++kind) {
+      auto &descriptors = descriptors_.at(kind);
+      for (const int thread : threads) {
+        const int descriptor = OpenEvent(kEventConfigs.at(kind), thread);
+        if (descriptor >= 0) {
+          descriptors.push_back(descriptor);
+        }
+      }
+    }
+  }
+#else
+  static_cast<void>(use_perf_events);
+#endif
+  rusage_base_ = ReadRusage();
+  for (std::size_t kind = 0; kind < kNumPerfCounterKinds; ++kind) {
+    from_rusage_.at(kind) = descriptors_.at(kind).empty() && rusage_base_.available.at(kind);
+  }
+}
+
+ppc::util::PerfCounters::~PerfCounters() {
+#ifdef __linux__
+  for (const auto &descriptors : descriptors_) {
+    for (const int descriptor : descriptors) {
+      close(descriptor);
+    }
+  }
+#endif
+}
+
+ppc::util::PerfCounterValues ppc::util::PerfCounters::Read() const {
+  PerfCounterValues values;
+  const bool needs_rusage = std::ranges::find(from_rusage_, true) != from_rusage_.end();
+  const auto usage = needs_rusage ? ReadRusage() : PerfCounterValues{};
+  for (std::size_t kind = 0; kind < kNumPerfCounterKinds; ++kind) {
+    if (from_rusage_.at(kind)) {
+      values.values.at(kind) = usage.values.at(kind) - rusage_base_.values.at(kind);
+      values.available.at(kind) = true;
+      continue;
+    }
+#ifdef __linux__
+    const auto &descriptors = descriptors_.at(kind);
+    for (const int descriptor : descriptors) {
+      values.values.at(kind) += ReadEvent(descriptor);
+    }
+    values.available.at(kind) = !descriptors.empty();
+#endif
+  }
+  return values;
+}
+
+bool ppc::util::PerfCounters::HasHardwareEvents() const {
+  return !descriptors_.at(static_cast<std::size_t>(PerfCounterKind::kCycles)).empty() &&
+         !descriptors_.at(static_cast<std::size_t>(PerfCounterKind::kInstructions)).empty();
+}
+
+const ppc::util::PerfCounters *ppc::util::PerfCounters::Active() {
+  return ActiveCounters().load(std::memory_order_acquire);
+}
+
+ppc::util::ActivePerfCountersScope::ActivePerfCountersScope(const PerfCounters &counters)
+    : previous_(ActiveCounters().exchange(&counters, std::memory_order_acq_rel)) {}
+
+ppc::util::ActivePerfCountersScope::~ActivePerfCountersScope() {
+  ActiveCounters().store(previous_, std::memory_order_release);
+}
@@ -0,0 +1,124 @@
+#include "util/include/perf_environment.hpp"
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "util/include/util.hpp"
+
+namespace {
+
+// Doubles swept by one kernel run: 8 MiB, which exercises the caches and memory as well as the FPU.
+constexpr std::size_t kNoiseElements = std::size_t{1} << 20;
+constexpr int kNoisePasses = 2;
+constexpr int kNoiseRuns = 7;
+constexpr const char *kUnknown = "unknown";
+
+std::string ReadFirstLine(const std::string &path) {
+  std::ifstream file(path);
+  std::string line;
+  if (!file.is_open() || !std::getline(file, line) || line.empty()) {
+    return kUnknown;
+  }
+  return line;
+}
+
+std::string ReadCpuModel() {
+  std::ifstream file("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.starts_with("model name") || line.starts_with("Model") || line.starts_with("Hardware")) {
+      const auto colon = line.find(':');
+      if (colon != std::string::npos && colon + 2 <= line.size()) {
+        return line.substr(colon + 2);
+      }
+    }
+  }
+  return kUnknown;
+}
+
+std::string ReadCurrentFrequencyMhz() {
+  const std::string khz = ReadFirstLine("/sys/devices/system/cpu/cpu0/cpufreq/scaling_cur_freq");
+  if (khz == kUnknown) {
+    return kUnknown;
+  }
+  try {
+    return std::format("{:.0f}", std::stod(khz) / 1000.0);
+  } catch (...) {
+    return kUnknown;
+  }
+}
+
+std::string ReadLoadAverage() {
+  std::ifstream file("/proc/loadavg");
+  std::string one;
+  std::string five;
+  std::string fifteen;
+  if (!(file >> one >> five >> fifteen)) {
+    return kUnknown;
+  }
+  return one + " " + five + " " + fifteen;
+}
+
+std::string ReadSmtState() {
+  const std::string active = ReadFirstLine("/sys/devices/system/cpu/smt/active");
+  if (active == "1") {
+    return "on";
+  }
+  return active == "0" ? "off" : kUnknown;
+}
+
+double TimeKernelOnce(std::vector<double> &data) {
+  const auto begin = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < kNoisePasses; ++pass) {
+    for (std::size_t i = 1; i < data.size(); ++i) {
+      data[i] = std::sqrt((data[i] * data[i - 1]) + 1.0);
+    }
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+}  // namespace
+
+std::map<std::string, std::string> ppc::util::CaptureMachineEnvironment() {
+  return {{"cpu_model", ReadCpuModel()},
+          {"cpu_governor", ReadFirstLine("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor")},
+          {"cpu_cur_freq_mhz", ReadCurrentFrequencyMhz()},
+          {"load_average", ReadLoadAverage()},
+          {"smt", ReadSmtState()}};
+}
+
+double ppc::util::MeasureNoiseKernel() {
+  std::vector<double> data(kNoiseElements, 1.0);
+  std::vector<double> times;
+  times.reserve(kNoiseRuns);
+  const bool use_mpi = ppc::util::IsMpiActive();
+  if (use_mpi) {
+    MPI_Barrier(MPI_COMM_WORLD);
+  }
+  for (int run = 0; run < kNoiseRuns; ++run) {
+    times.push_back(TimeKernelOnce(data));
+  }
+  if (data.back() < 0.0) {
+    times.front() = 0.0;  // Unreachable; keeps the kernel's result observable.
+  }
+  std::ranges::nth_element(times, times.begin() + (kNoiseRuns / 2));
+  double median = times[kNoiseRuns / 2];
+  if (use_mpi) {
+    MPI_Allreduce(MPI_IN_PLACE, &median, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+  }
+  return median;
+}
+
+double ppc::util::NoiseKernelDrift(double before, double after) {
+  const double reference = std::min(before, after);
+  return reference > 0.0 ? std::abs(after - before) / reference : 0.0;
+}
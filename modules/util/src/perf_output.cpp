@@ -0,0 +1,122 @@
+#include "util/include/perf_output.hpp"
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/include/util.hpp"
+
+namespace {
+
+constexpr std::array<std::string_view, 7> kReportedSuffixes = {
+    "iterations:", "repeats:", "min_time:", "min_warmup_time:", "manual_time", "real_time", "process_time"};
+
+bool IsReportedSuffix(std::string_view segment) {
+  for (const auto suffix : kReportedSuffixes) {
+    if (segment.starts_with(suffix)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void CheckBenchmarkOutput(const nlohmann::json &output, const std::string &source) {
+  if (!output.is_object() || !output.contains("benchmarks") || !output["benchmarks"].is_array()) {
+    throw std::runtime_error("Benchmark output " + source + " is not Google Benchmark JSON");
+  }
+}
+
+nlohmann::json ReadBenchmarkOutput(const std::string &output_path) {
+  std::ifstream file(output_path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open benchmark output " + output_path);
+  }
+  auto output = nlohmann::json::parse(file, nullptr, false);
+  CheckBenchmarkOutput(output, output_path);
+  return output;
+}
+
+std::string ReplaceOutputExtension(const std::string &output_path, const std::string &suffix) {
+  const std::filesystem::path path(output_path);
+  auto renamed = path;
+  renamed.replace_filename(path.stem().string() + suffix + path.extension().string());
+  return renamed.string();
+}
+
+void WriteBenchmarkOutput(const std::string &output_path, const nlohmann::json &output) {
+  std::ofstream file(output_path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to write benchmark output " + output_path);
+  }
+  file << output.dump(2) << '\n';
+}
+
+}  // namespace
+
+std::string ppc::util::BenchmarkRunKey(const std::string &reported_name) {
+  const std::string_view name = reported_name;
+  std::size_t end = name.size();
+  while (end > 0) {
+    const std::size_t separator = name.rfind('/', end - 1);
+    if (separator == std::string_view::npos || !IsReportedSuffix(name.substr(separator + 1, end - separator - 1))) {
+      break;
+    }
+    end = separator;
+  }
+  return std::string(name.substr(0, end));
+}
+
+void ppc::util::AttachSamplesToBenchmarkOutput(const std::string &output_path,
+                                               const std::map<std::string, std::vector<double>> &samples) {
+  auto output = ReadBenchmarkOutput(output_path);
+  for (auto &entry : output["benchmarks"]) {
+    if (!entry.contains("name") || entry.value("run_type", std::string("iteration")) != "iteration") {
+      continue;
+    }
+    const auto recorded = samples.find(BenchmarkRunKey(entry["name"].get<std::string>()));
+    if (recorded != samples.end()) {
+      entry["samples"] = recorded->second;
+    }
+  }
+  WriteBenchmarkOutput(output_path, output);
+}
+
+void ppc::util::AddContextToBenchmarkOutput(const std::string &output_path,
+                                            const std::map<std::string, std::string> &context) {
+  auto output = ReadBenchmarkOutput(output_path);
+  for (const auto &[key, value] : context) {
+    output["context"][key] = value;
+  }
+  WriteBenchmarkOutput(output_path, output);
+}
+
+std::string ppc::util::MakeRankOutputPath(const std::string &output_path, int rank) {
+  return ReplaceOutputExtension(output_path, ".rank" + std::to_string(rank));
+}
+
+std::string ppc::util::MakeMergedOutputPath(const std::string &output_path) {
+  return ReplaceOutputExtension(output_path, ".ranks");
+}
+
+void ppc::util::WriteMergedBenchmarkOutput(const std::string &merged_path,
+                                           const std::vector<std::string> &rank_outputs) {
+  nlohmann::json merged = {{"context", nlohmann::json::object()}, {"ranks", nlohmann::json::array()}};
+  for (std::size_t rank = 0; rank < rank_outputs.size(); ++rank) {
+    const auto output = nlohmann::json::parse(rank_outputs[rank], nullptr, false);
+    CheckBenchmarkOutput(output, "of rank " + std::to_string(rank));
+    const auto context = output.value("context", nlohmann::json::object());
+    if (rank == 0) {
+      merged["context"] = context;
+    }
+    merged["ranks"].push_back({{"rank", rank},
+                               {"host_name", context.value("host_name", std::string{})},
+                               {"benchmarks", output["benchmarks"]}});
+  }
+  WriteBenchmarkOutput(merged_path, merged);
+}
@@ -0,0 +1,96 @@
+#include "util/include/perf_stats.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <vector>
+
+namespace {
+
+// Two-sided 95% critical values of Student's t for 1..30 degrees of freedom.
+constexpr std::array<double, 30> kStudentT975 = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131,
+    2.120,  2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+}  // namespace
+
+double ppc::util::Quantile(std::span<const double> sorted, double q) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  const double position = std::clamp(q, 0.0, 1.0) * static_cast<double>(sorted.size() - 1);
+  const auto lower = static_cast<std::size_t>(position);
+  const std::size_t upper = std::min(lower + 1, sorted.size() - 1);
+  const double fraction = position - static_cast<double>(lower);
+  return sorted[lower] + (fraction * (sorted[upper] - sorted[lower]));
+}
+
+double ppc::util::StudentT975(std::size_t degrees_of_freedom) {
+  if (degrees_of_freedom == 0) {
+    return 0.0;
+  }
+  if (degrees_of_freedom <= kStudentT975.size()) {
+    return kStudentT975[degrees_of_freedom - 1];
+  }
+  // Cornish-Fisher expansion around the normal quantile, accurate to 1e-4 beyond 30 degrees of freedom.
+  constexpr double kZ = 1.959964;
+  constexpr double kZ2 = kZ * kZ;
+  const double df = static_cast<double>(degrees_of_freedom);
+  const double first = kZ * (kZ2 + 1.0) / 4.0;
+  const double second = kZ * ((5.0 * kZ2 * kZ2) + (16.0 * kZ2) + 3.0) / 96.0;
+  const double third = kZ * ((3.0 * kZ2 * kZ2 * kZ2) + (19.0 * kZ2 * kZ2) + (17.0 * kZ2) - 15.0) / 384.0;
+  return kZ + (first / df) + (second / (df * df)) + (third / (df * df * df));
+}
+
+ppc::util::SampleStats ppc::util::SummarizeSamples(std::span<const double> samples) {
+  SampleStats stats;
+  stats.count = samples.size();
+  if (samples.empty()) {
+    return stats;
+  }
+  std::vector<double> sorted(samples.begin(), samples.end());
+  std::ranges::sort(sorted);
+  stats.median = Quantile(sorted, 0.5);
+  stats.q1 = Quantile(sorted, 0.25);
+  stats.q3 = Quantile(sorted, 0.75);
+  stats.iqr = stats.q3 - stats.q1;
+
+  const double low_fence = stats.q1 - (1.5 * stats.iqr);
+  const double high_fence = stats.q3 + (1.5 * stats.iqr);
+  std::vector<double> inliers;
+  inliers.reserve(sorted.size());
+  std::ranges::copy_if(sorted, std::back_inserter(inliers),
+                       [&](double sample) -> bool { return sample >= low_fence && sample <= high_fence; });
+  stats.outliers = sorted.size() - inliers.size();
+
+  double sum = 0.0;
+  for (const double sample : inliers) {
+    sum += sample;
+  }
+  stats.mean = sum / static_cast<double>(inliers.size());
+  if (inliers.size() > 1) {
+    double squares = 0.0;
+    for (const double sample : inliers) {
+      squares += (sample - stats.mean) * (sample - stats.mean);
+    }
+    stats.stddev = std::sqrt(squares / static_cast<double>(inliers.size() - 1));
+  }
+  stats.cv = stats.mean > 0.0 ? stats.stddev / stats.mean : 0.0;
+  const double half_width =
+      StudentT975(inliers.size() - 1) * stats.stddev / std::sqrt(static_cast<double>(inliers.size()));
+  stats.ci_low = stats.mean - half_width;
+  stats.ci_high = stats.mean + half_width;
+  return stats;
+}
+
+bool ppc::util::IsPreciseEnough(const SampleStats &stats, double target_cv, double target_ci) {
+  if (stats.count - stats.outliers < 2 || stats.mean <= 0.0) {
+    return false;
+  }
+  const bool cv_met = target_cv > 0.0 && stats.cv <= target_cv;
+  const bool ci_met = target_ci > 0.0 && (stats.ci_high - stats.ci_low) / 2.0 <= target_ci * stats.mean;
+  return cv_met || ci_met;
+}
@@ -0,0 +1,323 @@
+#include "util/include/roofline.hpp"
+
+#include <mpi.h>
+#include <omp.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "oneapi/tbb/parallel_for.h"
+#include "oneapi/tbb/task_arena.h"
+#include "task/include/task.hpp"
+#include "util/include/util.hpp"
+
+namespace {
+
+using ppc::task::TypeOfTask;
+
+// Doubles per STREAM array and rank: 32 MiB each, larger than the last-level cache of common desktop CPUs.
+constexpr std::size_t kStreamElements = std::size_t{1} << 22;
+// Independent multiply-add chains per worker, enough to keep the vector units busy.
+constexpr std::size_t kFmaLanes = 32;
+constexpr std::size_t kFmaIterations = std::size_t{1} << 21;
+// Every kernel reports its fastest run.
+constexpr int kKernelRuns = 5;
+
+int WorldRank() {
+  int rank = 0;
+  if (ppc::util::IsMpiActive()) {
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  }
+  return rank;
+}
+
+int WorldSize() {
+  int size = 1;
+  if (ppc::util::IsMpiActive()) {
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+  }
+  return size;
+}
+
+bool UsesMpi(TypeOfTask backend) {
+  return backend == TypeOfTask::kMPI || backend == TypeOfTask::kALL;
+}
+
+int CountThreads(TypeOfTask backend, int num_threads) {
+  return backend == TypeOfTask::kSEQ || backend == TypeOfTask::kMPI ? 1 : std::max(num_threads, 1);
+}
+
+/// Calls body(worker) once for every worker, each on its own thread of the backend.
+void RunOnWorkers(TypeOfTask backend, int workers, const std::function<void(int)> &body) {
+  if (workers == 1) {
+    body(0);
+  } else if (backend == TypeOfTask::kOMP || backend == TypeOfTask::kALL) {
+#pragma omp parallel num_threads(workers)
+    body(omp_get_thread_num());
+  } else if (backend == TypeOfTask::kTBB) {
+    tbb::task_arena arena(workers);
+    arena.execute([&] -> void {
+      tbb::parallel_for(tbb::blocked_range<int>(0, workers, 1), [&](const tbb::blocked_range<int> &range) -> void {
+        for (int worker = range.begin(); worker != range.end(); ++worker) {
+          body(worker);
+        }
+      });
+    });
+  } else {
+    std::vector<std::jthread> threads;
+    threads.reserve(static_cast<std::size_t>(workers) - 1);
+    for (int worker = 1; worker < workers; ++worker) {
+      threads.emplace_back([&body, worker] -> void { body(worker); });
+    }
+    body(0);
+  }
+}
+
+/// Returns the fastest time of kKernelRuns runs, each timed on all ranks by the slowest one when MPI is used.
+double BestTime(TypeOfTask backend, int workers, const std::function<void(int)> &body) {
+  const bool use_mpi = UsesMpi(backend) && ppc::util::IsMpiActive();
+  double best = 0.0;
+  for (int run = 0; run < kKernelRuns; ++run) {
+    if (use_mpi) {
+      MPI_Barrier(MPI_COMM_WORLD);
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    RunOnWorkers(backend, workers, body);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    if (use_mpi) {
+      MPI_Allreduce(MPI_IN_PLACE, &elapsed, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    }
+    best = run == 0 ? elapsed : std::min(best, elapsed);
+  }
+  return best;
+}
+
+class StreamArrays {
+ public:
+  StreamArrays(TypeOfTask backend, int workers)
+      : backend_(backend), workers_(workers), a_(kStreamElements), b_(kStreamElements), c_(kStreamElements) {
+    // First touch by the workers that later stream through each chunk.
+    ForEachChunk([this](std::size_t begin, std::size_t end) -> void {
+      std::fill(a_.begin() + Offset(begin), a_.begin() + Offset(end), 1.0);
+      std::fill(b_.begin() + Offset(begin), b_.begin() + Offset(end), 2.0);
+      std::fill(c_.begin() + Offset(begin), c_.begin() + Offset(end), 0.0);
+    });
+  }
+
+  /// Returns the bandwidth in bytes per second of a kernel moving bytes_per_element per array element.
+  double Measure(double bytes_per_element, const std::function<void(std::size_t, std::size_t)> &kernel) {
+    const double elapsed = BestTime(backend_, workers_, [&](int worker) -> void {
+      const auto [begin, end] = Chunk(worker);
+      kernel(begin, end);
+    });
+    const double ranks = UsesMpi(backend_) ? static_cast<double>(WorldSize()) : 1.0;
+    return elapsed > 0.0 ? ranks * bytes_per_element * static_cast<double>(kStreamElements) / elapsed : 0.0;
+  }
+
+  std::vector<double> &A() {
+    return a_;
+  }
+  std::vector<double> &B() {
+    return b_;
+  }
+  std::vector<double> &C() {
+    return c_;
+  }
+
+ private:
+  static std::ptrdiff_t Offset(std::size_t index) {
+    return static_cast<std::ptrdiff_t>(index);
+  }
+
+  [[nodiscard]] std::array<std::size_t, 2> Chunk(int worker) const {
+    const auto workers = static_cast<std::size_t>(workers_);
+    const auto index = static_cast<std::size_t>(worker);
+    return {kStreamElements * index / workers, kStreamElements * (index + 1) / workers};
+  }
+
+  void ForEachChunk(const std::function<void(std::size_t, std::size_t)> &fill) {
+    RunOnWorkers(backend_, workers_, [&](int worker) -> void {
+      const auto [begin, end] = Chunk(worker);
+      fill(begin, end);
+    });
+  }
+
+  TypeOfTask backend_;
+  int workers_;
+  std::vector<double> a_;
+  std::vector<double> b_;
+  std::vector<double> c_;
+};
+
+double MeasurePeakFlops(TypeOfTask backend, int workers) {
+  std::vector<double> results(static_cast<std::size_t>(workers), 0.0);
+  const double elapsed = BestTime(backend, workers, [&results](int worker) -> void {
+    std::array<double, kFmaLanes> acc{};
+    for (std::size_t lane = 0; lane < kFmaLanes; ++lane) {
+      acc[lane] = results[static_cast<std::size_t>(worker)] + static_cast<double>(lane);
+    }
+    for (std::size_t iteration = 0; iteration < kFmaIterations; ++iteration) {
+      for (auto &value : acc) {
+        value = (value * 0.999999) + 1e-6;
+      }
+    }
+    double sum = 0.0;
+    for (const double value : acc) {
+      sum += value;
+    }
+    results[static_cast<std::size_t>(worker)] = sum;
+  });
+  // Keeps the chains observable so the kernel is not optimized away.
+  if (std::ranges::any_of(results, [](double value) -> bool { return value < 0.0; })) {
+    throw std::runtime_error("Roofline FLOP kernel produced an invalid result");
+  }
+  const double ranks = UsesMpi(backend) ? static_cast<double>(WorldSize()) : 1.0;
+  const double flops = 2.0 * static_cast<double>(kFmaLanes * kFmaIterations) * static_cast<double>(workers);
+  return elapsed > 0.0 ? ranks * flops / elapsed : 0.0;
+}
+
+nlohmann::json ReadCache(const std::string &cache_path) {
+  std::ifstream file(cache_path);
+  if (!file.is_open()) {
+    return nlohmann::json::object();
+  }
+  auto cache = nlohmann::json::parse(file, nullptr, false);
+  return cache.is_object() ? cache : nlohmann::json::object();
+}
+
+std::string HostName() {
+  if (!ppc::util::IsMpiActive()) {
+    return "localhost";
+  }
+  std::array<char, MPI_MAX_PROCESSOR_NAME> name{};
+  int length = 0;
+  MPI_Get_processor_name(name.data(), &length);
+  return {name.data(), static_cast<std::size_t>(length)};
+}
+
+}  // namespace
+
+ppc::util::RooflineCeilings ppc::util::MeasureRoofline(TypeOfTask backend, int num_threads) {
+  const int workers = CountThreads(backend, num_threads);
+  StreamArrays arrays(backend, workers);
+  auto &a = arrays.A();
+  auto &b = arrays.B();
+  auto &c = arrays.C();
+  constexpr double kScalar = 3.0;
+  RooflineCeilings ceilings;
+  ceilings.copy = arrays.Measure(2.0 * sizeof(double), [&](std::size_t begin, std::size_t end) -> void {
+    for (std::size_t i = begin; i < end; ++i) {
+      c[i] = a[i];
+    }
+  });
+  ceilings.scale = arrays.Measure(2.0 * sizeof(double), [&](std::size_t begin, std::size_t end) -> void {
+    for (std::size_t i = begin; i < end; ++i) {
+      b[i] = kScalar * c[i];
+    }
+  });
+  ceilings.add = arrays.Measure(3.0 * sizeof(double), [&](std::size_t begin, std::size_t end) -> void {
+    for (std::size_t i = begin; i < end; ++i) {
+      c[i] = a[i] + b[i];
+    }
+  });
+  ceilings.triad = arrays.Measure(3.0 * sizeof(double), [&](std::size_t begin, std::size_t end) -> void {
+    for (std::size_t i = begin; i < end; ++i) {
+      a[i] = b[i] + (kScalar * c[i]);
+    }
+  });
+  ceilings.flops = MeasurePeakFlops(backend, workers);
+  return ceilings;
+}
+
+std::string ppc::util::MakeRooflineKey(TypeOfTask backend, int num_threads) {
+  const int ranks = UsesMpi(backend) ? WorldSize() : 1;
+  return HostName() + "/" + std::string(ppc::task::TypeOfTaskToString(backend)) +
+         "/threads:" + std::to_string(CountThreads(backend, num_threads)) + "/procs:" + std::to_string(ranks);
+}
+
+std::optional<ppc::util::RooflineCeilings> ppc::util::LoadRoofline(const std::string &cache_path,
+                                                                   const std::string &key) {
+  const auto cache = ReadCache(cache_path);
+  const auto entry = cache.find(key);
+  if (entry == cache.end() || !entry->is_object()) {
+    return std::nullopt;
+  }
+  RooflineCeilings ceilings;
+  ceilings.copy = entry->value("copy", 0.0);
+  ceilings.scale = entry->value("scale", 0.0);
+  ceilings.add = entry->value("add", 0.0);
+  ceilings.triad = entry->value("triad", 0.0);
+  ceilings.flops = entry->value("flops", 0.0);
+  if (!ceilings.IsKnown()) {
+    return std::nullopt;
+  }
+  return ceilings;
+}
+
+void ppc::util::StoreRoofline(const std::string &cache_path, const std::string &key,
+                              const RooflineCeilings &ceilings) {
+  auto cache = ReadCache(cache_path);
+  cache[key] = {{"copy", ceilings.copy},
+                {"scale", ceilings.scale},
+                {"add", ceilings.add},
+                {"triad", ceilings.triad},
+                {"flops", ceilings.flops}};
+  const std::filesystem::path path(cache_path);
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path());
+  }
+  std::ofstream file(cache_path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to write the roofline cache " + cache_path);
+  }
+  file << cache.dump(2) << '\n';
+}
+
+ppc::util::RooflineCeilings ppc::util::GetRoofline(TypeOfTask backend, int num_threads,
+                                                   const std::string &cache_path) {
+  static std::map<std::string, RooflineCeilings> measured;
+  const auto key = MakeRooflineKey(backend, num_threads);
+  if (const auto known = measured.find(key); known != measured.end()) {
+    return known->second;
+  }
+  const bool root = WorldRank() == 0;
+  std::array<double, 5> values{};
+  if (root && !cache_path.empty()) {
+    if (const auto cached = LoadRoofline(cache_path, key)) {
+      values = {cached->copy, cached->scale, cached->add, cached->triad, cached->flops};
+    }
+  }
+  if (ppc::util::IsMpiActive()) {
+    MPI_Bcast(values.data(), static_cast<int>(values.size()), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  }
+  const bool cached = values.back() > 0.0;
+  if (!cached && (root || UsesMpi(backend))) {
+    const auto ceilings = MeasureRoofline(backend, num_threads);
+    values = {ceilings.copy, ceilings.scale, ceilings.add, ceilings.triad, ceilings.flops};
+  }
+  if (ppc::util::IsMpiActive()) {
+    MPI_Bcast(values.data(), static_cast<int>(values.size()), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+  }
+  RooflineCeilings ceilings;
+  ceilings.copy = values[0];
+  ceilings.scale = values[1];
+  ceilings.add = values[2];
+  ceilings.triad = values[3];
+  ceilings.flops = values[4];
+  if (!cached && root && !cache_path.empty()) {
+    StoreRoofline(cache_path, key, ceilings);
+  }
+  measured[key] = ceilings;
+  return ceilings;
+}
@@ -0,0 +1,263 @@
+#include "util/include/trace.hpp"
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "util/include/util.hpp"
+
+namespace {
+
+constexpr std::size_t kBufferCapacity = std::size_t{1} << 15;
+constexpr int kOffsetRounds = 8;
+constexpr int kOffsetTag = 7301;
+
+struct ThreadBuffer {
+  explicit ThreadBuffer(int index) : thread(index), events(kBufferCapacity) {}
+
+  int thread;
+  std::vector<ppc::util::TraceEvent> events;
+  /// Number of events written so far; only the owning thread writes it
+  std::atomic<uint64_t> head{0};
+};
+
+struct BufferRegistry {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+  /// Buffers of exited threads, reused by the next new thread
+  std::vector<ThreadBuffer *> free_buffers;
+};
+
+BufferRegistry &Registry() {
+  // Never destroyed, so worker threads that exit after main() can still return their buffers.
+  static auto *registry = new BufferRegistry();
+  return *registry;
+}
+
+ThreadBuffer *AcquireBuffer() {
+  auto &registry = Registry();
+  const std::scoped_lock lock(registry.mutex);
+  if (!registry.free_buffers.empty()) {
+    auto *buffer = registry.free_buffers.back();
+    registry.free_buffers.pop_back();
+    return buffer;
+  }
+  registry.buffers.push_back(std::make_unique<ThreadBuffer>(static_cast<int>(registry.buffers.size())));
+  return registry.buffers.back().get();
+}
+
+void ReleaseBuffer(ThreadBuffer *buffer) {
+  auto &registry = Registry();
+  const std::scoped_lock lock(registry.mutex);
+  registry.free_buffers.push_back(buffer);
+}
+
+/// Owns the calling thread's buffer for the lifetime of the thread.
+class BufferHolder {
+ public:
+  BufferHolder() = default;
+  BufferHolder(const BufferHolder &) = delete;
+  BufferHolder(BufferHolder &&) = delete;
+  BufferHolder &operator=(const BufferHolder &) = delete;
+  BufferHolder &operator=(BufferHolder &&) = delete;
+  ~BufferHolder() {
+    if (buffer_ != nullptr) {
+      ReleaseBuffer(buffer_);
+    }
+  }
+
+  ThreadBuffer &Get() {
+    if (buffer_ == nullptr) {
+      buffer_ = AcquireBuffer();
+    }
+    return *buffer_;
+  }
+
+ private:
+  ThreadBuffer *buffer_ = nullptr;
+};
+
+/// Returns this rank's clock minus rank 0's clock, estimated by rank 0 from the ping-pong with the shortest round
+/// trip, which bounds the error by half of that round trip.
+int64_t EstimateClockOffset(int rank, int num_ranks) {
+  int64_t own_offset = 0;
+  for (int peer = 1; peer < num_ranks; ++peer) {
+    if (rank == 0) {
+      int64_t best_round_trip = std::numeric_limits<int64_t>::max();
+      int64_t best_offset = 0;
+      for (int round = 0; round < kOffsetRounds; ++round) {
+        const int64_t sent = ppc::util::GetTraceClock();
+        MPI_Send(&sent, 1, MPI_INT64_T, peer, kOffsetTag, MPI_COMM_WORLD);
+        int64_t remote = 0;
+        MPI_Recv(&remote, 1, MPI_INT64_T, peer, kOffsetTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        const int64_t received = ppc::util::GetTraceClock();
+        if (received - sent < best_round_trip) {
+          best_round_trip = received - sent;
+          best_offset = remote - (sent + ((received - sent) / 2));
+        }
+      }
+      MPI_Send(&best_offset, 1, MPI_INT64_T, peer, kOffsetTag, MPI_COMM_WORLD);
+    } else if (rank == peer) {
+      for (int round = 0; round < kOffsetRounds; ++round) {
+        int64_t ping = 0;
+        MPI_Recv(&ping, 1, MPI_INT64_T, 0, kOffsetTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        const int64_t now = ppc::util::GetTraceClock();
+        MPI_Send(&now, 1, MPI_INT64_T, 0, kOffsetTag, MPI_COMM_WORLD);
+      }
+      MPI_Recv(&own_offset, 1, MPI_INT64_T, 0, kOffsetTag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+    }
+  }
+  return own_offset;
+}
+
+/// Collects the text of every rank on rank 0, in rank order; other ranks get an empty vector.
+std::vector<std::string> GatherOnRoot(const std::string &text, int rank, int num_ranks) {
+  if (num_ranks == 1) {
+    return {text};
+  }
+  const int size = static_cast<int>(text.size());
+  std::vector<int> sizes(static_cast<std::size_t>(num_ranks), 0);
+  MPI_Gather(&size, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+  std::vector<int> offsets(sizes.size(), 0);
+  for (std::size_t i = 1; i < sizes.size(); ++i) {
+    offsets[i] = offsets[i - 1] + sizes[i - 1];
+  }
+  std::string gathered(rank == 0 ? static_cast<std::size_t>(offsets.back() + sizes.back()) : 0, '\0');
+  MPI_Gatherv(text.data(), size, MPI_CHAR, gathered.data(), sizes.data(), offsets.data(), MPI_CHAR, 0,
+              MPI_COMM_WORLD);
+  if (rank != 0) {
+    return {};
+  }
+  std::vector<std::string> texts;
+  texts.reserve(sizes.size());
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    texts.push_back(gathered.substr(static_cast<std::size_t>(offsets[i]), static_cast<std::size_t>(sizes[i])));
+  }
+  return texts;
+}
+
+}  // namespace
+
+int64_t ppc::util::GetTraceClock() {
+  static const auto kEpoch = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - kEpoch).count();
+}
+
+void ppc::util::RecordTraceEvent(const TraceEvent &event) {
+  thread_local BufferHolder holder;
+  auto &buffer = holder.Get();
+  const uint64_t head = buffer.head.load(std::memory_order_relaxed);
+  buffer.events[head % kBufferCapacity] = event;
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+std::vector<ppc::util::ThreadTraceEvents> ppc::util::CollectTraceEvents() {
+  auto &registry = Registry();
+  const std::scoped_lock lock(registry.mutex);
+  std::vector<ThreadTraceEvents> threads;
+  for (const auto &buffer : registry.buffers) {
+    const uint64_t head = buffer->head.load(std::memory_order_acquire);
+    if (head == 0) {
+      continue;
+    }
+    const uint64_t count = std::min<uint64_t>(head, kBufferCapacity);
+    ThreadTraceEvents thread{.thread = buffer->thread, .events = {}, .dropped = head - count};
+    thread.events.reserve(count);
+    for (uint64_t i = head - count; i < head; ++i) {
+      thread.events.push_back(buffer->events[i % kBufferCapacity]);
+    }
+    threads.push_back(std::move(thread));
+  }
+  return threads;
+}
+
+void ppc::util::ClearTraceEvents() {
+  auto &registry = Registry();
+  const std::scoped_lock lock(registry.mutex);
+  for (const auto &buffer : registry.buffers) {
+    buffer->head.store(0, std::memory_order_release);
+  }
+}
+
+std::string ppc::util::FormatChromeTraceEvents(const std::vector<ThreadTraceEvents> &threads, int rank,
+                                               int64_t offset_ns) {
+  constexpr double kNanosecondsPerMicrosecond = 1000.0;
+  auto events = nlohmann::json::array();
+  events.push_back({{"name", "process_name"},
+                    {"ph", "M"},
+                    {"pid", rank},
+                    {"tid", 0},
+                    {"args", {{"name", "rank " + std::to_string(rank)}}}});
+  for (const auto &thread : threads) {
+    events.push_back({{"name", "thread_name"},
+                      {"ph", "M"},
+                      {"pid", rank},
+                      {"tid", thread.thread},
+                      {"args", {{"name", "thread " + std::to_string(thread.thread)}, {"dropped", thread.dropped}}}});
+    for (const auto &event : thread.events) {
+      events.push_back(
+          {{"name", event.name != nullptr ? event.name : ""},
+           {"cat", event.category != nullptr ? event.category : ""},
+           {"ph", "X"},
+           {"pid", rank},
+           {"tid", thread.thread},
+           {"ts", static_cast<double>(event.begin_ns - offset_ns) / kNanosecondsPerMicrosecond},
+           {"dur", static_cast<double>(event.end_ns - event.begin_ns) / kNanosecondsPerMicrosecond}});
+    }
+  }
+  return events.dump();
+}
+
+void ppc::util::WriteTrace(const std::string &path) {
+  int rank = 0;
+  int num_ranks = 1;
+  if (ppc::util::IsMpiActive()) {
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+  }
+  const int64_t offset = EstimateClockOffset(rank, num_ranks);
+  const auto local_events = FormatChromeTraceEvents(CollectTraceEvents(), rank, offset);
+  ClearTraceEvents();
+  const auto rank_events = GatherOnRoot(local_events, rank, num_ranks);
+  if (rank != 0) {
+    return;
+  }
+  nlohmann::json trace = {{"traceEvents", nlohmann::json::array()}, {"displayTimeUnit", "ms"}};
+  for (const auto &text : rank_events) {
+    for (auto &event : nlohmann::json::parse(text)) {
+      trace["traceEvents"].push_back(std::move(event));
+    }
+  }
+  const std::filesystem::path trace_path(path);
+  if (trace_path.has_parent_path()) {
+    std::filesystem::create_directories(trace_path.parent_path());
+  }
+  std::ofstream file(trace_path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to write trace " + path);
+  }
+  file << trace.dump() << '\n';
+}
+
+void ppc::util::WriteTestTrace(const std::string &file_name) {
+  if constexpr (!kTracingEnabled) {
+    return;
+  }
+  const auto tmp_dir = env::get<std::string>("PPC_TEST_TMPDIR");
+  if (!tmp_dir.has_value()) {
+    return;
+  }
+  WriteTrace((std::filesystem::path(tmp_dir.value()) / file_name).string());
+}
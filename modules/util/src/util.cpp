@@ -8,6 +8,8 @@
 #include <libenvpp/detail/get.hpp>
 #include <string>
 
+#include "util/include/trace.hpp"
+
 namespace {
 
 std::string GetAbsolutePath(const std::string &relative_path) {
@@ -77,17 +79,19 @@ void ppc::util::ConfigureMpiEnvironment() {
 #endif
 }
 
-void ppc::util::SynchronizeMpiRanks() {
+bool ppc::util::IsMpiActive() {
   int initialized = 0;
-  if (MPI_Initialized(&initialized) != MPI_SUCCESS || initialized == 0) {
-    return;
-  }
-
   int finalized = 0;
-  if (MPI_Finalized(&finalized) != MPI_SUCCESS || finalized != 0) {
+  return MPI_Initialized(&initialized) == MPI_SUCCESS && initialized != 0 &&
+         MPI_Finalized(&finalized) == MPI_SUCCESS && finalized == 0;
+}
+
+void ppc::util::SynchronizeMpiRanks() {
+  if (!IsMpiActive()) {
     return;
   }
 
+  PPC_TRACE_SCOPE_CATEGORY("MPI_Barrier", "mpi");
   const int barrier_res = MPI_Barrier(MPI_COMM_WORLD);
   if (barrier_res != MPI_SUCCESS) {
     MPI_Abort(MPI_COMM_WORLD, barrier_res);
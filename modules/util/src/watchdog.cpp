@@ -0,0 +1,176 @@
+#include "util/include/watchdog.hpp"
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <libenvpp/detail/get.hpp>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "util/include/util.hpp"
+
+namespace {
+
+bool IsTimeLimitIgnored() {
+  const auto ignore = env::get<int>("PPC_IGNORE_TEST_TIME_LIMIT");
+  return ignore.has_value() && ignore.value() != 0;
+}
+
+int CurrentRank() {
+  int rank = 0;
+  if (ppc::util::IsMpiActive()) {
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  }
+  return rank;
+}
+
+/// MPI_Abort runs on the watchdog thread, which MPI only permits from MPI_THREAD_SERIALIZED upwards.
+bool CanAbortThroughMpi() {
+  int provided = MPI_THREAD_SINGLE;
+  return ppc::util::IsMpiActive() && MPI_Query_thread(&provided) == MPI_SUCCESS &&
+         provided >= MPI_THREAD_SERIALIZED;
+}
+
+std::string StageLabel(std::string_view owner, std::string_view stage) {
+  return std::format("{} task stage {}", owner, stage);
+}
+
+[[noreturn]] void AbortJob(bool through_mpi) {
+  std::cerr.flush();
+  if (through_mpi && ppc::util::IsMpiActive()) {
+    MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+  }
+  std::_Exit(EXIT_FAILURE);
+}
+
+}  // namespace
+
+ppc::util::Watchdog::~Watchdog() {
+  if (thread_.joinable()) {
+    thread_.request_stop();
+    changed_.notify_all();
+    thread_.join();
+  }
+}
+
+ppc::util::Watchdog &ppc::util::Watchdog::Instance() {
+  static Watchdog watchdog;
+  return watchdog;
+}
+
+ppc::util::Watchdog::Handle ppc::util::Watchdog::Register() {
+  if (IsTimeLimitIgnored()) {
+    return 0;
+  }
+  const int rank = CurrentRank();
+  const bool mpi_abort = CanAbortThroughMpi();
+  std::scoped_lock lock(mutex_);
+  EnsureThreadStarted();
+  const Handle handle = next_handle_++;
+  entries_.emplace(handle, Entry{.rank = rank, .mpi_abort = mpi_abort});
+  return handle;
+}
+
+void ppc::util::Watchdog::Unregister(Handle handle) {
+  if (handle == 0) {
+    return;
+  }
+  std::scoped_lock lock(mutex_);
+  entries_.erase(handle);
+}
+
+void ppc::util::Watchdog::Start(Handle handle, std::string_view owner, std::string_view stage, double budget_seconds,
+                                const std::stop_source &stop_source) {
+  if (handle == 0 || budget_seconds <= 0.0) {
+    return;
+  }
+  const auto budget = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(budget_seconds));
+  const auto grace = std::max<Clock::duration>(budget, kMinGracePeriod);
+  const auto now = Clock::now();
+
+  bool wake_thread = false;
+  {
+    std::scoped_lock lock(mutex_);
+    auto &entry = entries_.at(handle);
+    entry.owner = owner;
+    entry.stage = stage;
+    entry.budget_seconds = budget_seconds;
+    entry.deadline = now + budget;
+    entry.abort_deadline = now + budget + grace;
+    entry.expired = false;
+    if (entry.stop_source != stop_source) {
+      entry.stop_source = stop_source;
+    }
+    // The thread re-plans whenever it wakes up, so it only needs a nudge for a deadline before its next check.
+    if (entry.deadline < wake_up_) {
+      wake_up_ = entry.deadline;
+      replan_ = true;
+      wake_thread = true;
+    }
+  }
+  if (wake_thread) {
+    changed_.notify_all();
+  }
+}
+
+void ppc::util::Watchdog::Stop(Handle handle) {
+  if (handle == 0) {
+    return;
+  }
+  std::scoped_lock lock(mutex_);
+  auto &entry = entries_.at(handle);
+  entry.deadline = Clock::time_point::max();
+  entry.abort_deadline = Clock::time_point::max();
+  entry.expired = false;
+}
+
+void ppc::util::Watchdog::EnsureThreadStarted() {
+  if (!thread_.joinable()) {
+    thread_ = std::jthread([this](const std::stop_token &thread_stop) -> void { ThreadLoop(thread_stop); });
+  }
+}
+
+void ppc::util::Watchdog::ThreadLoop(const std::stop_token &thread_stop) {
+  std::unique_lock lock(mutex_);
+  while (!thread_stop.stop_requested()) {
+    wake_up_ = NextWakeUp();
+    replan_ = false;
+    if (wake_up_ == Clock::time_point::max()) {
+      changed_.wait(lock, thread_stop, [this] -> bool { return replan_; });
+    } else {
+      changed_.wait_until(lock, thread_stop, wake_up_, [this] -> bool { return replan_; });
+    }
+    CheckDeadlines(Clock::now());
+  }
+}
+
+ppc::util::Watchdog::Clock::time_point ppc::util::Watchdog::NextWakeUp() const {
+  auto wake_up = Clock::time_point::max();
+  for (const auto &[handle, entry] : entries_) {
+    wake_up = std::min(wake_up, entry.expired ? entry.abort_deadline : entry.deadline);
+  }
+  return wake_up;
+}
+
+void ppc::util::Watchdog::CheckDeadlines(Clock::time_point now) {
+  for (auto &[handle, entry] : entries_) {
+    if (!entry.expired && now >= entry.deadline) {
+      entry.expired = true;
+      entry.stop_source.request_stop();
+      std::cerr << std::format("[  PROCESS {}  ] [  TIMEOUT  ] {} exceeded its {} s budget; stop requested\n",
+                               entry.rank, StageLabel(entry.owner, entry.stage), entry.budget_seconds);
+    }
+    if (entry.expired && now >= entry.abort_deadline) {
+      std::cerr << std::format("[  PROCESS {}  ] [  TIMEOUT  ] {} ignored the stop request; aborting the job\n",
+                               entry.rank, StageLabel(entry.owner, entry.stage));
+      AbortJob(entry.mpi_abort);
+    }
+  }
+}
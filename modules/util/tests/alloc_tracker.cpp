@@ -0,0 +1,138 @@
+#include "util/include/alloc_tracker.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <libenvpp/detail/environment.hpp>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "task/include/task.hpp"
+
+namespace {
+
+class AllocatingTask : public ppc::task::Task<int, int> {
+ public:
+  explicit AllocatingTask(int items) {
+    GetInput() = items;
+  }
+
+ protected:
+  bool ValidationImpl() override {
+    return GetInput() >= 0;
+  }
+  bool PreProcessingImpl() override {
+    return true;
+  }
+  bool RunImpl() override {
+    int sum = 0;
+    for (int i = 0; i < GetInput(); ++i) {
+      // The pattern the tracker is meant to find: a temporary buffer in the innermost loop.
+      const std::vector<int> tmp(64, i);
+      sum += tmp.back();
+    }
+    GetOutput() = sum;
+    return true;
+  }
+  bool PostProcessingImpl() override {
+    return true;
+  }
+};
+
+}  // namespace
+
+TEST(AllocTracker, MeasurementCountsAllocationsBytesAndPeak) {
+  if constexpr (!ppc::util::kAllocTrackingEnabled) {
+    GTEST_SKIP() << "Built without PPC_ENABLE_ALLOC_TRACKING";
+  }
+  const ppc::util::AllocationMeasurement measurement;
+  {
+    const auto first = std::make_unique<std::byte[]>(4096);
+    const auto second = std::make_unique<std::byte[]>(4096);
+  }
+  const auto third = std::make_unique<std::byte[]>(1024);
+  const auto stats = measurement.Stop();
+  EXPECT_EQ(stats.allocations, 3U);
+  EXPECT_GE(stats.bytes, 4096U + 4096U + 1024U);
+  EXPECT_GE(stats.peak_live_bytes, 8192U);
+  EXPECT_LT(stats.peak_live_bytes, stats.bytes);
+  ASSERT_EQ(stats.threads.size(), 1U);
+  EXPECT_EQ(stats.threads[0].allocations, 3U);
+}
+
+TEST(AllocTracker, MeasurementSeparatesThreads) {
+  if constexpr (!ppc::util::kAllocTrackingEnabled) {
+    GTEST_SKIP() << "Built without PPC_ENABLE_ALLOC_TRACKING";
+  }
+  std::vector<int> *leaked_by_worker = nullptr;
+  // The thread object is created outside the measurement; only the worker's own allocations are counted.
+  std::thread worker;
+  const ppc::util::AllocationMeasurement measurement;
+  worker = std::thread([&leaked_by_worker] -> void {
+    auto values = std::make_unique<std::vector<int>>(1000, 1);
+    leaked_by_worker = values.release();
+  });
+  worker.join();
+  const auto stats = measurement.Stop();
+  const std::unique_ptr<std::vector<int>> owner(leaked_by_worker);
+  uint64_t worker_allocations = 0;
+  for (const auto &thread : stats.threads) {
+    if (thread.bytes >= 4000) {
+      worker_allocations = thread.allocations;
+      EXPECT_GE(thread.peak_live_bytes, 4000U);
+    }
+  }
+  EXPECT_GE(worker_allocations, 2U);
+}
+
+TEST(AllocTracker, OverlappingMeasurementsKeepTheirOwnPeaks) {
+  if constexpr (!ppc::util::kAllocTrackingEnabled) {
+    GTEST_SKIP() << "Built without PPC_ENABLE_ALLOC_TRACKING";
+  }
+  const ppc::util::AllocationMeasurement outer;
+  {
+    const auto buffer = std::make_unique<std::byte[]>(8192);
+  }
+  uint64_t inner_peak = 0;
+  {
+    const ppc::util::AllocationMeasurement inner;
+    const auto buffer = std::make_unique<std::byte[]>(1024);
+    inner_peak = inner.Stop().peak_live_bytes;
+  }
+  EXPECT_GE(inner_peak, 1024U);
+  EXPECT_LT(inner_peak, 8192U);
+  EXPECT_GE(outer.Stop().peak_live_bytes, 8192U);
+}
+
+TEST(AllocTracker, TaskReportsRunAllocations) {
+  AllocatingTask task(10);
+  ASSERT_TRUE(task.Validation());
+  ASSERT_TRUE(task.PreProcessing());
+  ASSERT_TRUE(task.Run());
+  ASSERT_TRUE(task.PostProcessing());
+  const auto &run = task.GetStageMetrics().run.allocations;
+  if constexpr (ppc::util::kAllocTrackingEnabled) {
+    EXPECT_EQ(run.allocations, 10U);
+    EXPECT_GE(run.bytes, 10U * 64U * sizeof(int));
+  } else {
+    EXPECT_EQ(run.allocations, 0U);
+    EXPECT_TRUE(run.threads.empty());
+  }
+}
+
+TEST(AllocTracker, RunBudgetIsReadFromTheEnvironment) {
+  EXPECT_FALSE(ppc::util::GetRunAllocationBudget().has_value());
+  env::detail::set_scoped_environment_variable scoped("PPC_RUN_ALLOC_BUDGET", "4");
+  EXPECT_EQ(ppc::util::GetRunAllocationBudget(), 4U);
+
+  const ppc::util::AllocationStats run{.allocations = 10, .bytes = 640, .peak_live_bytes = 64, .threads = {}};
+  EXPECT_NO_THROW(ppc::util::CheckRunAllocationBudget(run, 5));
+  if constexpr (ppc::util::kAllocTrackingEnabled) {
+    EXPECT_THROW(ppc::util::CheckRunAllocationBudget(run), std::runtime_error);
+  } else {
+    EXPECT_NO_THROW(ppc::util::CheckRunAllocationBudget(run));
+  }
+}
@@ -0,0 +1,144 @@
+#include "util/include/mpi_profile.hpp"
+
+#include <gtest/gtest.h>
+#include <mpi.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "task/include/task.hpp"
+#include "util/include/perf_test_util.hpp"
+
+namespace {
+
+class AllreduceTask : public ppc::task::Task<int, int> {
+ public:
+  explicit AllreduceTask(int value) {
+    GetInput() = value;
+  }
+
+ protected:
+  bool ValidationImpl() override {
+    return true;
+  }
+  bool PreProcessingImpl() override {
+    return true;
+  }
+  bool RunImpl() override {
+    int sum = 0;
+    MPI_Allreduce(&GetInput(), &sum, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    GetOutput() = sum;
+    return true;
+  }
+  bool PostProcessingImpl() override {
+    return true;
+  }
+};
+
+}  // namespace
+
+TEST(MpiProfile, MeasurementReturnsTheCallsRecordedSinceItsStart) {
+  ppc::util::RecordMpiCall(ppc::util::MpiCallKind::kWait, 0, 1.0);
+  const ppc::util::MpiProfileMeasurement measurement;
+  ppc::util::RecordMpiCall(ppc::util::MpiCallKind::kPointToPoint, 64, 0.25);
+  ppc::util::RecordMpiCall(ppc::util::MpiCallKind::kPointToPoint, 32, 0.25);
+  ppc::util::RecordMpiCall(ppc::util::MpiCallKind::kCollective, 8, 0.5);
+  const auto profile = measurement.Stop();
+  EXPECT_EQ(profile.Get(ppc::util::MpiCallKind::kPointToPoint).calls, 2U);
+  EXPECT_EQ(profile.Get(ppc::util::MpiCallKind::kPointToPoint).bytes, 96U);
+  EXPECT_EQ(profile.Get(ppc::util::MpiCallKind::kCollective).calls, 1U);
+  EXPECT_EQ(profile.Get(ppc::util::MpiCallKind::kWait).calls, 0U);
+  EXPECT_NEAR(profile.CommunicationTime(), 1.0, 1e-6);
+  EXPECT_NEAR(profile.WaitTime(), 0.0, 1e-6);
+}
+
+TEST(MpiProfile, TaskReportsTheCollectivesOfRun) {
+  if (!ppc::util::IsMpiActive()) {
+    GTEST_SKIP() << "MPI is not initialized";
+  }
+  AllreduceTask task(1);
+  ASSERT_TRUE(task.Validation());
+  ASSERT_TRUE(task.PreProcessing());
+  ASSERT_TRUE(task.Run());
+  ASSERT_TRUE(task.PostProcessing());
+  int size = 1;
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  EXPECT_EQ(task.GetOutput(), size);
+  const auto &run = task.GetStageMetrics().run.mpi_profile.Get(ppc::util::MpiCallKind::kCollective);
+  if constexpr (ppc::util::kMpiProfilingEnabled) {
+    EXPECT_EQ(run.calls, 1U);
+    EXPECT_EQ(run.bytes, 2 * sizeof(int));
+  } else {
+    EXPECT_EQ(run.calls, 0U);
+  }
+  EXPECT_EQ(task.GetStageMetrics().validation.mpi_profile.Get(ppc::util::MpiCallKind::kCollective).calls, 0U);
+}
+
+TEST(MpiProfile, MessageSizeClassesArePowersOfTwo) {
+  EXPECT_EQ(ppc::util::MessageSizeClass(0), 0U);
+  EXPECT_EQ(ppc::util::MessageSizeClass(1), 1U);
+  EXPECT_EQ(ppc::util::MessageSizeClass(3), 2U);
+  EXPECT_EQ(ppc::util::MessageSizeClass(1024), 11U);
+  EXPECT_EQ(ppc::util::MessageSizeClass(UINT64_MAX), ppc::util::kNumMessageSizeClasses - 1);
+  EXPECT_EQ(ppc::util::MessageSizeClassLabel(0), "0");
+  EXPECT_EQ(ppc::util::MessageSizeClassLabel(10), "512");
+  EXPECT_EQ(ppc::util::MessageSizeClassLabel(11), "1K");
+  EXPECT_EQ(ppc::util::MessageSizeClassLabel(22), "2M");
+}
+
+TEST(MpiProfile, TrafficIsOnlyRecordedInsideScopes) {
+  const ppc::util::MpiTrafficMeasurement measurement;
+  ppc::util::RecordMpiCall(ppc::util::MpiCallKind::kPointToPoint, 100, 0.0);
+  {
+    const ppc::util::MpiTrafficScope scope;
+    ppc::util::RecordMpiCall(ppc::util::MpiCallKind::kPointToPoint, 100, 0.0);
+    ppc::util::RecordMpiCall(ppc::util::MpiCallKind::kCollective, 0, 0.0);
+    ppc::util::RecordMpiMessage(0, 100);
+  }
+  const auto traffic = measurement.Stop();
+  const auto &p2p = traffic.message_sizes.at(static_cast<std::size_t>(ppc::util::MpiCallKind::kPointToPoint));
+  const auto &collective = traffic.message_sizes.at(static_cast<std::size_t>(ppc::util::MpiCallKind::kCollective));
+  EXPECT_EQ(p2p.at(ppc::util::MessageSizeClass(100)), 1U);
+  EXPECT_EQ(collective.at(0), 1U);
+  ASSERT_FALSE(traffic.bytes.empty());
+  EXPECT_EQ(traffic.messages[0], 1U);
+  EXPECT_EQ(traffic.bytes[0], 100U);
+}
+
+TEST(MpiProfile, CommReportShowsTrafficFunneledThroughRoot) {
+  ppc::util::MpiCommReport report{.ranks = 3, .messages = std::vector<uint64_t>(9), .bytes = std::vector<uint64_t>(9)};
+  // Ranks 1 and 2 send to rank 0, rank 0 sends a little to rank 1.
+  report.messages = {0, 1, 0, 4, 0, 0, 4, 0, 0};
+  report.bytes = {0, 64, 0, 4096, 0, 0, 2048, 0, 0};
+  report.message_sizes.at(static_cast<std::size_t>(ppc::util::MpiCallKind::kPointToPoint))
+      .at(ppc::util::MessageSizeClass(1024)) = 6;
+  EXPECT_EQ(report.BytesBetween(1, 0), 4096U);
+
+  const auto json = nlohmann::json::parse(ppc::util::FormatMpiCommReportJson(report));
+  EXPECT_EQ(json["ranks"], 3);
+  EXPECT_EQ(json["bytes"][2][0], 2048);
+  EXPECT_EQ(json["messages"][1][0], 4);
+  ASSERT_EQ(json["message_sizes"]["p2p"].size(), 1U);
+  EXPECT_EQ(json["message_sizes"]["p2p"][0]["min_bytes"], 1024);
+  EXPECT_EQ(json["message_sizes"]["p2p"][0]["calls"], 6);
+  EXPECT_TRUE(json["message_sizes"]["collective"].empty());
+
+  const auto heatmap = ppc::util::FormatMpiCommHeatmap(report, "ring");
+  EXPECT_NE(heatmap.find("MPI traffic of ring"), std::string::npos);
+  EXPECT_NE(heatmap.find("busiest rank 0: sends 1% and receives 99%"), std::string::npos);
+  EXPECT_NE(heatmap.find("p2p"), std::string::npos);
+  EXPECT_NE(heatmap.find("1K:6"), std::string::npos);
+}
+
+TEST(MpiProfile, CommReportOfOneProcessNeedsNoMpi) {
+  if (ppc::util::IsMpiActive()) {
+    GTEST_SKIP() << "MPI is initialized";
+  }
+  ppc::util::MpiTraffic traffic{.messages = {2}, .bytes = {16}};
+  const auto report = ppc::util::GatherMpiCommReport(traffic);
+  EXPECT_EQ(report.ranks, 1);
+  EXPECT_EQ(report.BytesBetween(0, 0), 16U);
+}
@@ -0,0 +1,47 @@
+#include "util/include/perf_calibration.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+TEST(PerfCalibration, GrowsGeometricallyAndBisectsToTheTarget) {
+  int runs = 0;
+  const int64_t size = ppc::util::CalibrateSize(10, 1.0, [&runs](int64_t candidate) -> double {
+    ++runs;
+    return static_cast<double>(candidate) * 1e-3;
+  });
+  EXPECT_NEAR(static_cast<double>(size), 1000.0, 50.0);
+  EXPECT_LT(runs, 20);
+}
+
+TEST(PerfCalibration, ShrinksWhenTheStartSizeIsTooSlow) {
+  const int64_t size = ppc::util::CalibrateSize(
+      1 << 20, 0.5, [](int64_t candidate) -> double { return static_cast<double>(candidate * candidate) * 1e-6; });
+  EXPECT_NEAR(static_cast<double>(size), 707.0, 40.0);
+}
+
+TEST(PerfCalibration, StopsWhenTheTimeDoesNotDependOnTheSize) {
+  int runs = 0;
+  const int64_t size = ppc::util::CalibrateSize(1, 1.0, [&runs](int64_t /*candidate*/) -> double {
+    ++runs;
+    return 1e-3;
+  });
+  EXPECT_GE(size, 1);
+  EXPECT_LE(runs, 64);
+}
+
+TEST(PerfCalibration, CacheKeepsSizesPerKeyAndTargetTime) {
+  const auto cache = std::filesystem::temp_directory_path() / "ppc_perf_calibration_test" / "sizes.json";
+  std::filesystem::remove(cache);
+  EXPECT_EQ(ppc::util::LoadCalibratedSize(cache.string(), "example_threads", 1.0), std::nullopt);
+
+  ppc::util::StoreCalibratedSize(cache.string(), "example_threads", 1.0, 123);
+  ppc::util::StoreCalibratedSize(cache.string(), "example_processes", 2.0, 45);
+  EXPECT_EQ(ppc::util::LoadCalibratedSize(cache.string(), "example_threads", 1.0), 123);
+  EXPECT_EQ(ppc::util::LoadCalibratedSize(cache.string(), "example_processes", 2.0), 45);
+  EXPECT_EQ(ppc::util::LoadCalibratedSize(cache.string(), "example_threads", 2.0), std::nullopt);
+  std::filesystem::remove_all(cache.parent_path());
+}
@@ -0,0 +1,86 @@
+#include "util/include/perf_counters.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+
+namespace {
+
+using ppc::util::PerfCounterKind;
+using ppc::util::PerfCounters;
+using ppc::util::PerfCounterValues;
+
+PerfCounterValues MakeValues(double cycles, double page_faults) {
+  PerfCounterValues values;
+  values.values.at(static_cast<std::size_t>(PerfCounterKind::kCycles)) = cycles;
+  values.available.at(static_cast<std::size_t>(PerfCounterKind::kCycles)) = true;
+  values.values.at(static_cast<std::size_t>(PerfCounterKind::kPageFaults)) = page_faults;
+  values.available.at(static_cast<std::size_t>(PerfCounterKind::kPageFaults)) = true;
+  return values;
+}
+
+}  // namespace
+
+TEST(PerfCounters, DeltaKeepsOnlyKindsAvailableInBothReadings) {
+  auto after = MakeValues(300.0, 12.0);
+  after.available.at(static_cast<std::size_t>(PerfCounterKind::kCycles)) = false;
+  const auto delta = PerfCounterValues::Delta(MakeValues(100.0, 10.0), after);
+  EXPECT_FALSE(delta.Has(PerfCounterKind::kCycles));
+  EXPECT_DOUBLE_EQ(delta.Get(PerfCounterKind::kCycles), 0.0);
+  EXPECT_TRUE(delta.Has(PerfCounterKind::kPageFaults));
+  EXPECT_DOUBLE_EQ(delta.Get(PerfCounterKind::kPageFaults), 2.0);
+  EXPECT_FALSE(delta.Has(PerfCounterKind::kInstructions));
+}
+
+TEST(PerfCounters, SumsKeepKindsAvailableInEitherReading) {
+  PerfCounterValues total;
+  total += MakeValues(100.0, 1.0);
+  total += MakeValues(50.0, 2.0);
+  EXPECT_TRUE(total.Has(PerfCounterKind::kCycles));
+  EXPECT_DOUBLE_EQ(total.Get(PerfCounterKind::kCycles), 150.0);
+  EXPECT_DOUBLE_EQ(total.Get(PerfCounterKind::kPageFaults), 3.0);
+}
+
+TEST(PerfCounters, RusageFallbackCountsPageFaultsOfTouchedMemory) {
+  const PerfCounters counters(false);
+  EXPECT_FALSE(counters.HasHardwareEvents());
+  const auto before = counters.Read();
+  ASSERT_TRUE(before.Has(PerfCounterKind::kPageFaults));
+  ASSERT_TRUE(before.Has(PerfCounterKind::kContextSwitches));
+  EXPECT_FALSE(before.Has(PerfCounterKind::kCycles));
+
+  constexpr std::size_t kBytes = std::size_t{64} << 20U;
+  constexpr std::size_t kPageSize = 4096;
+  const auto memory = std::make_unique<char[]>(kBytes);
+  for (std::size_t i = 0; i < kBytes; i += kPageSize) {
+    memory[i] = 1;
+  }
+  const auto delta = PerfCounterValues::Delta(before, counters.Read());
+  EXPECT_GT(delta.Get(PerfCounterKind::kPageFaults), 0.0);
+}
+
+TEST(PerfCounters, PerfEventsReportEveryKindAsAvailableOrNot) {
+  const PerfCounters counters;
+  const auto values = counters.Read();
+  // Context switches and page faults come from perf_event_open or getrusage(), whichever is permitted.
+  EXPECT_TRUE(values.Has(PerfCounterKind::kContextSwitches));
+  EXPECT_TRUE(values.Has(PerfCounterKind::kPageFaults));
+  EXPECT_EQ(counters.HasHardwareEvents(),
+            values.Has(PerfCounterKind::kCycles) && values.Has(PerfCounterKind::kInstructions));
+}
+
+TEST(PerfCounters, ActiveScopeRestoresThePreviousCounters) {
+  EXPECT_EQ(PerfCounters::Active(), nullptr);
+  const PerfCounters outer(false);
+  const PerfCounters inner(false);
+  {
+    const ppc::util::ActivePerfCountersScope outer_scope(outer);
+    {
+      const ppc::util::ActivePerfCountersScope inner_scope(inner);
+      EXPECT_EQ(PerfCounters::Active(), &inner);
+    }
+    EXPECT_EQ(PerfCounters::Active(), &outer);
+  }
+  EXPECT_EQ(PerfCounters::Active(), nullptr);
+}
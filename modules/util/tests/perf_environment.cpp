@@ -0,0 +1,23 @@
+#include "util/include/perf_environment.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+TEST(PerfEnvironment, CaptureReportsEveryKey) {
+  const auto environment = ppc::util::CaptureMachineEnvironment();
+  for (const std::string key : {"cpu_model", "cpu_governor", "cpu_cur_freq_mhz", "load_average", "smt"}) {
+    ASSERT_TRUE(environment.contains(key)) << key;
+    EXPECT_FALSE(environment.at(key).empty()) << key;
+  }
+}
+
+TEST(PerfEnvironment, NoiseKernelTakesMeasurableTime) {
+  EXPECT_GT(ppc::util::MeasureNoiseKernel(), 0.0);
+}
+
+TEST(PerfEnvironment, DriftIsRelativeToTheFasterRun) {
+  EXPECT_DOUBLE_EQ(ppc::util::NoiseKernelDrift(0.1, 0.12), 0.2);
+  EXPECT_DOUBLE_EQ(ppc::util::NoiseKernelDrift(0.12, 0.1), 0.2);
+  EXPECT_DOUBLE_EQ(ppc::util::NoiseKernelDrift(0.0, 0.1), 0.0);
+}
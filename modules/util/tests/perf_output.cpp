@@ -0,0 +1,92 @@
+#include "util/include/perf_output.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "util/include/util.hpp"
+
+TEST(PerfOutput, RunKeyDropsOnlyTheSuffixesAddedByGoogleBenchmark) {
+  EXPECT_EQ(ppc::util::BenchmarkRunKey("example_threads_omp_enabled/iterations:5/manual_time"),
+            "example_threads_omp_enabled");
+  EXPECT_EQ(ppc::util::BenchmarkRunKey("example_threads_omp_enabled/mode:warm/size:64/iterations:1/repeats:3"),
+            "example_threads_omp_enabled/mode:warm/size:64");
+  EXPECT_EQ(ppc::util::BenchmarkRunKey("example_processes_mpi_enabled"), "example_processes_mpi_enabled");
+}
+
+TEST(PerfOutput, SamplesAreAttachedToMatchingIterationEntries) {
+  const auto path = std::filesystem::temp_directory_path() / "ppc_perf_output_test.json";
+  {
+    std::ofstream file(path);
+    file << R"({"context": {}, "benchmarks": [
+      {"name": "task_seq_enabled/iterations:2/manual_time", "run_type": "iteration"},
+      {"name": "task_seq_enabled/iterations:2/manual_time_mean", "run_type": "aggregate"},
+      {"name": "task_omp_enabled/iterations:2/manual_time", "run_type": "iteration"}]})";
+  }
+  const std::map<std::string, std::vector<double>> samples{{"task_seq_enabled", {0.5, 0.25}}};
+  ppc::util::AttachSamplesToBenchmarkOutput(path.string(), samples);
+
+  std::ifstream file(path);
+  const auto output = nlohmann::json::parse(file);
+  const auto &benchmarks = output["benchmarks"];
+  EXPECT_EQ(benchmarks[0]["samples"].get<std::vector<double>>(), samples.at("task_seq_enabled"));
+  EXPECT_FALSE(benchmarks[1].contains("samples"));
+  EXPECT_FALSE(benchmarks[2].contains("samples"));
+  std::filesystem::remove(path);
+}
+
+TEST(PerfOutput, ContextEntriesAreAddedAndReplaced) {
+  const auto path = std::filesystem::temp_directory_path() / "ppc_perf_output_context.json";
+  {
+    std::ofstream file(path);
+    file << R"({"context": {"noisy": "unknown", "host_name": "vm"}, "benchmarks": []})";
+  }
+  ppc::util::AddContextToBenchmarkOutput(path.string(), {{"noisy", "false"}, {"noise_drift", "0.0100"}});
+
+  std::ifstream file(path);
+  const auto context = nlohmann::json::parse(file)["context"];
+  EXPECT_EQ(context["noisy"], "false");
+  EXPECT_EQ(context["noise_drift"], "0.0100");
+  EXPECT_EQ(context["host_name"], "vm");
+  std::filesystem::remove(path);
+}
+
+TEST(PerfOutput, RejectsFilesThatAreNotBenchmarkOutput) {
+  const auto path = std::filesystem::temp_directory_path() / "ppc_perf_output_invalid.json";
+  {
+    std::ofstream file(path);
+    file << "not json";
+  }
+  EXPECT_THROW(ppc::util::AttachSamplesToBenchmarkOutput(path.string(), {}), std::runtime_error);
+  std::filesystem::remove(path);
+}
+
+TEST(PerfOutput, RankOutputsAreWrittenNextToTheMainOutput) {
+  EXPECT_EQ(ppc::util::MakeRankOutputPath("perf/out.json", 3), "perf/out.rank3.json");
+  EXPECT_EQ(ppc::util::MakeRankOutputPath("out", 1), "out.rank1");
+  EXPECT_EQ(ppc::util::MakeMergedOutputPath("perf/out.json"), "perf/out.ranks.json");
+}
+
+TEST(PerfOutput, MergedOutputListsTheBenchmarksOfEveryRank) {
+  const auto path = std::filesystem::temp_directory_path() / "ppc_perf_output_merged.json";
+  const std::vector<std::string> rank_outputs{
+      R"({"context": {"host_name": "a", "noisy": "false"}, "benchmarks": [{"name": "task", "rank": 0}]})",
+      R"({"context": {"host_name": "b"}, "benchmarks": [{"name": "task", "rank": 1}]})"};
+  ppc::util::WriteMergedBenchmarkOutput(path.string(), rank_outputs);
+
+  std::ifstream file(path);
+  const auto merged = nlohmann::json::parse(file);
+  EXPECT_EQ(merged["context"]["noisy"], "false");
+  ASSERT_EQ(merged["ranks"].size(), 2U);
+  EXPECT_EQ(merged["ranks"][1]["rank"], 1);
+  EXPECT_EQ(merged["ranks"][1]["host_name"], "b");
+  EXPECT_EQ(merged["ranks"][1]["benchmarks"][0]["rank"], 1);
+  std::filesystem::remove(path);
+
+  EXPECT_THROW(ppc::util::WriteMergedBenchmarkOutput(path.string(), {"{}"}), std::runtime_error);
+}
@@ -0,0 +1,58 @@
+#include "util/include/perf_stats.hpp"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using ppc::util::SampleStats;
+
+TEST(PerfStats, QuantileInterpolatesBetweenRanks) {
+  const std::vector<double> sorted{1.0, 2.0, 3.0, 4.0};
+  EXPECT_DOUBLE_EQ(ppc::util::Quantile(sorted, 0.0), 1.0);
+  EXPECT_DOUBLE_EQ(ppc::util::Quantile(sorted, 0.5), 2.5);
+  EXPECT_DOUBLE_EQ(ppc::util::Quantile(sorted, 1.0), 4.0);
+  EXPECT_DOUBLE_EQ(ppc::util::Quantile({}, 0.5), 0.0);
+}
+
+TEST(PerfStats, StudentQuantileApproachesNormal) {
+  EXPECT_DOUBLE_EQ(ppc::util::StudentT975(1), 12.706);
+  EXPECT_DOUBLE_EQ(ppc::util::StudentT975(30), 2.042);
+  EXPECT_NEAR(ppc::util::StudentT975(31), 2.0395, 1e-4);
+  EXPECT_NEAR(ppc::util::StudentT975(60), 2.0003, 1e-4);
+  EXPECT_NEAR(ppc::util::StudentT975(120), 1.9799, 1e-4);
+  EXPECT_NEAR(ppc::util::StudentT975(1000), 1.9623, 1e-4);
+}
+
+TEST(PerfStats, SummaryRejectsOutliersBeforeMeanAndInterval) {
+  const std::vector<double> samples{1.0, 1.1, 0.9, 1.0, 1.05, 0.95, 10.0};
+  const SampleStats stats = ppc::util::SummarizeSamples(samples);
+  EXPECT_EQ(stats.count, 7U);
+  EXPECT_EQ(stats.outliers, 1U);
+  EXPECT_DOUBLE_EQ(stats.median, 1.0);
+  EXPECT_NEAR(stats.mean, 1.0, 1e-12);
+  EXPECT_LT(stats.ci_low, stats.mean);
+  EXPECT_GT(stats.ci_high, stats.mean);
+  EXPECT_LT(stats.ci_high, 1.1);
+  EXPECT_GT(stats.iqr, 0.0);
+  EXPECT_LT(stats.cv, 0.1);
+}
+
+TEST(PerfStats, SummaryOfEmptyOrSingleSample) {
+  EXPECT_EQ(ppc::util::SummarizeSamples({}).count, 0U);
+  const std::vector<double> one{2.0};
+  const SampleStats stats = ppc::util::SummarizeSamples(one);
+  EXPECT_DOUBLE_EQ(stats.median, 2.0);
+  EXPECT_DOUBLE_EQ(stats.ci_low, 2.0);
+  EXPECT_DOUBLE_EQ(stats.ci_high, 2.0);
+  EXPECT_FALSE(ppc::util::IsPreciseEnough(stats, 0.5, 0.5));
+}
+
+TEST(PerfStats, PrecisionTargetsAreIndependent) {
+  const std::vector<double> samples{1.0, 1.2, 0.8, 1.1, 0.9};
+  const SampleStats stats = ppc::util::SummarizeSamples(samples);
+  EXPECT_FALSE(ppc::util::IsPreciseEnough(stats, 0.0, 0.0));
+  EXPECT_TRUE(ppc::util::IsPreciseEnough(stats, 0.2, 0.0));
+  EXPECT_FALSE(ppc::util::IsPreciseEnough(stats, 0.1, 0.0));
+  EXPECT_TRUE(ppc::util::IsPreciseEnough(stats, 0.0, 0.25));
+  EXPECT_FALSE(ppc::util::IsPreciseEnough(stats, 0.0, 0.1));
+}
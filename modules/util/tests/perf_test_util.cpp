@@ -0,0 +1,333 @@
+#include "util/include/perf_test_util.hpp"
+
+#include <gtest/gtest.h>
+
+#include <benchmark/benchmark.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include <cstddef>
+#include <libenvpp/detail/environment.hpp>
+#include <stdexcept>
+#include <vector>
+
+#include "task/include/task.hpp"
+#include "util/include/util.hpp"
+
+using ppc::util::PerfMode;
+
+TEST(PerfTestUtil, ParsePerfModesKeepsOrderAndDropsDuplicates) {
+  const std::vector<PerfMode> expected{PerfMode::kWarm, PerfMode::kCold};
+  EXPECT_EQ(ppc::util::ParsePerfModes("warm,cold,warm"), expected);
+}
+
+TEST(PerfTestUtil, ParsePerfModesSkipsEmptyTokens) {
+  const std::vector<PerfMode> expected{PerfMode::kCold};
+  EXPECT_EQ(ppc::util::ParsePerfModes(",cold,,"), expected);
+}
+
+TEST(PerfTestUtil, ParsePerfModesThrowsOnUnknownMode) {
+  EXPECT_THROW(ppc::util::ParsePerfModes("cold,lukewarm"), std::runtime_error);
+}
+
+TEST(PerfTestUtil, GetPerfModesReadsEnvironment) {
+  env::detail::set_scoped_environment_variable scoped("PPC_PERF_MODES", "cold,warm");
+  const std::vector<PerfMode> expected{PerfMode::kCold, PerfMode::kWarm};
+  EXPECT_EQ(ppc::util::GetPerfModes(), expected);
+}
+
+TEST(PerfTestUtil, GetPerfModesDefaultsToCold) {
+  env::detail::set_scoped_environment_variable scoped("PPC_PERF_MODES", "");
+  const std::vector<PerfMode> expected{PerfMode::kCold};
+  EXPECT_EQ(ppc::util::GetPerfModes(), expected);
+}
+
+TEST(PerfTestUtil, MakePerfBenchmarkNameKeepsColdNameUnchanged) {
+  EXPECT_EQ(ppc::util::MakePerfBenchmarkName("example_threads_omp_enabled", PerfMode::kCold),
+            "example_threads_omp_enabled");
+  EXPECT_EQ(ppc::util::MakePerfBenchmarkName("example_threads_omp_enabled", PerfMode::kWarm),
+            "example_threads_omp_enabled/mode:warm");
+}
+
+TEST(PerfTestUtil, PipelineModeRoundTripsThroughNameAndParser) {
+  const std::vector<PerfMode> expected{PerfMode::kCold, PerfMode::kPipeline};
+  EXPECT_EQ(ppc::util::ParsePerfModes("cold,pipeline"), expected);
+  EXPECT_EQ(ppc::util::MakePerfBenchmarkName("example_processes_mpi_enabled", PerfMode::kPipeline),
+            "example_processes_mpi_enabled/mode:pipeline");
+}
+
+TEST(PerfTestUtil, StreamModeIsRegisteredUnderItsOwnName) {
+  EXPECT_EQ(ppc::util::PerfModeFromString("stream"), PerfMode::kStream);
+  EXPECT_EQ(ppc::util::MakePerfBenchmarkName("example_threads_tbb_enabled", PerfMode::kStream),
+            "example_threads_tbb_enabled/mode:stream");
+}
+
+TEST(PerfTestUtil, BatchModeIsRegisteredUnderItsOwnName) {
+  const std::vector<PerfMode> expected{PerfMode::kBatch, PerfMode::kStream};
+  EXPECT_EQ(ppc::util::ParsePerfModes("batch,stream"), expected);
+  EXPECT_EQ(ppc::util::MakePerfBenchmarkName("example_threads_omp_enabled", PerfMode::kBatch),
+            "example_threads_omp_enabled/mode:batch");
+}
+
+TEST(PerfTestUtil, SamplingSettingsReadEnvironment) {
+  env::detail::set_scoped_environment_variable warmup("PPC_PERF_WARMUP_RUNS", "3");
+  env::detail::set_scoped_environment_variable target_cv("PPC_PERF_TARGET_CV", "0.05");
+  env::detail::set_scoped_environment_variable target_ci("PPC_PERF_TARGET_CI", "-1");
+  const ppc::util::PerfAttr perf_attr;
+  EXPECT_EQ(perf_attr.warmup_running, 3U);
+  EXPECT_DOUBLE_EQ(perf_attr.target_cv, 0.05);
+  EXPECT_DOUBLE_EQ(perf_attr.target_ci, 0.0);
+}
+
+TEST(PerfTestUtil, SamplingIsAdaptiveOnlyWithATarget) {
+  EXPECT_FALSE(ppc::util::detail::SamplingOptions{}.IsAdaptive());
+  EXPECT_TRUE(ppc::util::detail::SamplingOptions{.target_ci = 0.02}.IsAdaptive());
+}
+
+TEST(PerfTestUtil, GatherSampleTimeKeepsLocalTimeForThreadTasks) {
+  const auto sample = ppc::util::detail::GatherSampleTime(0.25, ppc::task::TypeOfTask::kOMP);
+  EXPECT_DOUBLE_EQ(sample.elapsed, 0.25);
+  EXPECT_EQ(sample.rank_times, std::vector<double>{0.25});
+}
+
+TEST(PerfTestUtil, LoadBalanceCountersReportSpreadAndImbalance) {
+  benchmark::UserCounters counters;
+  ppc::util::detail::LoadBalanceCounters balance;
+  balance.Add({.elapsed = 3.0, .rank_times = {1.0, 3.0}}, {});
+  balance.Add({.elapsed = 3.0, .rank_times = {1.0, 3.0}}, {2.0, 2.0});
+  balance.Export(counters, true);
+  EXPECT_DOUBLE_EQ(counters["rank_time_min"], 1.0);
+  EXPECT_DOUBLE_EQ(counters["rank_time_mean"], 2.0);
+  EXPECT_DOUBLE_EQ(counters["rank_time_max"], 3.0);
+  EXPECT_DOUBLE_EQ(counters["rank_imbalance"], 0.5);
+  EXPECT_DOUBLE_EQ(counters["rank_time_1"], 3.0);
+  EXPECT_DOUBLE_EQ(counters["thread_time_max"], 2.0);
+  EXPECT_DOUBLE_EQ(counters["thread_imbalance"], 0.0);
+}
+
+TEST(PerfTestUtil, LocalRankCountersReportTheTimesOfTheCallingRank) {
+  int rank = 0;
+  if (ppc::util::IsMpiActive()) {
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  }
+  const std::vector<double> rank_times(static_cast<std::size_t>(rank) + 2, 3.0);
+  auto first = rank_times;
+  auto second = rank_times;
+  first[static_cast<std::size_t>(rank)] = 1.0;
+  second[static_cast<std::size_t>(rank)] = 2.0;
+  benchmark::UserCounters counters;
+  ppc::util::detail::LocalRankCounters local;
+  local.Add({.elapsed = 3.0, .rank_times = first}, {.validation = 0.5, .run = 1.0});
+  local.Add({.elapsed = 3.0, .rank_times = second}, {.validation = 0.5, .run = 2.0});
+  local.Export(counters);
+  EXPECT_DOUBLE_EQ(counters["rank"], rank);
+  EXPECT_DOUBLE_EQ(counters["local_time_median"], 1.5);
+  EXPECT_DOUBLE_EQ(counters["local_time_mean"], 1.5);
+  EXPECT_DOUBLE_EQ(counters["local_validation_time"], 0.5);
+  EXPECT_DOUBLE_EQ(counters["local_run_time"], 1.5);
+}
+
+TEST(PerfTestUtil, StageMetricsTotalsExportCountsPerRunAndDerivedRates) {
+  const auto values = [](double cycles, double instructions, double misses) -> ppc::util::PerfCounterValues {
+    ppc::util::PerfCounterValues result;
+    const auto set = [&result](ppc::util::PerfCounterKind kind, double value) -> void {
+      result.values.at(static_cast<std::size_t>(kind)) = value;
+      result.available.at(static_cast<std::size_t>(kind)) = true;
+    };
+    set(ppc::util::PerfCounterKind::kCycles, cycles);
+    set(ppc::util::PerfCounterKind::kInstructions, instructions);
+    set(ppc::util::PerfCounterKind::kLlcReferences, misses * 4.0);
+    set(ppc::util::PerfCounterKind::kLlcMisses, misses);
+    return result;
+  };
+  ppc::util::detail::StageMetricsTotals totals;
+  totals.Add({.validation = {.counters = values(10.0, 10.0, 0.0)}, .run = {.counters = values(1000.0, 2000.0, 4.0)}});
+  totals.Add({.validation = {.counters = values(30.0, 10.0, 0.0)}, .run = {.counters = values(3000.0, 6000.0, 12.0)}});
+  benchmark::UserCounters counters;
+  totals.Export(counters, 2.0, {.perf_counters = true, .allocations = false, .mpi = false});
+  EXPECT_DOUBLE_EQ(counters["validation_cycles"], 20.0);
+  EXPECT_DOUBLE_EQ(counters["run_cycles"], 1000.0);
+  EXPECT_DOUBLE_EQ(counters["run_instructions"], 2000.0);
+  EXPECT_DOUBLE_EQ(counters["run_ipc"], 2.0);
+  EXPECT_DOUBLE_EQ(counters["run_llc_miss_rate"], 0.25);
+  EXPECT_DOUBLE_EQ(counters["run_llc_mpki"], 2.0);
+  EXPECT_EQ(counters.count("run_page_faults"), 0U);
+  EXPECT_EQ(counters.count("preprocessing_cycles"), 0U);
+}
+
+TEST(PerfTestUtil, StageMetricsTotalsExportAllocationMeansPerRunAndLargestPeak) {
+  const auto stats = [](uint64_t allocations, uint64_t peak, int threads) -> ppc::util::AllocationStats {
+    ppc::util::AllocationStats result{
+        .allocations = allocations, .bytes = allocations * 100, .peak_live_bytes = peak, .threads = {}};
+    for (int thread = 0; thread < threads; ++thread) {
+      result.threads.push_back({.thread = thread,
+                                .allocations = allocations / static_cast<uint64_t>(threads),
+                                .bytes = 0,
+                                .peak_live_bytes = 0});
+    }
+    return result;
+  };
+  ppc::util::detail::StageMetricsTotals totals;
+  totals.Add({.validation = {.allocations = stats(1, 10, 1)}, .run = {.allocations = stats(8, 500, 2)}});
+  totals.Add({.validation = {.allocations = stats(3, 30, 1)}, .run = {.allocations = stats(16, 300, 4)}});
+  benchmark::UserCounters counters;
+  totals.Export(counters, 2.0, {.perf_counters = false, .allocations = true, .mpi = false});
+  EXPECT_DOUBLE_EQ(counters["validation_allocations"], 2.0);
+  EXPECT_DOUBLE_EQ(counters["validation_peak_live_bytes"], 30.0);
+  EXPECT_DOUBLE_EQ(counters["run_allocations"], 6.0);
+  EXPECT_DOUBLE_EQ(counters["run_allocated_bytes"], 600.0);
+  EXPECT_DOUBLE_EQ(counters["run_peak_live_bytes"], 500.0);
+  EXPECT_DOUBLE_EQ(counters["run_allocating_threads"], 4.0);
+  EXPECT_DOUBLE_EQ(counters["run_thread_allocations_max"], 2.0);
+}
+
+TEST(PerfTestUtil, StageMetricsTotalsSplitStageTimeIntoComputeCommunicationAndWait) {
+  const auto profile = [](double communication, double wait) -> ppc::util::MpiProfile {
+    ppc::util::MpiProfile result;
+    result.kinds.at(static_cast<std::size_t>(ppc::util::MpiCallKind::kCollective)) = {
+        .calls = 2, .bytes = 40, .time = communication};
+    result.kinds.at(static_cast<std::size_t>(ppc::util::MpiCallKind::kWait)) = {.calls = 4, .bytes = 0, .time = wait};
+    return result;
+  };
+  ppc::util::detail::StageMetricsTotals totals;
+  totals.Add({.validation = {.time = 0.25, .mpi_profile = profile(0.5, 0.0)},
+              .run = {.time = 4.0, .mpi_profile = profile(1.0, 0.5)}});
+  totals.Add({.validation = {.time = 0.25, .mpi_profile = profile(0.5, 0.0)},
+              .run = {.time = 4.0, .mpi_profile = profile(3.0, 0.5)}});
+  benchmark::UserCounters counters;
+  totals.Export(counters, 2.0, {.perf_counters = false, .allocations = false, .mpi = true});
+  EXPECT_DOUBLE_EQ(counters["validation_communication_time"], 0.5);
+  EXPECT_DOUBLE_EQ(counters["validation_compute_time"], 0.0);
+  EXPECT_DOUBLE_EQ(counters["run_communication_time"], 1.0);
+  EXPECT_DOUBLE_EQ(counters["run_wait_time"], 0.25);
+  EXPECT_DOUBLE_EQ(counters["run_compute_time"], 0.75);
+  EXPECT_DOUBLE_EQ(counters["run_collective_calls"], 1.0);
+  EXPECT_DOUBLE_EQ(counters["run_collective_bytes"], 20.0);
+  EXPECT_DOUBLE_EQ(counters["run_wait_calls"], 2.0);
+  EXPECT_DOUBLE_EQ(counters["run_p2p_calls"], 0.0);
+  EXPECT_DOUBLE_EQ(counters["run_mpi_fraction"], 5.0 / 8.0);
+}
+
+TEST(PerfTestUtil, RankOutputModeIsReadFromTheEnvironment) {
+  EXPECT_EQ(ppc::util::GetBenchmarkRankOutput(), ppc::util::RankOutput::kOff);
+  {
+    env::detail::set_scoped_environment_variable scoped("PPC_BENCHMARK_RANK_OUT", "merged");
+    EXPECT_EQ(ppc::util::GetBenchmarkRankOutput(), ppc::util::RankOutput::kMerged);
+    EXPECT_TRUE(ppc::util::PerfAttr{}.local_rank_counters);
+  }
+  env::detail::set_scoped_environment_variable scoped("PPC_BENCHMARK_RANK_OUT", "all");
+  EXPECT_THROW(ppc::util::GetBenchmarkRankOutput(), std::runtime_error);
+}
+
+TEST(PerfTestUtil, ParseThreadCountsKeepsOrderAndRejectsInvalidCounts) {
+  const std::vector<int> expected{4, 1, 2};
+  EXPECT_EQ(ppc::util::ParseThreadCounts("4,1,,2,4"), expected);
+  EXPECT_THROW(ppc::util::ParseThreadCounts("1,0"), std::runtime_error);
+  EXPECT_THROW(ppc::util::ParseThreadCounts("2x"), std::runtime_error);
+}
+
+TEST(PerfTestUtil, ThreadSweepPointsAreNamedAfterTheirThreadCount) {
+  EXPECT_EQ(ppc::util::MakeThreadSweepBenchmarkName("example_threads_omp_enabled", PerfMode::kCold, 4),
+            "example_threads_omp_enabled/threads:4");
+  EXPECT_EQ(ppc::util::MakeThreadSweepBenchmarkName("example_threads_tbb_enabled", PerfMode::kWarm, 2),
+            "example_threads_tbb_enabled/mode:warm/threads:2");
+  EXPECT_EQ(ppc::util::MakeScalingKey({.type = ppc::task::TypeOfTask::kOMP,
+                                       .status = ppc::task::StatusOfTask::kEnabled,
+                                       .category = ppc::task::TaskCategory::kThreads,
+                                       .display_name = "example_threads_omp_enabled"}),
+            "example_threads");
+}
+
+TEST(PerfTestUtil, ScopedThreadCountOverridesThreadsAndRestoresThem) {
+  const int initial = ppc::util::GetNumThreads();
+  {
+    const ppc::util::detail::ScopedThreadCount scope(initial + 1);
+    EXPECT_EQ(ppc::util::GetNumThreads(), initial + 1);
+    EXPECT_EQ(omp_get_max_threads(), initial + 1);
+  }
+  EXPECT_EQ(ppc::util::GetNumThreads(), initial);
+}
+
+TEST(PerfTestUtil, ScalingCountersCompareSweepPointsWithSeqBaseline) {
+  ppc::util::detail::BenchmarkOptions seq;
+  seq.scaling_key = "scaling_test_task";
+  seq.task_type = ppc::task::TypeOfTask::kSEQ;
+  benchmark::UserCounters seq_counters{{"median_time", 8.0}};
+  ppc::util::detail::ExportScalingCounters(seq_counters, seq);
+  EXPECT_FALSE(seq_counters.contains("speedup"));
+
+  auto point = seq;
+  point.task_type = ppc::task::TypeOfTask::kOMP;
+  point.num_threads = 4;
+  benchmark::UserCounters counters{{"median_time", 2.5}};
+  ppc::util::detail::ExportScalingCounters(counters, point);
+  EXPECT_DOUBLE_EQ(counters["threads"], 4.0);
+  EXPECT_DOUBLE_EQ(counters["speedup"], 3.2);
+  EXPECT_DOUBLE_EQ(counters["efficiency"], 0.8);
+}
+
+TEST(PerfTestUtil, WeakScalingReportsEfficiencyAgainstSeqAtTheSameDeclaredSize) {
+  ppc::util::detail::BenchmarkOptions seq;
+  seq.scaling_key = "weak_scaling_test_task";
+  seq.task_type = ppc::task::TypeOfTask::kSEQ;
+  seq.sized = true;
+  seq.weak_scaling = true;
+  benchmark::UserCounters seq_counters{{"median_time", 2.0}};
+  ppc::util::detail::ExportScalingCounters(seq_counters, seq, 64);
+
+  auto point = seq;
+  point.task_type = ppc::task::TypeOfTask::kSTL;
+  point.num_threads = 4;
+  benchmark::UserCounters counters{{"median_time", 2.5}};
+  ppc::util::detail::ExportScalingCounters(counters, point, 64);
+  EXPECT_DOUBLE_EQ(counters["efficiency"], 0.8);
+  EXPECT_DOUBLE_EQ(counters["speedup"], 3.2);
+
+  benchmark::UserCounters other_size{{"median_time", 2.5}};
+  ppc::util::detail::ExportScalingCounters(other_size, point, 128);
+  EXPECT_FALSE(other_size.contains("speedup"));
+}
+
+TEST(PerfTestUtil, CountWorkersMultipliesThreadsOnlyForThreadTasks) {
+  EXPECT_EQ(ppc::util::detail::CountWorkers(ppc::task::TypeOfTask::kSEQ, 4), 1);
+  EXPECT_EQ(ppc::util::detail::CountWorkers(ppc::task::TypeOfTask::kTBB, 4), 4);
+}
+
+TEST(PerfTestUtil, WorkCountersAreRatesOverTheMedianRunTime) {
+  benchmark::UserCounters counters{{"median_time", 0.5}};
+  ppc::util::WorkMetrics work;
+  work.bytes_read = 3e9;
+  work.bytes_written = 1e9;
+  work.elements = 10;
+  ppc::util::detail::ExportWorkCounters(counters, work, 2.0);
+  EXPECT_DOUBLE_EQ(counters["gb_per_second"], 16.0);
+  EXPECT_DOUBLE_EQ(counters["elements_per_second"], 40.0);
+  EXPECT_FALSE(counters.contains("gflop_per_second"));
+}
+
+TEST(PerfTestUtil, RunsPerSampleFollowsTheMode) {
+  ppc::util::detail::BenchmarkOptions options;
+  options.batch_size = 16;
+  EXPECT_DOUBLE_EQ(ppc::util::detail::RunsPerSample(options), 1.0);
+  options.mode = PerfMode::kBatch;
+  EXPECT_DOUBLE_EQ(ppc::util::detail::RunsPerSample(options), 16.0);
+}
+
+TEST(PerfTestUtil, RoofFractionUsesTheRoofAtTheTaskArithmeticIntensity) {
+  ppc::util::RooflineCeilings roofline;
+  roofline.triad = 10e9;
+  roofline.flops = 100e9;
+  ppc::util::WorkMetrics work;
+  work.bytes_read = 1e9;
+  work.flops = 1e9;
+  benchmark::UserCounters counters{{"median_time", 0.5}};
+  ppc::util::detail::ExportWorkCounters(counters, work, 1.0, roofline);
+  EXPECT_DOUBLE_EQ(counters["arithmetic_intensity"], 1.0);
+  EXPECT_DOUBLE_EQ(counters["roof_fraction"], 0.2);
+
+  work.flops = 0.0;
+  benchmark::UserCounters bandwidth_only{{"median_time", 0.5}};
+  ppc::util::detail::ExportWorkCounters(bandwidth_only, work, 1.0, roofline);
+  EXPECT_FALSE(bandwidth_only.contains("arithmetic_intensity"));
+  EXPECT_DOUBLE_EQ(bandwidth_only["roof_fraction"], 0.2);
+}
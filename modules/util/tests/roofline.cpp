@@ -0,0 +1,52 @@
+#include "util/include/roofline.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "task/include/task.hpp"
+
+TEST(Roofline, AttainableRateIsTheLowerOfTheTwoRoofs) {
+  ppc::util::RooflineCeilings ceilings;
+  ceilings.triad = 10e9;
+  ceilings.flops = 100e9;
+  EXPECT_DOUBLE_EQ(ceilings.Attainable(0.5), 5e9);
+  EXPECT_DOUBLE_EQ(ceilings.Attainable(50.0), 100e9);
+}
+
+TEST(Roofline, KeyIgnoresSettingsThatDoNotApplyToTheBackend) {
+  EXPECT_EQ(ppc::util::MakeRooflineKey(ppc::task::TypeOfTask::kSEQ, 8),
+            ppc::util::MakeRooflineKey(ppc::task::TypeOfTask::kSEQ, 1));
+  EXPECT_NE(ppc::util::MakeRooflineKey(ppc::task::TypeOfTask::kOMP, 8),
+            ppc::util::MakeRooflineKey(ppc::task::TypeOfTask::kOMP, 1));
+}
+
+TEST(Roofline, SequentialKernelsReportPositiveCeilings) {
+  const auto ceilings = ppc::util::MeasureRoofline(ppc::task::TypeOfTask::kSEQ, 1);
+  EXPECT_GT(ceilings.copy, 0.0);
+  EXPECT_GT(ceilings.scale, 0.0);
+  EXPECT_GT(ceilings.add, 0.0);
+  EXPECT_TRUE(ceilings.IsKnown());
+}
+
+TEST(Roofline, CacheKeepsCeilingsPerKey) {
+  const auto cache = std::filesystem::temp_directory_path() / "ppc_roofline_test" / "roofline.json";
+  std::filesystem::remove(cache);
+  EXPECT_EQ(ppc::util::LoadRoofline(cache.string(), "host/omp/threads:2/procs:1"), std::nullopt);
+
+  ppc::util::RooflineCeilings ceilings;
+  ceilings.copy = 1.0;
+  ceilings.scale = 2.0;
+  ceilings.add = 3.0;
+  ceilings.triad = 4.0;
+  ceilings.flops = 5.0;
+  ppc::util::StoreRoofline(cache.string(), "host/omp/threads:2/procs:1", ceilings);
+  const auto loaded = ppc::util::LoadRoofline(cache.string(), "host/omp/threads:2/procs:1");
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_DOUBLE_EQ(loaded->add, 3.0);
+  EXPECT_DOUBLE_EQ(loaded->flops, 5.0);
+  EXPECT_EQ(ppc::util::LoadRoofline(cache.string(), "host/omp/threads:4/procs:1"), std::nullopt);
+  std::filesystem::remove_all(cache.parent_path());
+}
@@ -0,0 +1,92 @@
+#include "util/include/trace.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "util/include/util.hpp"
+
+namespace {
+
+std::size_t CountEvents(const std::vector<ppc::util::ThreadTraceEvents> &threads) {
+  std::size_t count = 0;
+  for (const auto &thread : threads) {
+    count += thread.events.size();
+  }
+  return count;
+}
+
+}  // namespace
+
+TEST(Trace, ScopesAreRecordedPerThread) {
+  ppc::util::ClearTraceEvents();
+  { const ppc::util::TraceScope scope("main", "test"); }
+  std::thread worker([] -> void { const ppc::util::TraceScope scope("worker", "test"); });
+  worker.join();
+  const auto threads = ppc::util::CollectTraceEvents();
+  ASSERT_EQ(threads.size(), 2U);
+  EXPECT_NE(threads[0].thread, threads[1].thread);
+  EXPECT_EQ(CountEvents(threads), 2U);
+  for (const auto &thread : threads) {
+    const auto &event = thread.events.front();
+    EXPECT_EQ(std::string_view(event.category), "test");
+    EXPECT_LE(event.begin_ns, event.end_ns);
+  }
+  ppc::util::ClearTraceEvents();
+  EXPECT_TRUE(ppc::util::CollectTraceEvents().empty());
+}
+
+TEST(Trace, FullBufferKeepsTheNewestEvents) {
+  ppc::util::ClearTraceEvents();
+  constexpr int64_t kRecorded = 40000;
+  for (int64_t i = 0; i < kRecorded; ++i) {
+    ppc::util::RecordTraceEvent({.name = "event", .category = "test", .begin_ns = i, .end_ns = i});
+  }
+  const auto threads = ppc::util::CollectTraceEvents();
+  ASSERT_EQ(threads.size(), 1U);
+  const auto &events = threads[0].events;
+  EXPECT_EQ(threads[0].dropped + events.size(), static_cast<uint64_t>(kRecorded));
+  EXPECT_GT(threads[0].dropped, 0U);
+  EXPECT_EQ(events.back().begin_ns, kRecorded - 1);
+  EXPECT_EQ(events.front().begin_ns, static_cast<int64_t>(threads[0].dropped));
+  ppc::util::ClearTraceEvents();
+}
+
+TEST(Trace, ChromeEventsAreShiftedByTheClockOffset) {
+  const std::vector<ppc::util::ThreadTraceEvents> threads{
+      {.thread = 3, .events = {{.name = "Run", .category = "task", .begin_ns = 5000, .end_ns = 7500}}, .dropped = 0}};
+  const auto events = nlohmann::json::parse(ppc::util::FormatChromeTraceEvents(threads, 2, 1000));
+  ASSERT_EQ(events.size(), 3U);
+  EXPECT_EQ(events[0]["name"], "process_name");
+  EXPECT_EQ(events[0]["args"]["name"], "rank 2");
+  EXPECT_EQ(events[1]["tid"], 3);
+  const auto &run = events[2];
+  EXPECT_EQ(run["ph"], "X");
+  EXPECT_EQ(run["pid"], 2);
+  EXPECT_DOUBLE_EQ(run["ts"].get<double>(), 4.0);
+  EXPECT_DOUBLE_EQ(run["dur"].get<double>(), 2.5);
+}
+
+TEST(Trace, WriteTraceWritesChromeJsonAndClearsTheEvents) {
+  ppc::util::ClearTraceEvents();
+  { const ppc::util::TraceScope scope("written", "test"); }
+  const auto path = std::filesystem::temp_directory_path() / "ppc_trace_test" / "trace.json";
+  ppc::util::WriteTrace(path.string());
+
+  std::ifstream file(path);
+  const auto trace = nlohmann::json::parse(file);
+  bool found = false;
+  for (const auto &event : trace["traceEvents"]) {
+    found = found || event["name"] == "written";
+  }
+  EXPECT_TRUE(found);
+  EXPECT_TRUE(ppc::util::CollectTraceEvents().empty());
+  std::filesystem::remove_all(path.parent_path());
+}
@@ -0,0 +1,70 @@
+#include "util/include/watchdog.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <libenvpp/detail/environment.hpp>
+#include <stop_token>
+#include <thread>
+
+namespace {
+
+bool WaitForStop(const std::stop_source &stop_source, std::chrono::milliseconds timeout) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!stop_source.stop_requested() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return stop_source.stop_requested();
+}
+
+}  // namespace
+
+TEST(Watchdog, RequestsStopWhenBudgetExpires) {
+  const ppc::util::WatchdogSlot slot;
+  std::stop_source stop_source;
+  const ppc::util::WatchdogScope watchdog(slot, "test", "Run", 0.02, stop_source);
+  EXPECT_TRUE(WaitForStop(stop_source, std::chrono::milliseconds(2000)));
+}
+
+TEST(Watchdog, DisarmBeforeExpiryLeavesStageRunning) {
+  const ppc::util::WatchdogSlot slot;
+  std::stop_source stop_source;
+  {
+    const ppc::util::WatchdogScope watchdog(slot, "test", "Run", 0.05, stop_source);
+  }
+  EXPECT_FALSE(WaitForStop(stop_source, std::chrono::milliseconds(200)));
+}
+
+TEST(Watchdog, SlotIsInactiveWhenTimeLimitIsIgnored) {
+  env::detail::set_scoped_environment_variable scoped("PPC_IGNORE_TEST_TIME_LIMIT", "1");
+  const ppc::util::WatchdogSlot slot;
+  EXPECT_FALSE(slot.IsActive());
+  std::stop_source stop_source;
+  {
+    const ppc::util::WatchdogScope watchdog(slot, "test", "Run", 0.01, stop_source);
+    EXPECT_FALSE(WaitForStop(stop_source, std::chrono::milliseconds(100)));
+  }
+}
+
+TEST(Watchdog, LaterStageOfAnotherSlotDoesNotDelayAnEarlierDeadline) {
+  const ppc::util::WatchdogSlot short_slot;
+  const ppc::util::WatchdogSlot long_slot;
+  std::stop_source short_stop;
+  std::stop_source long_stop;
+  const ppc::util::WatchdogScope long_stage(long_slot, "test", "Run", 30.0, long_stop);
+  const ppc::util::WatchdogScope short_stage(short_slot, "test", "Run", 0.02, short_stop);
+  EXPECT_TRUE(WaitForStop(short_stop, std::chrono::milliseconds(2000)));
+  EXPECT_FALSE(long_stop.stop_requested());
+}
+
+TEST(Watchdog, SlotWatchesEachStageAgainAfterAnExpiry) {
+  const ppc::util::WatchdogSlot slot;
+  std::stop_source first_stop;
+  {
+    const ppc::util::WatchdogScope watchdog(slot, "test", "Run", 0.01, first_stop);
+    ASSERT_TRUE(WaitForStop(first_stop, std::chrono::milliseconds(2000)));
+  }
+  std::stop_source second_stop;
+  const ppc::util::WatchdogScope watchdog(slot, "test", "Run", 0.02, second_stop);
+  EXPECT_TRUE(WaitForStop(second_stop, std::chrono::milliseconds(2000)));
+}
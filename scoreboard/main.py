@@ -221,6 +221,24 @@ def parse_benchmark_name(name: str) -> tuple[str, str, str] | None:
     return match.group(1), match.group(2), match.group(3) or ""
 
 
+def benchmark_mode(name: str) -> str:
+    """Return the perf harness mode encoded as a "/mode:<name>" segment (default: cold)."""
+    for segment in name.split("/")[1:]:
+        if segment.startswith("mode:"):
+            # Aggregates append their statistic to the last segment ("mode:warm_median").
+            return re.sub(
+                r"_(mean|median|stddev|cv)$", "", segment.removeprefix("mode:")
+            )
+    return "cold"
+
+
+def is_sweep_point(name: str) -> bool:
+    """Return True for thread-count ("/threads:<n>") and problem-size ("/size:<n>") sweep points."""
+    return any(
+        segment.startswith(("threads:", "size:")) for segment in name.split("/")[1:]
+    )
+
+
 def _benchmark_time_to_seconds(value: float, unit: str) -> float:
     return float(value) * PERF_TIME_UNIT_TO_SECONDS.get(unit, 1e-9)
 
@@ -229,9 +247,12 @@ def _perf_record_priority(record: dict) -> int:
     return PERF_STAT_PRIORITY.get(str(record.get("statistic", "")), 3)
 
 
-def load_benchmark_performance_data(benchmarks_dir: Path) -> dict[str, dict]:
+def load_benchmark_performance_data(
+    benchmarks_dir: Path, mode: str = "cold"
+) -> dict[str, dict]:
     """Load Google Benchmark JSON files written by ppc_perf_tests.
 
+    Only entries measured in the given perf harness mode are considered.
     Returns raw benchmark times in seconds:
       benchmark task name -> implementation -> seconds
     """
@@ -249,7 +270,10 @@ def load_benchmark_performance_data(benchmarks_dir: Path) -> dict[str, dict]:
             continue
 
         for entry in payload.get("benchmarks", []):
-            parsed_name = parse_benchmark_name(str(entry.get("name", "")))
+            entry_name = str(entry.get("name", ""))
+            if benchmark_mode(entry_name) != mode or is_sweep_point(entry_name):
+                continue
+            parsed_name = parse_benchmark_name(entry_name)
             if parsed_name is None:
                 continue
             task_name, implementation, statistic = parsed_name
@@ -697,6 +721,21 @@ def main():
       - threads.html: scoreboard for thread-based tasks
       - processes.html: scoreboard for process-based tasks
     """
+    parser = argparse.ArgumentParser(description="Generate HTML scoreboard.")
+    parser.add_argument(
+        "-o", "--output", type=str, required=True, help="Output directory path"
+    )
+    parser.add_argument(
+        "--perf-mode",
+        default="cold",
+        help=(
+            "Perf harness mode whose timings feed acceleration/efficiency: "
+            "'cold' (Run() only, default) or 'pipeline' (end-to-end, including "
+            "data distribution outside Run())."
+        ),
+    )
+    args = parser.parse_args()
+
     cfg, eff_num_proc, deadlines_cfg, plagiarism_cfg_local = load_configurations()
 
     # Make plagiarism config available to rows builder
@@ -750,7 +789,7 @@ def main():
         script_dir.parent / "perf_stat_dir" / "benchmarks",
     ]
     benchmarks_dir = next((p for p in benchmark_dirs if p.exists()), benchmark_dirs[0])
-    perf_stats_raw = load_benchmark_performance_data(benchmarks_dir)
+    perf_stats_raw = load_benchmark_performance_data(benchmarks_dir, args.perf_mode)
 
     # Partition tasks by category derived from the filesystem layout.
     threads_task_dirs = [
@@ -1059,12 +1098,6 @@ def main():
         deadlines_cfg,
     )
 
-    parser = argparse.ArgumentParser(description="Generate HTML scoreboard.")
-    parser.add_argument(
-        "-o", "--output", type=str, required=True, help="Output directory path"
-    )
-    args = parser.parse_args()
-
     output_path = Path(args.output)
     output_path.mkdir(parents=True, exist_ok=True)
 
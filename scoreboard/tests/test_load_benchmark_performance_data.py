@@ -4,7 +4,12 @@ Tests for loading Google Benchmark performance JSON files.
 
 import json
 
-from main import load_benchmark_performance_data, parse_benchmark_name
+from main import (
+    benchmark_mode,
+    is_sweep_point,
+    load_benchmark_performance_data,
+    parse_benchmark_name,
+)
 
 
 class TestLoadBenchmarkPerformanceData:
@@ -118,3 +123,146 @@ class TestLoadBenchmarkPerformanceData:
         result = load_benchmark_performance_data(benchmarks_dir)
 
         assert result["example_threads"]["tbb"] == "0.2"
+
+    def test_benchmark_mode_defaults_to_cold(self):
+        assert (
+            benchmark_mode("example_threads_omp_enabled/iterations:5/manual_time")
+            == "cold"
+        )
+        assert (
+            benchmark_mode(
+                "example_threads_omp_enabled/mode:warm/iterations:5/manual_time"
+            )
+            == "warm"
+        )
+
+    def test_load_benchmark_json_ignores_other_modes(self, temp_dir):
+        benchmarks_dir = temp_dir / "benchmarks"
+        benchmarks_dir.mkdir()
+        (benchmarks_dir / "threads.json").write_text(
+            json.dumps(
+                {
+                    "benchmarks": [
+                        {
+                            "name": "example_threads_omp_enabled/mode:warm/iterations:5/manual_time",
+                            "real_time": 0.1,
+                            "time_unit": "s",
+                        },
+                        {
+                            "name": "example_threads_omp_enabled/iterations:5/manual_time",
+                            "real_time": 0.5,
+                            "time_unit": "s",
+                        },
+                    ]
+                }
+            ),
+            encoding="utf-8",
+        )
+
+        assert (
+            load_benchmark_performance_data(benchmarks_dir)["example_threads"]["omp"]
+            == "0.5"
+        )
+        assert (
+            load_benchmark_performance_data(benchmarks_dir, mode="warm")[
+                "example_threads"
+            ]["omp"]
+            == "0.1"
+        )
+
+    def test_benchmark_mode_strips_aggregate_suffix(self):
+        assert benchmark_mode("example_threads_omp_enabled/mode:warm_median") == "warm"
+        assert benchmark_mode("example_threads_omp_enabled/mode:batch_cv") == "batch"
+
+    def test_load_benchmark_json_keeps_aggregates_of_the_mode(self, temp_dir):
+        benchmarks_dir = temp_dir / "benchmarks"
+        benchmarks_dir.mkdir()
+        (benchmarks_dir / "threads.json").write_text(
+            json.dumps(
+                {
+                    "benchmarks": [
+                        {
+                            "name": "example_threads_omp_enabled/mode:warm_mean",
+                            "run_type": "aggregate",
+                            "aggregate_name": "mean",
+                            "real_time": 0.3,
+                            "time_unit": "s",
+                        },
+                        {
+                            "name": "example_threads_omp_enabled/mode:warm_median",
+                            "run_type": "aggregate",
+                            "aggregate_name": "median",
+                            "real_time": 0.2,
+                            "time_unit": "s",
+                        },
+                    ]
+                }
+            ),
+            encoding="utf-8",
+        )
+
+        result = load_benchmark_performance_data(benchmarks_dir, mode="warm")
+
+        assert result["example_threads"]["omp"] == "0.2"
+
+    def test_load_benchmark_json_uses_pipeline_times(self, temp_dir):
+        benchmarks_dir = temp_dir / "benchmarks"
+        benchmarks_dir.mkdir()
+        (benchmarks_dir / "processes.json").write_text(
+            json.dumps(
+                {
+                    "benchmarks": [
+                        {
+                            "name": "example_processes_t1_mpi_enabled/iterations:5/manual_time",
+                            "real_time": 0.2,
+                            "time_unit": "s",
+                        },
+                        {
+                            "name": "example_processes_t1_mpi_enabled/mode:pipeline/iterations:5/manual_time",
+                            "real_time": 0.35,
+                            "time_unit": "s",
+                        },
+                    ]
+                }
+            ),
+            encoding="utf-8",
+        )
+
+        result = load_benchmark_performance_data(benchmarks_dir, mode="pipeline")
+
+        assert result["example_processes_t1"]["mpi"] == "0.35"
+
+    def test_load_benchmark_json_ignores_sweep_points(self, temp_dir):
+        benchmarks_dir = temp_dir / "benchmarks"
+        benchmarks_dir.mkdir()
+        (benchmarks_dir / "threads.json").write_text(
+            json.dumps(
+                {
+                    "benchmarks": [
+                        {
+                            "name": "example_threads_omp_enabled/size:25/iterations:5/manual_time",
+                            "real_time": 0.1,
+                            "time_unit": "s",
+                        },
+                        {
+                            "name": "example_threads_omp_enabled/threads:4/iterations:5/manual_time",
+                            "real_time": 0.2,
+                            "time_unit": "s",
+                        },
+                        {
+                            "name": "example_threads_omp_enabled/iterations:5/manual_time",
+                            "real_time": 0.5,
+                            "time_unit": "s",
+                        },
+                    ]
+                }
+            ),
+            encoding="utf-8",
+        )
+
+        assert is_sweep_point("example_threads_omp_enabled/mode:warm/threads:2")
+        assert not is_sweep_point("example_threads_omp_enabled/mode:warm")
+        assert (
+            load_benchmark_performance_data(benchmarks_dir)["example_threads"]["omp"]
+            == "0.5"
+        )
@@ -0,0 +1,383 @@
+#!/usr/bin/env python3
+"""Store performance results as baselines and check new results against them.
+
+``save`` copies every benchmark of the Google Benchmark JSON files written by
+``ppc_perf_tests`` (``PPC_BENCHMARK_OUT``) into a versioned baseline store::
+
+    <store>/<machine tag>/<task>/<implementation>/v<N>.json
+
+``compare`` checks every benchmark against the latest stored version for the
+same machine tag. When both sides carry the per-sample times that the perf
+runner attaches (``samples``), a one-sided Mann-Whitney U test decides whether
+the new samples are slower; a regression is a significant slowdown whose
+median change exceeds the threshold. The script prints a per-task table and
+exits with status 1 if any benchmark regressed. Runs the perf runner marked as
+noisy (``PPC_PERF_NOISE_THRESHOLD``) are not saved unless ``--allow-noisy`` is
+given.
+"""
+
+import argparse
+import json
+import math
+import platform
+import re
+import subprocess
+import sys
+from datetime import datetime, timezone
+from pathlib import Path
+
+# Segments Google Benchmark appends to the registered benchmark name.
+REPORTED_SUFFIXES = (
+    "iterations:",
+    "repeats:",
+    "min_time:",
+    "min_warmup_time:",
+    "manual_time",
+    "real_time",
+    "process_time",
+)
+TIME_UNITS = {"ns": 1e-9, "us": 1e-6, "ms": 1e-3, "s": 1.0}
+# Largest sample count for which the exact U distribution is computed.
+EXACT_MAX_SAMPLES = 60
+
+
+def init_cmd_args():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    subparsers = parser.add_subparsers(dest="command", required=True)
+
+    def add_common(subparser):
+        subparser.add_argument(
+            "--results",
+            default="build/perf_stat_dir/benchmarks",
+            help="Google Benchmark JSON file or directory of them "
+            "(default: build/perf_stat_dir/benchmarks).",
+        )
+        subparser.add_argument(
+            "--store",
+            default="perf_baselines",
+            help="Baseline store directory (default: perf_baselines).",
+        )
+        subparser.add_argument(
+            "--tag",
+            default=default_machine_tag(),
+            help="Machine tag the baselines belong to (default: host name and architecture).",
+        )
+
+    save = subparsers.add_parser(
+        "save", help="Store the results as a new baseline version."
+    )
+    add_common(save)
+    save.add_argument(
+        "--allow-noisy",
+        action="store_true",
+        help="Also store results the perf runner marked as noisy.",
+    )
+
+    compare = subparsers.add_parser(
+        "compare", help="Compare the results with the latest baselines."
+    )
+    add_common(compare)
+    compare.add_argument(
+        "--alpha",
+        type=float,
+        default=0.05,
+        help="Significance level of the Mann-Whitney U test (default: 0.05).",
+    )
+    compare.add_argument(
+        "--threshold",
+        type=float,
+        default=0.05,
+        help="Smallest relative slowdown of the median reported as a regression (default: 0.05).",
+    )
+    return parser.parse_args()
+
+
+def default_machine_tag():
+    tag = f"{platform.node() or 'unknown'}-{platform.machine() or 'unknown'}"
+    return re.sub(r"[^A-Za-z0-9._-]", "_", tag)
+
+
+def run_key(name):
+    """Returns the registered benchmark name without the Google Benchmark suffixes."""
+    segments = name.split("/")
+    while len(segments) > 1 and segments[-1].startswith(REPORTED_SUFFIXES):
+        segments.pop()
+    return "/".join(segments)
+
+
+def split_key(key):
+    """Splits a run key into the task and implementation directory names.
+
+    ``example_threads_omp_enabled/mode:warm/threads:4`` becomes
+    ``("example_threads", "omp_mode-warm_threads-4")``.
+    """
+    head, *rest = key.split("/")
+    match = re.fullmatch(r"(.+)_([a-z]+)_(enabled|disabled)", head)
+    task, impl = (match.group(1), match.group(2)) if match else (head, "default")
+    for segment in rest:
+        impl += "_" + re.sub(r"[^A-Za-z0-9._-]", "-", segment)
+    return task, impl
+
+
+class BenchmarkResult:
+    def __init__(self, key, entry, context):
+        self.key = key
+        self.entry = entry
+        self.context = context
+
+    @property
+    def noisy(self):
+        return self.context.get("noisy") == "true"
+
+    @property
+    def samples(self):
+        return self.entry.get("samples") or []
+
+    @property
+    def median(self):
+        if self.samples:
+            return median(self.samples)
+        unit = TIME_UNITS.get(self.entry.get("time_unit", "ns"), 1e-9)
+        return self.entry.get("real_time", 0.0) * unit
+
+
+def median(values):
+    ordered = sorted(values)
+    middle = len(ordered) // 2
+    if len(ordered) % 2:
+        return ordered[middle]
+    return (ordered[middle - 1] + ordered[middle]) / 2.0
+
+
+def load_results(path):
+    path = Path(path)
+    files = sorted(path.glob("*.json")) if path.is_dir() else [path]
+    # Per-rank outputs (PPC_BENCHMARK_RANK_OUT) repeat the names of rank 0's benchmarks.
+    files = [file for file in files if not re.search(r"\.ranks?\d*\.json$", file.name)]
+    results = {}
+    for file in files:
+        with open(file, encoding="utf-8") as stream:
+            data = json.load(stream)
+        context = data.get("context", {})
+        for entry in data.get("benchmarks", []):
+            if entry.get("run_type", "iteration") != "iteration":
+                continue
+            if entry.get("error_occurred") or entry.get("skipped"):
+                continue
+            key = run_key(entry["name"])
+            results[key] = BenchmarkResult(key, entry, context)
+    return results
+
+
+class BaselineStore:
+    def __init__(self, root, tag):
+        self.root = Path(root) / tag
+
+    def __directory(self, key):
+        task, impl = split_key(key)
+        return self.root / task / impl
+
+    @staticmethod
+    def __versions(directory):
+        versions = []
+        for file in directory.glob("v*.json"):
+            match = re.fullmatch(r"v(\d+)\.json", file.name)
+            if match:
+                versions.append((int(match.group(1)), file))
+        return sorted(versions)
+
+    def save(self, result, commit):
+        directory = self.__directory(result.key)
+        directory.mkdir(parents=True, exist_ok=True)
+        versions = self.__versions(directory)
+        version = versions[-1][0] + 1 if versions else 1
+        record = {
+            "version": version,
+            "name": result.key,
+            "saved_at": datetime.now(timezone.utc).isoformat(timespec="seconds"),
+            "commit": commit,
+            "context": result.context,
+            "benchmark": result.entry,
+        }
+        path = directory / f"v{version}.json"
+        with open(path, "w", encoding="utf-8") as stream:
+            json.dump(record, stream, indent=2)
+        return path
+
+    def latest(self, key):
+        versions = self.__versions(self.__directory(key))
+        if not versions:
+            return None
+        version, path = versions[-1]
+        with open(path, encoding="utf-8") as stream:
+            record = json.load(stream)
+        return version, BenchmarkResult(key, record["benchmark"], record["context"])
+
+
+def current_commit():
+    try:
+        return subprocess.run(
+            ["git", "rev-parse", "HEAD"],
+            capture_output=True,
+            text=True,
+            check=True,
+            cwd=Path(__file__).resolve().parent,
+        ).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def ranks(values):
+    """Returns the average ranks (1-based) of the values and the sizes of the tie groups."""
+    order = sorted(range(len(values)), key=lambda i: values[i])
+    result = [0.0] * len(values)
+    ties = []
+    start = 0
+    while start < len(order):
+        end = start
+        while end + 1 < len(order) and values[order[end + 1]] == values[order[start]]:
+            end += 1
+        for i in range(start, end + 1):
+            result[order[i]] = (start + end) / 2.0 + 1.0
+        ties.append(end - start + 1)
+        start = end + 1
+    return result, ties
+
+
+def exact_u_cdf(u, n1, n2):
+    """Returns P(U <= u) under the null hypothesis without ties."""
+    # counts[i][j][s]: arrangements of i first and j second samples with U statistic s
+    max_u = n1 * n2
+    previous = [[1] + [0] * max_u for _ in range(n2 + 1)]
+    for i in range(1, n1 + 1):
+        current = [[0] * (max_u + 1) for _ in range(n2 + 1)]
+        current[0][0] = 1
+        for j in range(1, n2 + 1):
+            for s in range(max_u + 1):
+                # The largest value comes from the first sample (beating all j) or from the second one.
+                from_first = previous[j][s - j] if s >= j else 0
+                current[j][s] = from_first + current[j - 1][s]
+        previous = current
+    total = math.comb(n1 + n2, n1)
+    return sum(previous[n2][: math.floor(u) + 1]) / total
+
+
+def mann_whitney_greater(current, baseline):
+    """One-sided Mann-Whitney U test; returns the p-value of "current is larger than baseline"."""
+    n1, n2 = len(current), len(baseline)
+    rank_values, ties = ranks(list(current) + list(baseline))
+    u = sum(rank_values[:n1]) - n1 * (n1 + 1) / 2.0
+    has_ties = any(size > 1 for size in ties)
+    if not has_ties and n1 + n2 <= EXACT_MAX_SAMPLES:
+        # P(U >= u) = P(U' <= n1 * n2 - u) by symmetry of the distribution.
+        return exact_u_cdf(n1 * n2 - u, n1, n2)
+    n = n1 + n2
+    tie_term = sum(size**3 - size for size in ties) / (n * (n - 1))
+    sigma = math.sqrt(n1 * n2 / 12.0 * ((n + 1) - tie_term))
+    if sigma == 0.0:
+        return 1.0
+    z = (u - n1 * n2 / 2.0 - 0.5) / sigma
+    return 0.5 * math.erfc(z / math.sqrt(2.0))
+
+
+def compare_result(current, baseline, alpha, threshold):
+    """Returns the relative median change, the p-value (or None) and the verdict."""
+    base_median = baseline.median
+    change = current.median / base_median - 1.0 if base_median > 0.0 else 0.0
+    if len(current.samples) < 2 or len(baseline.samples) < 2:
+        return change, None, "no samples"
+    p_slower = mann_whitney_greater(current.samples, baseline.samples)
+    if p_slower < alpha and change > threshold:
+        return change, p_slower, "REGRESSION"
+    p_faster = mann_whitney_greater(baseline.samples, current.samples)
+    if p_faster < alpha and change < -threshold:
+        return change, p_faster, "faster"
+    return change, min(p_slower, p_faster), "same"
+
+
+def print_table(rows):
+    header = ("benchmark", "baseline", "current", "change", "p-value", "verdict")
+    table = [header] + rows
+    widths = [max(len(row[column]) for row in table) for column in range(len(header))]
+    for index, row in enumerate(table):
+        cells = [row[0].ljust(widths[0])] + [
+            cell.rjust(width) for cell, width in zip(row[1:], widths[1:])
+        ]
+        print("  ".join(cells).rstrip())
+        if index == 0:
+            print("  ".join("-" * width for width in widths))
+
+
+def format_seconds(value):
+    return f"{value:.6f} s"
+
+
+def save(args):
+    results = load_results(args.results)
+    if not results:
+        print(f"No benchmark results found in {args.results}", file=sys.stderr)
+        return 1
+    store = BaselineStore(args.store, args.tag)
+    commit = current_commit()
+    for result in results.values():
+        if result.noisy and not args.allow_noisy:
+            print(f"Skipped {result.key}: the run was marked as noisy")
+            continue
+        path = store.save(result, commit)
+        print(f"Saved {result.key} -> {path}")
+    return 0
+
+
+def compare(args):
+    results = load_results(args.results)
+    if not results:
+        print(f"No benchmark results found in {args.results}", file=sys.stderr)
+        return 1
+    store = BaselineStore(args.store, args.tag)
+    tasks = {}
+    for key in sorted(results):
+        tasks.setdefault(split_key(key)[0], []).append(key)
+
+    noisy = sorted(key for key, result in results.items() if result.noisy)
+    if noisy:
+        print(
+            f"Warning: {len(noisy)} benchmark(s) come from a run marked as noisy; "
+            "regressions may come from the machine rather than the code."
+        )
+
+    regressions = 0
+    for task, keys in tasks.items():
+        rows = []
+        for key in keys:
+            current = results[key]
+            latest = store.latest(key)
+            if latest is None:
+                rows.append((key, "-", format_seconds(current.median), "-", "-", "new"))
+                continue
+            version, baseline = latest
+            change, p_value, verdict = compare_result(
+                current, baseline, args.alpha, args.threshold
+            )
+            regressions += verdict == "REGRESSION"
+            rows.append(
+                (
+                    key,
+                    f"{format_seconds(baseline.median)} (v{version})",
+                    format_seconds(current.median),
+                    f"{change:+.1%}",
+                    "-" if p_value is None else f"{p_value:.4f}",
+                    verdict,
+                )
+            )
+        print(f"\n{task}")
+        print_table(rows)
+
+    print(
+        f"\n{regressions} regression(s) at alpha={args.alpha} and threshold={args.threshold:.1%}"
+    )
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    cmd_args = init_cmd_args()
+    sys.exit(save(cmd_args) if cmd_args.command == "save" else compare(cmd_args))
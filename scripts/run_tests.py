@@ -172,6 +172,7 @@ class PPCRunner:
             "PPC_BENCHMARK_FILTER",
             "PPC_PERF_IMPL_FILTER",
             "PPC_PERF_CATEGORY_FILTER",
+            "PPC_PERF_MODES",
         ]
 
         if self.platform == "Windows":
@@ -0,0 +1,122 @@
+import math
+
+import pytest
+from perf_baseline import (
+    BenchmarkResult,
+    compare_result,
+    exact_u_cdf,
+    mann_whitney_greater,
+    run_key,
+    split_key,
+)
+
+
+def make_result(samples):
+    return BenchmarkResult("bench", {"samples": samples}, {})
+
+
+class TestExactUCdf:
+    def test_exact_u_cdf_matches_table_for_three_and_three(self):
+        # Frequencies of U for n1 = n2 = 3: 1, 1, 2, 3, 3, 3, 3, 2, 1, 1 out of C(6, 3) = 20.
+        cumulative = [1, 2, 4, 7, 10, 13, 16, 18, 19, 20]
+        for u, count in enumerate(cumulative):
+            assert exact_u_cdf(u, 3, 3) == pytest.approx(count / 20)
+
+    def test_exact_u_cdf_matches_critical_values_for_four_and_four(self):
+        # The one-sided 5% critical value for n1 = n2 = 4 is U = 1.
+        assert exact_u_cdf(1, 4, 4) == pytest.approx(2 / 70)
+        assert exact_u_cdf(2, 4, 4) == pytest.approx(4 / 70)
+        assert exact_u_cdf(8, 4, 4) == pytest.approx(39 / 70)
+
+    def test_exact_u_cdf_handles_unequal_sample_sizes(self):
+        assert exact_u_cdf(0, 2, 5) == pytest.approx(1 / 21)
+        assert exact_u_cdf(3, 2, 5) == pytest.approx(6 / 21)
+        assert exact_u_cdf(3, 2, 5) == pytest.approx(exact_u_cdf(3, 5, 2))
+
+    def test_exact_u_cdf_covers_the_whole_distribution(self):
+        assert exact_u_cdf(12, 3, 4) == pytest.approx(1.0)
+        assert exact_u_cdf(2.5, 3, 3) == exact_u_cdf(2, 3, 3)
+
+
+class TestMannWhitneyGreater:
+    def test_mann_whitney_greater_uses_exact_distribution_without_ties(self):
+        assert mann_whitney_greater([4, 5, 6], [1, 2, 3]) == pytest.approx(1 / 20)
+        assert mann_whitney_greater([1, 2, 3], [4, 5, 6]) == pytest.approx(1.0)
+
+    def test_mann_whitney_greater_corrects_variance_for_ties(self):
+        # U = 14; tie groups of 2, 4 and 2 give sigma = sqrt(16 / 12 * (9 - 72 / 56)).
+        sigma = math.sqrt(16 / 12 * (9 - 72 / 56))
+        expected = 0.5 * math.erfc((14 - 8 - 0.5) / sigma / math.sqrt(2))
+        p_value = mann_whitney_greater([2, 2, 3, 3], [1, 1, 2, 2])
+        assert p_value == pytest.approx(expected)
+        assert p_value == pytest.approx(0.0432, abs=1e-4)
+
+    def test_mann_whitney_greater_returns_one_when_all_values_tie(self):
+        assert mann_whitney_greater([1, 1, 1], [1, 1]) == 1.0
+
+
+class TestCompareResult:
+    def test_compare_result_reports_regression(self):
+        baseline = make_result([1.0, 1.01, 1.02, 1.03, 1.04])
+        current = make_result([1.2, 1.21, 1.22, 1.23, 1.24])
+        change, p_value, verdict = compare_result(current, baseline, 0.05, 0.05)
+        assert verdict == "REGRESSION"
+        assert change == pytest.approx(1.22 / 1.02 - 1.0)
+        assert p_value == pytest.approx(1 / 252)
+
+    def test_compare_result_reports_faster(self):
+        baseline = make_result([1.2, 1.21, 1.22, 1.23, 1.24])
+        current = make_result([1.0, 1.01, 1.02, 1.03, 1.04])
+        change, p_value, verdict = compare_result(current, baseline, 0.05, 0.05)
+        assert verdict == "faster"
+        assert change == pytest.approx(1.02 / 1.22 - 1.0)
+        assert p_value == pytest.approx(1 / 252)
+
+    def test_compare_result_reports_same_for_overlapping_samples(self):
+        baseline = make_result([1.0, 1.2, 1.4, 1.6, 1.8])
+        current = make_result([1.1, 1.3, 1.5, 1.7, 1.9])
+        _, p_value, verdict = compare_result(current, baseline, 0.05, 0.05)
+        assert verdict == "same"
+        assert p_value > 0.05
+
+    def test_compare_result_reports_same_for_significant_change_below_threshold(self):
+        baseline = make_result([1.0, 1.001, 1.002, 1.003, 1.004])
+        current = make_result([1.01, 1.011, 1.012, 1.013, 1.014])
+        change, _, verdict = compare_result(current, baseline, 0.05, 0.05)
+        assert verdict == "same"
+        assert change == pytest.approx(0.01, abs=1e-3)
+
+    def test_compare_result_needs_samples(self):
+        current = make_result([1.0])
+        baseline = make_result([1.0, 1.1])
+        _, p_value, verdict = compare_result(current, baseline, 0.05, 0.05)
+        assert verdict == "no samples"
+        assert p_value is None
+
+
+class TestRunKey:
+    def test_run_key_strips_google_benchmark_suffixes(self):
+        name = "example_threads_omp_enabled/iterations:5/repeats:3/manual_time"
+        assert run_key(name) == "example_threads_omp_enabled"
+
+    def test_run_key_keeps_mode_size_and_threads(self):
+        name = "example_threads_omp_enabled/mode:warm/threads:4/size:1024/min_time:0.100/manual_time"
+        assert (
+            run_key(name) == "example_threads_omp_enabled/mode:warm/threads:4/size:1024"
+        )
+
+    def test_split_key_without_suffixes(self):
+        assert split_key("example_processes_mpi_enabled") == (
+            "example_processes",
+            "mpi",
+        )
+
+    def test_split_key_appends_mode_size_and_threads(self):
+        key = "example_threads_omp_enabled/mode:warm/threads:4/size:1024"
+        assert split_key(key) == (
+            "example_threads",
+            "omp_mode-warm_threads-4_size-1024",
+        )
+
+    def test_split_key_keeps_unrecognized_names(self):
+        assert split_key("roofline/size:64") == ("roofline", "default_size-64")
@@ -12,18 +12,35 @@
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <ios>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <random>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <system_error>
 #include <vector>
 
-#include "oneapi/tbb/global_control.h"
 #include "runners/include/runners.hpp"
+#include "runtime/include/runtime.hpp"
+#include "util/include/perf_environment.hpp"
+#include "util/include/perf_output.hpp"
+#include "util/include/perf_test_util.hpp"
 #include "util/include/util.hpp"
 
+// Build configuration, passed by tasks/CMakeLists.txt.
+#ifndef PPC_BUILD_TYPE
+#define PPC_BUILD_TYPE "unknown"
+#endif
+#ifndef PPC_CXX_COMPILER
+#define PPC_CXX_COMPILER "unknown"
+#endif
+#ifndef PPC_CXX_FLAGS
+#define PPC_CXX_FLAGS "unknown"
+#endif
+
 namespace {
 
 class NullBenchmarkReporter final : public benchmark::BenchmarkReporter {
@@ -87,6 +104,22 @@ bool HasFlag(int argc, char **argv, std::string_view flag) {
   return false;
 }
 
+/// Returns the JSON output file of this rank: PPC_BENCHMARK_OUT on rank 0, a file next to it on the other ranks when
+/// PPC_BENCHMARK_RANK_OUT is set, and an empty string when the rank writes none.
+std::string BenchmarkOutputPath(int rank) {
+  const auto benchmark_out = env::get<std::string>("PPC_BENCHMARK_OUT");
+  if (!benchmark_out.has_value()) {
+    return {};
+  }
+  if (rank == 0) {
+    return benchmark_out.value();
+  }
+  if (ppc::util::GetBenchmarkRankOutput() == ppc::util::RankOutput::kOff) {
+    return {};
+  }
+  return ppc::util::MakeRankOutputPath(benchmark_out.value(), rank);
+}
+
 std::vector<std::string> MakeBenchmarkArgs(const char *program_name, int rank) {
   std::vector<std::string> args{program_name != nullptr ? program_name : "ppc_perf_tests"};
   args.emplace_back("--benchmark_format=console");
@@ -97,16 +130,14 @@ std::vector<std::string> MakeBenchmarkArgs(const char *program_name, int rank) {
     args.emplace_back(std::string("--benchmark_filter=") + benchmark_filter.value());
   }
 
-  if (rank == 0) {
-    const auto benchmark_out = env::get<std::string>("PPC_BENCHMARK_OUT");
-    if (benchmark_out.has_value()) {
-      const std::filesystem::path out_path(benchmark_out.value());
-      if (out_path.has_parent_path()) {
-        std::filesystem::create_directories(out_path.parent_path());
-      }
-      args.emplace_back(std::string("--benchmark_out=") + benchmark_out.value());
-      args.emplace_back("--benchmark_out_format=json");
+  const auto benchmark_out = BenchmarkOutputPath(rank);
+  if (!benchmark_out.empty()) {
+    const std::filesystem::path out_path(benchmark_out);
+    if (out_path.has_parent_path()) {
+      std::filesystem::create_directories(out_path.parent_path());
     }
+    args.emplace_back(std::string("--benchmark_out=") + benchmark_out);
+    args.emplace_back("--benchmark_out_format=json");
   }
 
   return args;
@@ -126,7 +157,138 @@ void InitializeBenchmark(int argc, char **argv, int rank) {
   benchmark::Initialize(&benchmark_argc, benchmark_argv.data());
 }
 
-int RunRegisteredBenchmarks(int rank) {
+/// Reports pool spin-up cost in the benchmark context so it is not hidden in the first measured Run().
+void AddRuntimeContext(const ppc::runtime::RuntimeManager &runtime) {
+  const auto &spin_up = runtime.GetSpinUpTimes();
+  benchmark::AddCustomContext("runtime_num_threads", std::to_string(runtime.GetNumThreads()));
+  benchmark::AddCustomContext("runtime_omp_spin_up_s", std::format("{:.9f}", spin_up.omp));
+  benchmark::AddCustomContext("runtime_tbb_spin_up_s", std::format("{:.9f}", spin_up.tbb));
+  benchmark::AddCustomContext("runtime_stl_spin_up_s", std::format("{:.9f}", spin_up.stl));
+}
+
+/// Records the machine state and the build configuration in the benchmark context.
+void AddEnvironmentContext() {
+  for (const auto &[key, value] : ppc::util::CaptureMachineEnvironment()) {
+    benchmark::AddCustomContext(key, value);
+  }
+  benchmark::AddCustomContext("build_type", PPC_BUILD_TYPE);
+  benchmark::AddCustomContext("cxx_compiler", PPC_CXX_COMPILER);
+  benchmark::AddCustomContext("cxx_flags", PPC_CXX_FLAGS);
+}
+
+/// Times a fixed kernel before and after the benchmarks and marks the run as noisy when the two times drift apart
+/// by more than PPC_PERF_NOISE_THRESHOLD, which points at frequency throttling or background load.
+class NoiseCheck {
+ public:
+  NoiseCheck() : threshold_(env::get<double>("PPC_PERF_NOISE_THRESHOLD").value_or(kDefaultThreshold)) {}
+
+  /// Must be called on every rank.
+  void Before() {
+    if (threshold_ <= 0.0) {
+      return;
+    }
+    before_ = ppc::util::MeasureNoiseKernel();
+    benchmark::AddCustomContext("noise_kernel_before_s", std::format("{:.6f}", before_));
+  }
+
+  /// Must be called on every rank; rank 0 reports the result and adds it to the JSON output.
+  void After(int rank) const {
+    if (threshold_ <= 0.0) {
+      return;
+    }
+    const double after = ppc::util::MeasureNoiseKernel();
+    if (rank != 0) {
+      return;
+    }
+    const double drift = ppc::util::NoiseKernelDrift(before_, after);
+    const bool noisy = drift > threshold_;
+    if (noisy) {
+      std::cerr << std::format(
+          "[  WARNING ] Noisy run: the reference kernel took {:.6f} s before and {:.6f} s after the benchmarks "
+          "({:.1f}% apart, threshold {:.1f}%)\n",
+          before_, after, drift * 100.0, threshold_ * 100.0);
+    }
+    const auto benchmark_out = env::get<std::string>("PPC_BENCHMARK_OUT");
+    if (!benchmark_out.has_value() || !std::filesystem::exists(benchmark_out.value())) {
+      return;
+    }
+    const auto environment = ppc::util::CaptureMachineEnvironment();
+    try {
+      ppc::util::AddContextToBenchmarkOutput(benchmark_out.value(),
+                                             {{"noise_kernel_after_s", std::format("{:.6f}", after)},
+                                              {"noise_drift", std::format("{:.4f}", drift)},
+                                              {"noise_threshold", std::format("{:.4f}", threshold_)},
+                                              {"noisy", noisy ? "true" : "false"},
+                                              {"cpu_cur_freq_mhz_after", environment.at("cpu_cur_freq_mhz")},
+                                              {"load_average_after", environment.at("load_average")}});
+    } catch (const std::exception &e) {
+      std::cerr << "[  WARNING ] " << e.what() << '\n';
+    }
+  }
+
+ private:
+  static constexpr double kDefaultThreshold = 0.05;
+  double threshold_;
+  double before_ = 0.0;
+};
+
+/// Adds the per-sample times to the JSON output so scripts/perf_baseline.py can compare them statistically.
+void AttachRecordedSamples(int rank) {
+  const auto benchmark_out = BenchmarkOutputPath(rank);
+  if (benchmark_out.empty() || !std::filesystem::exists(benchmark_out)) {
+    return;
+  }
+  try {
+    ppc::util::AttachSamplesToBenchmarkOutput(benchmark_out, ppc::util::detail::RecordedSamples());
+  } catch (const std::exception &e) {
+    std::cerr << "[  WARNING ] " << e.what() << '\n';
+  }
+}
+
+std::string ReadFileContents(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+/// In merged mode (PPC_BENCHMARK_RANK_OUT=merged), gathers the JSON output of every rank on rank 0 and writes it
+/// to one file next to PPC_BENCHMARK_OUT; the per-rank files of the other ranks are removed. Must be called on every
+/// rank.
+void MergeRankOutputs(int rank) {
+  const auto benchmark_out = BenchmarkOutputPath(rank);
+  if (benchmark_out.empty() || ppc::util::GetBenchmarkRankOutput() != ppc::util::RankOutput::kMerged) {
+    return;
+  }
+  const std::string local_output = ReadFileContents(benchmark_out);
+  int num_ranks = 1;
+  MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+  const int local_size = static_cast<int>(local_output.size());
+  std::vector<int> sizes(static_cast<std::size_t>(num_ranks), 0);
+  MPI_Gather(&local_size, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+  std::vector<int> offsets(sizes.size(), 0);
+  for (std::size_t i = 1; i < sizes.size(); ++i) {
+    offsets[i] = offsets[i - 1] + sizes[i - 1];
+  }
+  std::string gathered(rank == 0 ? static_cast<std::size_t>(offsets.back() + sizes.back()) : 0, '\0');
+  MPI_Gatherv(local_output.data(), local_size, MPI_CHAR, gathered.data(), sizes.data(), offsets.data(), MPI_CHAR, 0,
+              MPI_COMM_WORLD);
+  if (rank != 0) {
+    std::error_code error;
+    std::filesystem::remove(benchmark_out, error);
+    return;
+  }
+  std::vector<std::string> rank_outputs;
+  rank_outputs.reserve(sizes.size());
+  for (std::size_t i = 0; i < sizes.size(); ++i) {
+    rank_outputs.push_back(gathered.substr(static_cast<std::size_t>(offsets[i]), static_cast<std::size_t>(sizes[i])));
+  }
+  try {
+    ppc::util::WriteMergedBenchmarkOutput(ppc::util::MakeMergedOutputPath(benchmark_out), rank_outputs);
+  } catch (const std::exception &e) {
+    std::cerr << "[  WARNING ] " << e.what() << '\n';
+  }
+}
+
+int RunRegisteredBenchmarks(int rank, const NoiseCheck &noise_check) {
   ppc::util::PerformanceFailureFlag::Unset();
   if (rank == 0) {
     benchmark::RunSpecifiedBenchmarks();
@@ -142,8 +304,12 @@ int RunRegisteredBenchmarks(int rank) {
       reporter.SetOutputStream(&null_stream);
       reporter.SetErrorStream(&null_stream);
     }
+    // Without a file reporter, Google Benchmark writes the --benchmark_out file of this rank, if any.
     benchmark::RunSpecifiedBenchmarks(&reporter, nullptr);
   }
+  AttachRecordedSamples(rank);
+  noise_check.After(rank);
+  MergeRankOutputs(rank);
   const int status = ppc::util::PerformanceFailureFlag::Get() ? EXIT_FAILURE : EXIT_SUCCESS;
   benchmark::Shutdown();
   benchmark::ClearRegisteredBenchmarks();
@@ -186,7 +352,7 @@ int RunPerformanceMain(int argc, char **argv) {
     return init_res;
   }
 
-  tbb::global_control control(tbb::global_control::max_allowed_parallelism, ppc::util::GetNumThreads());
+  ppc::runtime::RuntimeManager runtime(ppc::util::GetNumThreads());
 
   ::testing::InitGoogleTest(&argc, argv);
 
@@ -207,9 +373,15 @@ int RunPerformanceMain(int argc, char **argv) {
 
   int status = SynchronizeStatus(RunAllTestsSafely(), "GTest");
   if (status == EXIT_SUCCESS) {
+    ppc::util::RegisterDeferredBenchmarks();
     InitializeBenchmark(argc, argv, rank);
-    status = SynchronizeStatus(RunRegisteredBenchmarks(rank), "Google Benchmark");
+    AddRuntimeContext(runtime);
+    AddEnvironmentContext();
+    NoiseCheck noise_check;
+    noise_check.Before();
+    status = SynchronizeStatus(RunRegisteredBenchmarks(rank, noise_check), "Google Benchmark");
   }
+  runtime.Release();
 
   const int finalize_res = MPI_Finalize();
   if (finalize_res != MPI_SUCCESS) {
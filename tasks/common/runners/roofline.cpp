@@ -0,0 +1,83 @@
+#include <mpi.h>
+
+#include <array>
+#include <cstdlib>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <string>
+
+#include "task/include/task.hpp"
+#include "util/include/roofline.hpp"
+#include "util/include/util.hpp"
+
+namespace {
+
+using ppc::task::TypeOfTask;
+
+constexpr std::array kBackends = {TypeOfTask::kSEQ, TypeOfTask::kOMP, TypeOfTask::kTBB,
+                                  TypeOfTask::kSTL, TypeOfTask::kMPI, TypeOfTask::kALL};
+
+/// Measures every backend at PPC_NUM_THREADS and the launched rank count, prints the ceilings on rank 0 and stores
+/// them in PPC_PERF_ROOFLINE_CACHE when it is set, replacing earlier measurements of the same configuration.
+int RunRooflineMain(int argc, char **argv) {
+  ppc::util::ConfigureMpiEnvironment();
+  const int init_res = MPI_Init(&argc, &argv);
+  if (init_res != MPI_SUCCESS) {
+    std::cerr << "[  ERROR  ] MPI_Init failed with code " << init_res << '\n';
+    MPI_Abort(MPI_COMM_WORLD, init_res);
+    return init_res;
+  }
+  int rank = -1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  const int num_threads = ppc::util::GetNumThreads();
+  const auto cache_path = env::get<std::string>("PPC_PERF_ROOFLINE_CACHE").value_or(std::string{});
+
+  if (rank == 0) {
+    std::cout << std::format("{:<8}{:>44}{:>12}\n", "backend", "copy / scale / add / triad (GB/s)", "GFLOP/s");
+  }
+  for (const TypeOfTask backend : kBackends) {
+    const bool all_ranks = backend == TypeOfTask::kMPI || backend == TypeOfTask::kALL;
+    if (!all_ranks && rank != 0) {
+      MPI_Barrier(MPI_COMM_WORLD);
+      continue;
+    }
+    const auto ceilings = ppc::util::MeasureRoofline(backend, num_threads);
+    const auto key = ppc::util::MakeRooflineKey(backend, num_threads);
+    if (rank == 0) {
+      std::cout << std::format("{:<8}{:>11.2f}{:>11.2f}{:>11.2f}{:>11.2f}{:>12.2f}  {}\n",
+                               ppc::task::TypeOfTaskToString(backend), ceilings.copy * 1e-9, ceilings.scale * 1e-9,
+                               ceilings.add * 1e-9, ceilings.triad * 1e-9, ceilings.flops * 1e-9, key);
+      if (!cache_path.empty()) {
+        ppc::util::StoreRoofline(cache_path, key, ceilings);
+      }
+    }
+    if (!all_ranks) {
+      MPI_Barrier(MPI_COMM_WORLD);
+    }
+  }
+  if (rank == 0 && !cache_path.empty()) {
+    std::cout << "Stored in " << cache_path << '\n';
+  }
+
+  const int finalize_res = MPI_Finalize();
+  if (finalize_res != MPI_SUCCESS) {
+    std::cerr << "[  ERROR  ] MPI_Finalize failed with code " << finalize_res << '\n';
+    MPI_Abort(MPI_COMM_WORLD, finalize_res);
+    return finalize_res;
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  try {
+    return RunRooflineMain(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << "[  ERROR  ] Unhandled exception in roofline calibration: " << e.what() << '\n';
+  } catch (...) {
+    std::cerr << "[  ERROR  ] Unknown unhandled exception in roofline calibration" << '\n';
+  }
+  return EXIT_FAILURE;
+}
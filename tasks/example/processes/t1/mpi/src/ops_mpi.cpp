@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "example/common/include/common.hpp"
+#include "util/include/trace.hpp"
 #include "util/include/util.hpp"
 
 namespace example_processes_t1 {
@@ -60,7 +61,10 @@ bool NesterovATestTaskMPI::RunImpl() {
     }
   }
 
-  MPI_Barrier(MPI_COMM_WORLD);
+  {
+    PPC_TRACE_SCOPE_CATEGORY("MPI_Barrier", "mpi");
+    MPI_Barrier(MPI_COMM_WORLD);
+  }
   return GetOutput() > 0;
 }
 
@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
 #include <tuple>
+#include <vector>
 
 #include "example/common/include/common.hpp"
 #include "example/processes/t1/mpi/include/ops_mpi.hpp"
@@ -23,8 +27,28 @@ class ExampleRunPerfTestProcesses : public ppc::util::BaseRunPerfTests<InType, O
     return input_data_;
   }
 
+  std::vector<int64_t> GetTestSizes() final {
+    return benchmark::CreateRange(kMinCount_, kCount_, 2);
+  }
+
+  int64_t GetCalibrationStartSize() final {
+    return kMinCount_;
+  }
+
+  InType GetTestInputDataForSize(int64_t size) final {
+    return static_cast<InType>(size);
+  }
+
+  // Run() visits n^3 (i, j, k) triples and fills and sums a vector of i + j + k elements for each of them.
+  ppc::util::WorkMetrics GetWorkMetrics(const InType &input) final {
+    const auto n = static_cast<double>(input);
+    const double vector_bytes = sizeof(InType) * 1.5 * n * n * n * (n - 1.0);
+    return {.bytes_read = vector_bytes, .bytes_written = vector_bytes, .flops = 0.0, .elements = n * n * n};
+  }
+
  private:
   const int kCount_ = 100;
+  const int kMinCount_ = 25;
   InType input_data_{};
 };
 
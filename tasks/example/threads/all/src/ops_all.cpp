@@ -4,11 +4,11 @@
 
 #include <atomic>
 #include <numeric>
-#include <thread>
 #include <vector>
 
 #include "example/common/include/common.hpp"
 #include "oneapi/tbb/parallel_for.h"
+#include "runtime/include/runtime.hpp"
 #include "util/include/util.hpp"
 
 namespace example_threads {
@@ -58,12 +58,8 @@ bool NesterovATestTaskALL::RunImpl() {
 
   {
     GetOutput() *= num_threads;
-    std::vector<std::thread> threads(num_threads);
     std::atomic<int> counter(0);
-    for (std::thread &thread : threads) {
-      thread = std::thread([&counter]() -> void { counter++; });
-      thread.join();
-    }
+    ppc::runtime::ParallelRun(num_threads, [&counter](int /*thread_index*/) -> void { counter++; });
     GetOutput() /= counter;
   }
 
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "example/common/include/common.hpp"
+#include "util/include/trace.hpp"
 #include "util/include/util.hpp"
 
 namespace example_threads {
@@ -40,7 +41,10 @@ bool NesterovATestTaskOMP::RunImpl() {
 
   std::atomic<int> counter(0);
 #pragma omp parallel default(none) shared(counter) num_threads(ppc::util::GetNumThreads())
-  counter++;
+  {
+    PPC_TRACE_SCOPE_CATEGORY("omp region", "omp");
+    counter++;
+  }
 
   GetOutput() /= counter;
   return GetOutput() > 0;
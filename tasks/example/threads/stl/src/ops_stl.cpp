@@ -2,10 +2,10 @@
 
 #include <atomic>
 #include <numeric>
-#include <thread>
 #include <vector>
 
 #include "example/common/include/common.hpp"
+#include "runtime/include/runtime.hpp"
 #include "util/include/util.hpp"
 
 namespace example_threads {
@@ -37,14 +37,11 @@ bool NesterovATestTaskSTL::RunImpl() {
   }
 
   const int num_threads = ppc::util::GetNumThreads();
-  std::vector<std::thread> threads(num_threads);
   GetOutput() *= num_threads;
 
+  // Runs on the persistent STL pool when available instead of creating threads per call
   std::atomic<int> counter(0);
-  for (std::thread &thread : threads) {
-    thread = std::thread([&counter]() -> void { counter++; });
-    thread.join();
-  }
+  ppc::runtime::ParallelRun(num_threads, [&counter](int /*thread_index*/) -> void { counter++; });
 
   GetOutput() /= counter;
   return GetOutput() > 0;
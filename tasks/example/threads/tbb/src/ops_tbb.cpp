@@ -9,6 +9,7 @@
 
 #include "example/common/include/common.hpp"
 #include "oneapi/tbb/parallel_for.h"
+#include "util/include/trace.hpp"
 
 namespace example_threads {
 
@@ -42,7 +43,10 @@ bool NesterovATestTaskTBB::RunImpl() {
   GetOutput() *= num_threads;
 
   std::atomic<int> counter(0);
-  tbb::parallel_for(0, ppc::util::GetNumThreads(), [&](int /*i*/) -> void { counter++; });
+  tbb::parallel_for(0, ppc::util::GetNumThreads(), [&](int /*i*/) -> void {
+    PPC_TRACE_SCOPE_CATEGORY("tbb task", "tbb");
+    counter++;
+  });
 
   GetOutput() /= counter;
   return GetOutput() > 0;